@@ -0,0 +1,276 @@
+/*
+ * Copyright 2010 Martin Schreiber
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * benchmark of the physics engine with the scenes of CScenes
+ *
+ * usage: sbndengine_benchmark [options]
+ *
+ *   -s <scene>		run only this scene (default: all scenes)
+ *   -n <copies>	number of copies of the scene placed side by side (default: 1)
+ *   -k <steps>		number of timesteps (default: 500)
+ *   -b <broadphase>	sap, hash or tree (default: tree)
+ *   -t <threads>	number of threads (default: 0 = one for each processor)
+ *   -i <position iterations>,<velocity iterations>
+ *
+ * one line of comma separated values is written for each scene. the times
+ * are milliseconds per timestep, the workload is the average per timestep.
+ * the checksum of the final object positions allows to compare the results
+ * of different options or builds.
+ *
+ * the headless backend (sys_headless) is used, nothing is drawn.
+ */
+
+#include "sbndengine/iSbndEngine.hpp"
+#include "../cScenes.hpp"
+#include <iostream>
+#include <iomanip>
+#include <string.h>
+#include <stdlib.h>
+#include <stdio.h>
+
+/**
+ * number of scenes in CScenes
+ */
+#define BENCHMARK_SCENES			30
+
+/**
+ * distance between the copies of a scene. the scenes are enclosed by the
+ * world box planes of 20x20 (40x40 for scene 3).
+ */
+#define BENCHMARK_COPY_DISTANCE		50.0f
+
+/**
+ * seconds of one timestep
+ */
+#define BENCHMARK_TIMESTEP_SIZE		(1.0/50.0)
+
+
+class cBenchmark
+{
+	iEngine engine;
+	CScenes *cScenes;
+
+public:
+	int copies;
+	int steps;
+	int broadphase;
+	const char *broadphase_name;
+	int threads;
+	int max_position_iterations;
+	int velocity_iterations;
+
+	cBenchmark()	:
+		copies(1),
+		steps(500),
+		broadphase(iPhysics::BROADPHASE_AABB_TREE),
+		broadphase_name("tree"),
+		threads(0),
+		max_position_iterations(10),
+		velocity_iterations(10)
+	{
+		cScenes = new CScenes(engine);
+	}
+
+	~cBenchmark()
+	{
+		engine.clear();
+		delete cScenes;
+	}
+
+
+	/**
+	 * setup the copies of the scene on a square grid
+	 */
+	void setupScene(int p_scene_id)
+	{
+		engine.clear();
+
+		engine.physics.setBroadphase(broadphase);
+		engine.physics.setNumberOfThreads(threads);
+		engine.physics.setMaximumIterations(max_position_iterations, velocity_iterations);
+
+		int columns = 1;
+		while (columns*columns < copies)
+			columns++;
+
+		// not every scene sets a description
+		cScenes->scene_description = NULL;
+
+		for (int c = 0; c < copies; c++)
+		{
+			size_t first_object = engine.getObjectList().size();
+
+			cScenes->setupScene(p_scene_id);
+
+			CVector<3,float> offset(
+					(float)(c % columns)*BENCHMARK_COPY_DISTANCE,
+					0,
+					(float)(c / columns)*BENCHMARK_COPY_DISTANCE
+				);
+
+			std::list<iRef<iObject> >::const_iterator i = engine.getObjectList().begin();
+			for (size_t n = 0; n < first_object; n++)
+				i++;
+
+			for (; i != engine.getObjectList().end(); i++)
+				(*i)->translate(offset);
+		}
+
+		engine.updateObjectModelMatrices();
+	}
+
+
+	/**
+	 * run the timesteps and output the results
+	 */
+	void run(int p_scene_id)
+	{
+		setupScene(p_scene_id);
+
+		/*
+		 * the elapsed seconds are always in the middle of the timestep,
+		 * thus exactly one timestep is done for each call
+		 */
+		engine.physics.setUpdateInterval(BENCHMARK_TIMESTEP_SIZE, 0);
+		engine.physics.resetStatistics();
+
+		for (int k = 0; k < steps; k++)
+			engine.physics.simulationTimestep(((double)k + 1.5)*BENCHMARK_TIMESTEP_SIZE);
+
+		iPhysicsStatistics s = engine.physics.getStatistics();
+
+		double checksum = 0;
+		const std::list<iRef<iObject> > &objects = engine.getObjectList();
+		for (std::list<iRef<iObject> >::const_iterator i = objects.begin(); i != objects.end(); i++)
+		{
+			const CVector<3,float> &p = (*i)->position;
+			checksum += (double)p.data[0] + (double)p.data[1] + (double)p.data[2];
+		}
+
+		double n = (double)CMath<long>::max(s.timesteps, 1);
+		double ms = 1000.0/n;
+
+		double other_seconds = s.total_seconds - s.integrate_seconds - s.broadphase_seconds - s.narrowphase_seconds
+								- s.islands_seconds - s.impulse_seconds - s.interpenetration_seconds;
+
+		std::cout << p_scene_id << ",";
+		std::cout << "\"" << (cScenes->scene_description ? cScenes->scene_description : "") << "\",";
+		std::cout << copies << "," << objects.size() << "," << s.timesteps << ",";
+		std::cout << broadphase_name << "," << threads << ",";
+		std::cout << std::fixed << std::setprecision(6);
+		std::cout << s.total_seconds*ms << ",";
+		std::cout << s.integrate_seconds*ms << ",";
+		std::cout << s.broadphase_seconds*ms << ",";
+		std::cout << s.narrowphase_seconds*ms << ",";
+		std::cout << s.islands_seconds*ms << ",";
+		std::cout << s.impulse_seconds*ms << ",";
+		std::cout << s.interpenetration_seconds*ms << ",";
+		std::cout << other_seconds*ms << ",";
+		std::cout << std::setprecision(2);
+		std::cout << (double)s.broadphase_pairs/n << ",";
+		std::cout << (double)s.contacts/n << ",";
+		std::cout << (double)s.islands/n << ",";
+		std::cout << (double)s.velocity_iterations/n << ",";
+		std::cout << (double)s.position_iterations/n << ",";
+		std::cout << std::setprecision(6) << checksum << std::endl;
+		std::cout.unsetf(std::ios::floatfield);
+	}
+
+
+	static void outputHeader()
+	{
+		std::cout << "scene,description,copies,objects,steps,broadphase,threads,";
+		std::cout << "total_ms,integrate_ms,broadphase_ms,narrowphase_ms,islands_ms,impulse_ms,interpenetration_ms,other_ms,";
+		std::cout << "pairs,contacts,islands,velocity_iterations,position_iterations,checksum" << std::endl;
+	}
+};
+
+
+static void usage()
+{
+	std::cerr << "usage: sbndengine_benchmark [-s scene] [-n copies] [-k steps] [-b sap|hash|tree] [-t threads] [-i position_iterations,velocity_iterations]" << std::endl;
+}
+
+
+int main(int argc, char **argv)
+{
+	cBenchmark benchmark;
+	int scene_id = 0;
+
+	for (int i = 1; i < argc; i++)
+	{
+		if (argv[i][0] != '-' || argv[i][1] == '\0' || argv[i][2] != '\0' || i+1 >= argc)
+		{
+			usage();
+			return -1;
+		}
+
+		const char *value = argv[++i];
+
+		switch(argv[i-1][1])
+		{
+			case 's':	scene_id = atoi(value);				break;
+			case 'n':	benchmark.copies = atoi(value);		break;
+			case 'k':	benchmark.steps = atoi(value);		break;
+			case 't':	benchmark.threads = atoi(value);	break;
+
+			case 'b':
+				benchmark.broadphase_name = value;
+				if (strcmp(value, "sap") == 0)			benchmark.broadphase = iPhysics::BROADPHASE_SWEEP_AND_PRUNE;
+				else if (strcmp(value, "hash") == 0)	benchmark.broadphase = iPhysics::BROADPHASE_SPATIAL_HASH;
+				else if (strcmp(value, "tree") == 0)	benchmark.broadphase = iPhysics::BROADPHASE_AABB_TREE;
+				else
+				{
+					usage();
+					return -1;
+				}
+				break;
+
+			case 'i':
+				if (sscanf(value, "%d,%d", &benchmark.max_position_iterations, &benchmark.velocity_iterations) != 2)
+				{
+					usage();
+					return -1;
+				}
+				break;
+
+			default:
+				usage();
+				return -1;
+		}
+	}
+
+	if (benchmark.copies < 1 || benchmark.steps < 1 || scene_id < 0 || scene_id > BENCHMARK_SCENES)
+	{
+		usage();
+		return -1;
+	}
+
+	cBenchmark::outputHeader();
+
+	if (scene_id > 0)
+	{
+		benchmark.run(scene_id);
+	}
+	else
+	{
+		for (int s = 1; s <= BENCHMARK_SCENES; s++)
+			benchmark.run(s);
+	}
+
+	return 0;
+}
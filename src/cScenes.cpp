@@ -1115,6 +1115,53 @@ void CScenes::setupScene29()
     engine.physics.setGravitation(CVector <3, float> (0, -9.81f, 0));
 }
 
+/**
+ * sphere and box in the corners of a room which is a static triangle mesh.
+ * the sphere and the box start penetrating the floor and a wall by different
+ * depths, thus their contact manifolds have 2 different normals.
+ */
+void CScenes::setupScene30()
+{
+	scene_description = "Sphere and box in the corners of a static mesh";
+
+	/*
+	 * room: box with the triangles turned inside out
+	 */
+	iRef<cObjectFactoryBox> room_factory = new cObjectFactoryBox(8, 6, 8);
+	for (int t = 0; t < room_factory->triangles_count; t++)
+	{
+		float *v = room_factory->vertices + t*3*3;
+		room_factory->setTriangleDataV(t,
+				CVector<3,float>(v[0], v[1], v[2]),
+				CVector<3,float>(v[6], v[7], v[8]),
+				CVector<3,float>(v[3], v[4], v[5])
+			);
+	}
+	room_factory->computeTriangleFlatNormals();
+
+	iRef<cObjectFactoryTriangleMesh> mesh_factory = new cObjectFactoryTriangleMesh(*room_factory);
+
+	iRef<iObject> room = new iObject("room");
+	room->createFromFactory(*mesh_factory);
+	iRef<iGraphicsObject> room_graphics_object = new iGraphicsObject(room, materials.boden_1);
+	engine.graphics.addObject(room_graphics_object);
+	engine.addObject(*room);
+	iRef<iPhysicsObject> room_physics_object = new iPhysicsObject(*room);
+	engine.physics.addObject(room_physics_object);
+
+	/*
+	 * 0.05 into the wall and 0.01 into the floor
+	 */
+	iRef<cObjectFactorySphere> sphere_factory = new cObjectFactorySphere(1);
+	NEW_SPHERE(sphere, pink, -4+1-0.05f, -3+1-0.01f, 0);
+
+	iRef<cObjectFactoryBox> box_factory = new cObjectFactoryBox(1, 1, 1);
+	NEW_BOX(box, red, 4-0.5f+0.05f, -3+0.5f-0.01f, 0);
+
+	engine.physics.setGravitation(CVector<3, float>(0, -9.81f, 0));
+}
+
+
 CScenes::CScenes(iEngine &p_engine)	:
 		engine(p_engine)
 {
@@ -1162,6 +1209,7 @@ void CScenes::setupScene(int scene_id)
     case 27:    setupScene27();     break;
     case 28:    setupScene28();     break;
     case 29:    setupScene29();     break;
+	case 30:	setupScene30();		break;
 
 	default:
 		setupScene1();
@@ -80,6 +80,7 @@ public:
     void setupScene27();
     void setupScene28();
     void setupScene29();
+	void setupScene30();
 };
 
 #endif
@@ -48,11 +48,11 @@ public:
 	 */
 	void reset()
 	{
-		physicsObject->object->position = CVector<3, float> ();
-		physicsObject->velocity = CVector<3, float> ();
+		physicsObject->setPosition(CVector<3, float> ());
+		physicsObject->setSpeed(CVector<3, float> ());
 		
-		physicsObject->object->rotation = CQuaternion<float> ();
-		physicsObject->angular_velocity = CVector<3, float> ();
+		physicsObject->object->setRotation(CQuaternion<float> ());
+		physicsObject->setAngularSpeed(CVector<3, float> ());
 	}
 	
 	
@@ -61,7 +61,7 @@ public:
 	 */
 	inline void translate(CVector<3, float> dist) 
 	{
-		physicsObject->object->translate(dist);
+		physicsObject->translate(dist);
 	}
 	
 	/*
@@ -76,7 +76,9 @@ public:
 
 	inline void jump()
 	{
-		physicsObject->velocity[1] = 7;
+		CVector<3, float> jumpVelocity = physicsObject->velocity;
+		jumpVelocity[1] = 7;
+		physicsObject->setSpeed(jumpVelocity);
 	}
 
 
@@ -0,0 +1,285 @@
+/*
+ * Copyright 2010 Martin Schreiber
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * simulate one of the scenes without window and output the final state
+ *
+ * usage: sbndengine_headless [-T] [scene id] [number of frames]
+ *
+ * the frames are processed as fast as possible. every frame simulates 1/60
+ * seconds (see sys_headless/Readme.txt), thus the checksum of the final
+ * object positions can be compared between different runs.
+ *
+ * with -T the timesteps are done by the simulation thread of the physics
+ * engine (iPhysics::startSimulationThread()). this thread uses the real
+ * clock, thus the frames only determine the number of timesteps which the
+ * simulated clock would trigger. the thread is stopped after this number of
+ * timesteps and the checksum matches the one of the run without -T.
+ */
+
+#include "sbndengine/iSbndEngine.hpp"
+#include "../cScenes.hpp"
+#include <iostream>
+#include <iomanip>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+
+/**
+ * seconds of one timestep and maximum number of timesteps for one frame
+ * (the defaults of the physics engine)
+ */
+#define HEADLESS_TIMESTEP_SIZE		(1.0f/50.0f)
+#define HEADLESS_MAX_SUBSTEPS		5
+
+
+class cHeadlessApplication	:
+		public iApplication
+{
+	iEngine engine;
+
+	CScenes *cScenes;
+
+	int scene_id;
+
+	// number of frames to simulate
+	int max_frames;
+	int frames;
+
+	// true, if the timesteps are done by the simulation thread
+	bool threaded;
+
+	/**
+	 * timesteps which the simulated clock triggers during the frames and the
+	 * simulated time of the next timestep (see
+	 * cPhysicsEngine_Private::updateElapsedTime())
+	 */
+	long timesteps;
+	double next_timestep_seconds;
+
+	// simulated seconds of the last frame
+	double simulated_seconds;
+
+	// monotonic clock seconds when the simulation was started
+	double start_seconds;
+
+	static double getSystemSeconds()
+	{
+		timespec t;
+		clock_gettime(CLOCK_MONOTONIC, &t);
+		return (double)t.tv_sec + (double)t.tv_nsec*0.000000001;
+	}
+
+public:
+	cHeadlessApplication(int p_scene_id, int p_max_frames, bool p_threaded)	:
+		cScenes(NULL),
+		scene_id(p_scene_id),
+		max_frames(p_max_frames),
+		frames(0),
+		threaded(p_threaded),
+		timesteps(0),
+		next_timestep_seconds(-1),
+		simulated_seconds(0),
+		start_seconds(0)
+	{
+		engine.run(this);
+	}
+
+
+	/**
+	 * output the simulated time, the runtime and a checksum of the object
+	 * positions
+	 */
+	void outputResults()
+	{
+		double seconds = getSystemSeconds() - start_seconds;
+
+		double checksum = 0;
+		const std::list<iRef<iObject> > &objects = engine.getObjectList();
+		for (std::list<iRef<iObject> >::const_iterator i = objects.begin(); i != objects.end(); i++)
+		{
+			const CVector<3,float> &p = (*i)->position;
+			checksum += (double)p.data[0] + (double)p.data[1] + (double)p.data[2];
+		}
+
+		// not every scene sets a description
+		std::cout << "scene: " << scene_id << " (" << (cScenes->scene_description ? cScenes->scene_description : "") << ")" << std::endl;
+		std::cout << "objects: " << objects.size() << std::endl;
+		std::cout << "frames: " << frames << std::endl;
+		std::cout << "timesteps: " << engine.physics.getStatistics().timesteps << std::endl;
+		std::cout << "simulated seconds: " << simulated_seconds << std::endl;
+		std::cout << "runtime seconds: " << seconds << std::endl;
+		std::cout << "frames per second: " << (seconds > 0 ? (double)frames/seconds : 0) << std::endl;
+		std::cout << "checksum: " << std::setprecision(12) << checksum << std::endl;
+	}
+
+
+	/**
+	 * engine callback: setup the scene
+	 */
+	void setup()
+	{
+		cScenes = new CScenes(engine);
+
+		engine.clear();
+		engine.physics.setGravitation(CVector<3,float>(0, -9.81f, 0));
+
+		cScenes->setupScene(scene_id);
+
+		engine.physics.setUpdateInterval(HEADLESS_TIMESTEP_SIZE, -1);
+		engine.physics.setMaximumSubsteps(HEADLESS_MAX_SUBSTEPS);
+
+		engine.updateObjectModelMatrices();
+
+		start_seconds = getSystemSeconds();
+
+		if (threaded)
+		{
+			// every timestep is done separately to stop exactly after the last one
+			engine.physics.setMaximumSubsteps(1);
+			engine.physics.startSimulationThread();
+		}
+	}
+
+
+	/**
+	 * count the timesteps which the simulated clock triggers at p_seconds
+	 */
+	void countTimesteps(double p_seconds)
+	{
+		// same precision as the update interval of the engine
+		double interval = HEADLESS_TIMESTEP_SIZE;
+
+		if (next_timestep_seconds < 0)
+			next_timestep_seconds = p_seconds;
+
+		if (next_timestep_seconds > p_seconds)
+			return;
+
+		int steps = (int)((p_seconds - next_timestep_seconds) / interval) + 1;
+
+		if (steps > HEADLESS_MAX_SUBSTEPS)
+		{
+			next_timestep_seconds = p_seconds;
+			steps = HEADLESS_MAX_SUBSTEPS;
+		}
+		else
+		{
+			next_timestep_seconds += interval*steps;
+		}
+
+		timesteps += steps;
+	}
+
+
+	/**
+	 * take over the states of the simulation thread until it did the
+	 * timesteps of all frames
+	 */
+	void drawThreadedFrame()
+	{
+		if (frames < max_frames)
+		{
+			countTimesteps(engine.time.elapsed_seconds);
+			simulated_seconds = engine.time.elapsed_seconds;
+			frames++;
+		}
+
+		engine.physics.simulationTimestep(engine.time.elapsed_seconds);
+
+		if (frames < max_frames)
+			return;
+
+		engine.physics.lock();
+
+		long done = engine.physics.getStatistics().timesteps;
+		if (done < timesteps)
+		{
+			engine.physics.unlock();
+
+			// don't keep the simulation thread from taking the lock
+			timespec t;
+			t.tv_sec = 0;
+			t.tv_nsec = 1000000;
+			nanosleep(&t, NULL);
+			return;
+		}
+
+		if (done > timesteps)
+			std::cerr << "ERROR: the simulation thread did " << done << " instead of " << timesteps << " timesteps" << std::endl;
+
+		outputResults();
+
+		engine.physics.unlock();
+		engine.physics.stopSimulationThread();
+		engine.exit();
+	}
+
+
+	void shutdown()
+	{
+		delete cScenes;
+	}
+
+
+	/**
+	 * engine callback: simulate one frame
+	 */
+	void drawFrame()
+	{
+		if (threaded)
+		{
+			drawThreadedFrame();
+			return;
+		}
+
+		engine.physics.simulationTimestep(engine.time.elapsed_seconds);
+		simulated_seconds = engine.time.elapsed_seconds;
+
+		frames++;
+		if (frames >= max_frames)
+		{
+			outputResults();
+			engine.exit();
+		}
+	}
+};
+
+
+int main(int argc, char **argv)
+{
+	bool threaded = (argc > 1 && strcmp(argv[1], "-T") == 0);
+	if (threaded)
+	{
+		argc--;
+		argv++;
+	}
+
+	int scene_id = (argc > 1 ? atoi(argv[1]) : 1);
+	int max_frames = (argc > 2 ? atoi(argv[2]) : 600);
+
+	if (max_frames < 1)
+	{
+		std::cerr << "ERROR: the number of frames has to be at least 1" << std::endl;
+		return -1;
+	}
+
+	cHeadlessApplication *application = new cHeadlessApplication(scene_id, max_frames, threaded);
+	delete application;
+
+	return 0;
+}
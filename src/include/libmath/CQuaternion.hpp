@@ -259,7 +259,7 @@ public:
 	 * return the rotation matrix which describes the rotation of this
 	 * quaternion.
 	 */
-	CMatrix3<T> getRotationMatrix()
+	CMatrix3<T> getRotationMatrix()	const
 	{
 #if WORKSHEET_3a
 		CMatrix3<T> m = CMatrix3<T>(1-2*(j*j + k*k), 2*(i*j + k*w), 2*(i*k - j*w),
@@ -0,0 +1,100 @@
+/*
+ * Copyright 2010 Martin Schreiber
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef __C_INDEXED_MESH_HPP__
+#define __C_INDEXED_MESH_HPP__
+
+#include <vector>
+#include <stddef.h>
+
+/**
+ * size of the simulated post-transform vertex cache used to order the
+ * triangles
+ */
+#define INDEXED_MESH_VERTEX_CACHE_SIZE	32
+
+
+/**
+ * \brief triangles with shared vertices
+ *
+ * the triangles of an object factory are stored with 3 separate vertices
+ * each. this class welds the vertices with the same position, normal and
+ * texture coordinate and stores 3 indices for each triangle.
+ *
+ * the triangles are ordered to reuse the transformed vertices of the
+ * post-transform cache of the graphics card as often as possible (linear-
+ * speed vertex cache optimisation, Tom Forsyth). the vertices are stored in
+ * the order of their first use.
+ *
+ * triangles which are degenerated after welding are removed.
+ */
+class cIndexedMesh
+{
+public:
+	// 3 components for each vertex
+	std::vector<float> vertices;
+
+	// 3 components for each vertex, empty if the normals are not valid
+	std::vector<float> normals;
+
+	// 2 components for each vertex, empty if the texture coordinates are not valid
+	std::vector<float> texcoords;
+
+	// 3 indices for each triangle
+	std::vector<unsigned int> indices;
+
+	// iObjectFactory::geometry_version of the triangles used to build the mesh
+	unsigned int geometry_version;
+
+	cIndexedMesh();
+
+	/**
+	 * build the mesh from separate triangles
+	 *
+	 * \param p_normals		NULL if the normals are not valid
+	 * \param p_texcoords	NULL if the texture coordinates are not valid
+	 */
+	void build(
+			const float *p_vertices,
+			const float *p_normals,
+			const float *p_texcoords,
+			int p_triangles_count
+		);
+
+	size_t getVertexCount() const
+	{
+		return vertices.size()/3;
+	}
+
+	size_t getTrianglesCount() const
+	{
+		return indices.size()/3;
+	}
+
+private:
+	void weld(
+			const float *p_vertices,
+			const float *p_normals,
+			const float *p_texcoords,
+			int p_triangles_count
+		);
+
+	void optimizeVertexCache();
+
+	void reorderVertices();
+};
+
+#endif //__C_INDEXED_MESH_HPP__
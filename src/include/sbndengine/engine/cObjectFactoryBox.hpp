@@ -45,6 +45,16 @@ public:
 	 */
 	float getInverseMass();
 
+	/**
+	 * return the corner of the box in the direction
+	 */
+	CVector<3,float> getSupportPoint(const CVector<3,float> &p_direction) const;
+
+	/**
+	 * return the side of the box whose normal is the closest one to the direction
+	 */
+	int getSupportFace(const CVector<3,float> &p_direction, CVector<3,float> *o_vertices, CVector<3,float> &o_normal) const;
+
 	/**
 	 * setup the box factory
 	 */
@@ -0,0 +1,137 @@
+/*
+ * Copyright 2010 Martin Schreiber
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef __C_OBJECT_FACTORY_CONVEX_HULL_HPP__
+#define __C_OBJECT_FACTORY_CONVEX_HULL_HPP__
+
+#include <vector>
+#include "libmath/CVector.hpp"
+#include "libmath/CMatrix.hpp"
+#include "iObjectFactory.hpp"
+
+/**
+ * this class implements a factory for the convex hull of a point cloud
+ *
+ * the hull is translated so that its center of mass is the origin of the
+ * object space. the collisions are computed with the support points
+ * (TYPE_CONVEX).
+ */
+class cObjectFactoryConvexHull	:
+	public iObjectFactory
+{
+	friend class iPhysicsEngine;
+	friend class cPhysicsEngine_Private;
+	friend class CPhysicsIntersections;
+
+	/**
+	 * vertices of the hull
+	 */
+	std::vector<CVector<3,float> > hull_vertices;
+
+	/**
+	 * neighbours of the vertex i along the edges of the hull are stored in
+	 * the range [adjacency_start[i], adjacency_start[i+1]) of adjacency
+	 */
+	std::vector<int> adjacency;
+	std::vector<int> adjacency_start;
+
+	/**
+	 * vertices with the minimum and maximum x, y and z coordinates: start
+	 * vertices for the search of the support point
+	 */
+	int extreme_vertices[6];
+
+	/**
+	 * faces of the hull (coplanar triangles are merged). the vertices of the
+	 * face i are stored counter clockwise in the range
+	 * [face_vertices_start[i], face_vertices_start[i+1]) of face_vertices.
+	 */
+	std::vector<int> face_vertices;
+	std::vector<int> face_vertices_start;
+	std::vector<CVector<3,float> > face_normals;
+
+	/**
+	 * center of mass of the point cloud which was moved to the origin
+	 */
+	CVector<3,float> center_of_mass;
+
+	float volume;
+
+	/**
+	 * rotational inertia for a mass of 1
+	 */
+	CMatrix3<float> unit_rotational_inertia;
+
+	void computeHull(const CVector<3,float> *p_points, int p_points_count, std::vector<int> &o_triangles);
+	void computeMassProperties(const std::vector<int> &p_triangles);
+	void computeFaces(const std::vector<int> &p_triangles);
+	void computeAdjacency(const std::vector<int> &p_triangles);
+
+public:
+	/**
+	 * return the rotational inertia of this object
+	 */
+	CMatrix3<float> getRotationalInertia();
+
+	/**
+	 * get the inverse mass value for this object
+	 */
+	float getInverseMass();
+
+	/**
+	 * search the support point by walking along the edges of the hull
+	 * (hill climbing) starting at the best extreme vertex
+	 */
+	CVector<3,float> getSupportPoint(const CVector<3,float> &p_direction) const;
+
+	int getSupportFace(const CVector<3,float> &p_direction, CVector<3,float> *o_vertices, CVector<3,float> &o_normal) const;
+
+	/**
+	 * setup the factory with the convex hull of the points
+	 */
+	cObjectFactoryConvexHull(
+			const CVector<3,float> *p_points,
+			int p_points_count
+		);
+
+	/**
+	 * replace the hull. if the points are flat or collinear, the hull is
+	 * empty and static (inverse mass 0).
+	 */
+	void resizeConvexHull(
+			const CVector<3,float> *p_points,
+			int p_points_count
+		);
+
+	/**
+	 * set the mass (default: volume of the hull). the hull of a degenerated
+	 * point cloud is always static.
+	 */
+	void setMass(
+			float p_mass = 1.0
+		);
+
+	/**
+	 * return the position of the origin of the object space in the space of
+	 * the points given to the constructor
+	 */
+	const CVector<3,float> &getCenterOfMass() const
+	{
+		return center_of_mass;
+	}
+};
+
+#endif // __C_OBJECT_FACTORY_CONVEX_HULL_HPP__
@@ -40,6 +40,8 @@ class cObjectFactoryPlane	:
 public:
 	CMatrix3<float> getRotationalInertia();
 	float getInverseMass();
+	CVector<3,float> getSupportPoint(const CVector<3,float> &p_direction) const;
+	int getSupportFace(const CVector<3,float> &p_direction, CVector<3,float> *o_vertices, CVector<3,float> &o_normal) const;
 	void setInverseMass(float p_mass);
 
 	cObjectFactoryPlane(
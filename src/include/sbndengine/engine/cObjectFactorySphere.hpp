@@ -37,6 +37,7 @@ public:
 
 	CMatrix3<float> getRotationalInertia();
 	float getInverseMass();
+	CVector<3,float> getSupportPoint(const CVector<3,float> &p_direction) const;
 
 	cObjectFactorySphere(
 			float p_radius = 1.0,
@@ -0,0 +1,183 @@
+/*
+ * Copyright 2010 Martin Schreiber
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef __C_OBJECT_FACTORY_TRIANGLE_MESH_HPP__
+#define __C_OBJECT_FACTORY_TRIANGLE_MESH_HPP__
+
+#include <vector>
+#include "libmath/CVector.hpp"
+#include "libmath/CMatrix.hpp"
+#include "iObjectFactory.hpp"
+
+/**
+ * maximum number of triangles stored in a leaf of the bounding volume hierarchy
+ */
+#define TRIANGLE_MESH_MAX_LEAF_TRIANGLES	4
+
+/**
+ * number of bins used to evaluate the surface area heuristic along each axis
+ */
+#define TRIANGLE_MESH_SAH_BINS				16
+
+/**
+ * maximum depth of the bounding volume hierarchy (size of the traversal stack)
+ */
+#define TRIANGLE_MESH_MAX_DEPTH				64
+
+
+/**
+ * this class implements a factory for static level geometry (TYPE_MESH)
+ *
+ * the triangles of another factory are copied and sorted into a bounding
+ * volume hierarchy which is built with the surface area heuristic. thus the
+ * triangles close to another object are found in logarithmic time.
+ *
+ * the triangles are one-sided: objects are only pushed out to the side to
+ * which the (counter clockwise) triangles are facing. the mesh can't be
+ * moved by the physics engine (inverse mass 0).
+ */
+class cObjectFactoryTriangleMesh	:
+	public iObjectFactory
+{
+	friend class iPhysicsEngine;
+	friend class cPhysicsEngine_Private;
+	friend class CPhysicsIntersections;
+
+	/**
+	 * node of the bounding volume hierarchy. the children of an inner node
+	 * are stored at first and first+1, the triangles of a leaf in the range
+	 * [first, first+count) of triangle_indices.
+	 */
+	class cNode
+	{
+	public:
+		CVector<3,float> min;
+		CVector<3,float> max;
+
+		int first;
+
+		// 0 for inner nodes
+		int count;
+	};
+
+	std::vector<cNode> nodes;
+
+	/**
+	 * triangles sorted by the leaves
+	 */
+	std::vector<int> triangle_indices;
+
+	/**
+	 * normalized face normals of the triangles
+	 */
+	std::vector<CVector<3,float> > triangle_normals;
+
+	void buildNode(
+			int p_node,
+			int p_first,
+			int p_count,
+			int p_depth,
+			const std::vector<CVector<3,float> > &p_centers
+		);
+
+	void buildHierarchy();
+
+public:
+	/**
+	 * return the vertex i of the triangle t
+	 */
+	inline CVector<3,float> getTriangleVertex(int t, int i)	const
+	{
+		const float *v = vertices + (t*3+i)*3;
+		return CVector<3,float>(v[0], v[1], v[2]);
+	}
+
+	/**
+	 * the mesh is static, thus there's no rotational inertia
+	 */
+	CMatrix3<float> getRotationalInertia();
+
+	/**
+	 * return 0 (static object)
+	 */
+	float getInverseMass();
+
+	/**
+	 * return the normalized face normal of the triangle t (zero for
+	 * degenerated triangles)
+	 */
+	inline const CVector<3,float> &getTriangleNormal(int t)	const
+	{
+		return triangle_normals[t];
+	}
+
+	/**
+	 * call p_visitor(t) for each triangle t whose bounding box overlaps the
+	 * given box (object space) while traversing the hierarchy. thus there's
+	 * no limit for the number of triangles.
+	 */
+	template <class T>
+	void visitTriangles(
+			const CVector<3,float> &p_min,
+			const CVector<3,float> &p_max,
+			T &p_visitor
+		)	const
+	{
+		if (nodes.empty())
+			return;
+
+		int stack[TRIANGLE_MESH_MAX_DEPTH+1];
+		int stack_size = 1;
+		stack[0] = 0;
+
+		while (stack_size > 0)
+		{
+			const cNode &node = nodes[stack[--stack_size]];
+
+			if (	node.min.data[0] > p_max.data[0] || node.max.data[0] < p_min.data[0] ||
+					node.min.data[1] > p_max.data[1] || node.max.data[1] < p_min.data[1] ||
+					node.min.data[2] > p_max.data[2] || node.max.data[2] < p_min.data[2]
+			)
+				continue;
+
+			if (node.count == 0)
+			{
+				stack[stack_size++] = node.first;
+				stack[stack_size++] = node.first+1;
+				continue;
+			}
+
+			for (int i = node.first; i < node.first+node.count; i++)
+				p_visitor(triangle_indices[i]);
+		}
+	}
+
+	/**
+	 * setup the factory with the triangles of another factory
+	 */
+	cObjectFactoryTriangleMesh(
+			const iObjectFactory &p_factory
+		);
+
+	/**
+	 * replace the triangles
+	 */
+	void resizeTriangleMesh(
+			const iObjectFactory &p_factory
+		);
+};
+
+#endif // __C_OBJECT_FACTORY_TRIANGLE_MESH_HPP__
@@ -0,0 +1,137 @@
+/*
+ * Copyright 2010 Martin Schreiber
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef __C_OBJECT_STORE_HPP__
+#define __C_OBJECT_STORE_HPP__
+
+#include <vector>
+#include "libmath/CVector.hpp"
+#include "libmath/CMatrix.hpp"
+#include "libmath/CQuaternion.hpp"
+
+class iObject;
+
+/**
+ * number of objects stored in one chunk (has to be a power of 2)
+ */
+#define OBJECT_STORE_CHUNK_SHIFT	8
+#define OBJECT_STORE_CHUNK_SIZE		(1 << OBJECT_STORE_CHUNK_SHIFT)
+#define OBJECT_STORE_CHUNK_MASK		(OBJECT_STORE_CHUNK_SIZE-1)
+
+/**
+ * maximum number of chunks. the physics simulation thread accesses the
+ * chunks while new objects are allocated, thus the chunk table has a fixed
+ * size and is never reallocated.
+ */
+#define OBJECT_STORE_MAX_CHUNKS		4096
+
+
+/**
+ * \brief structure of arrays storage for the state of all objects
+ *
+ * the state which is updated for every object during each timestep (position,
+ * velocity, ...) is stored in one array for each value instead of inside the
+ * objects. thus the integrator streams linearly through memory instead of
+ * dereferencing every object.
+ *
+ * iObject and iPhysicsObject only store references to their slot. the slots
+ * are allocated in chunks which are never moved, thus the handle of an
+ * object and the references to its slot stay valid until it is destroyed.
+ * a physics object uses the slot of its iObject.
+ */
+class cObjectStore
+{
+public:
+	class cChunk
+	{
+	public:
+		/**
+		 * owner of each slot (NULL for free slots)
+		 */
+		iObject *objects[OBJECT_STORE_CHUNK_SIZE];
+
+		/*
+		 * iObject
+		 */
+		CVector<3,float> position[OBJECT_STORE_CHUNK_SIZE];
+		CQuaternion<float> rotation[OBJECT_STORE_CHUNK_SIZE];
+		CMatrix4<float> model_matrix[OBJECT_STORE_CHUNK_SIZE];
+		CMatrix4<float> inverse_model_matrix[OBJECT_STORE_CHUNK_SIZE];
+		CMatrix4<float> render_model_matrix[OBJECT_STORE_CHUNK_SIZE];
+
+		/*
+		 * iPhysicsObject
+		 */
+		CVector<3,float> velocity[OBJECT_STORE_CHUNK_SIZE];
+		CVector<3,float> angular_velocity[OBJECT_STORE_CHUNK_SIZE];
+		CVector<3,float> linear_acceleration_accumulator[OBJECT_STORE_CHUNK_SIZE];
+		CVector<3,float> torque_accumulator[OBJECT_STORE_CHUNK_SIZE];
+		float inv_mass[OBJECT_STORE_CHUNK_SIZE];
+		CMatrix3<float> rotational_inverse_inertia[OBJECT_STORE_CHUNK_SIZE];
+		bool movable[OBJECT_STORE_CHUNK_SIZE];
+		bool sleeping[OBJECT_STORE_CHUNK_SIZE];
+		bool continuous_collision_detection[OBJECT_STORE_CHUNK_SIZE];
+
+		/*
+		 * state at the beginning of the last timestep to interpolate the
+		 * render_model_matrix
+		 */
+		CVector<3,float> previous_position[OBJECT_STORE_CHUNK_SIZE];
+		CQuaternion<float> previous_rotation[OBJECT_STORE_CHUNK_SIZE];
+	};
+
+private:
+	cChunk *chunks[OBJECT_STORE_MAX_CHUNKS];
+	int chunks_count;
+
+	/**
+	 * released handles which are reused before a new chunk is allocated
+	 */
+	std::vector<int> free_handles;
+
+	cObjectStore();
+
+public:
+	/**
+	 * the store shared by all objects
+	 */
+	static cObjectStore &getInstance();
+
+	/**
+	 * allocate a slot with default values for the object. the program is
+	 * aborted if all OBJECT_STORE_MAX_CHUNKS chunks are full.
+	 *
+	 * \return	handle of the slot
+	 */
+	int allocate(iObject *p_object);
+
+	/**
+	 * release the slot of a destroyed object
+	 */
+	void release(int p_handle);
+
+	inline cChunk &getChunk(int p_handle)
+	{
+		return *chunks[p_handle >> OBJECT_STORE_CHUNK_SHIFT];
+	}
+
+	static inline int getIndex(int p_handle)
+	{
+		return p_handle & OBJECT_STORE_CHUNK_MASK;
+	}
+};
+
+#endif
@@ -87,6 +87,11 @@ public:
 	 */
 	void addObject(iObject &object);
 
+	/**
+	 * return the objects added to the engine
+	 */
+	const std::list<iRef<iObject> > &getObjectList();
+
 	/**
 	 * update all object model matrix
 	 */
@@ -43,6 +43,10 @@ class iObject	: public iBase
 private:
 	void init();
 
+	// the references to the object store must not be copied
+	iObject(const iObject &);
+	iObject &operator=(const iObject &);
+
 public:
 	/**
 	 * true, if intersections with e. g. the mouse are allowed to be computed
@@ -50,16 +54,49 @@ public:
 	bool intersections_computable;
 
 	/**
-	 * object state
+	 * handle of the slot in cObjectStore which stores the object state
+	 */
+	int store_handle;
+
+	/**
+	 * object state (references to the slot in cObjectStore)
 	 */
-	CVector<3,float> position;
-	CQuaternion<float> rotation;
+	CVector<3,float> &position;
+	CQuaternion<float> &rotation;
 
 	void updateModelMatrix();
 
 	// model matrix (based on "translation", "rotation")
-	CMatrix4<float> model_matrix;
-	CMatrix4<float> inverse_model_matrix;
+	CMatrix4<float> &model_matrix;
+	CMatrix4<float> &inverse_model_matrix;
+
+	/**
+	 * model matrix used for rendering
+	 *
+	 * the physics engine interpolates it between the states of its last two
+	 * timesteps. updateModelMatrix() sets it to the model matrix and the
+	 * previous state to the current one.
+	 */
+	CMatrix4<float> &render_model_matrix;
+
+	/**
+	 * compute the model matrices from the position and the rotation
+	 */
+	static void updateModelMatrix(
+			const CVector<3,float> &p_position,
+			const CQuaternion<float> &p_rotation,
+			CMatrix4<float> &o_model_matrix,
+			CMatrix4<float> &o_inverse_model_matrix
+		);
+
+	/**
+	 * compute only the model matrix from the position and the rotation
+	 */
+	static void updateModelMatrix(
+			const CVector<3,float> &p_position,
+			const CQuaternion<float> &p_rotation,
+			CMatrix4<float> &o_model_matrix
+		);
 
 	// identifier string for convenience (e. g. to print the object's name if clicked with the mouse)
 	std::string identifier_string;
@@ -20,6 +20,12 @@
 #include "libmath/CVector.hpp"
 #include "libmath/CMatrix.hpp"
 #include "sbndengine/iBase.hpp"
+#include "cIndexedMesh.hpp"
+
+/**
+ * maximum number of vertices of a face returned by getSupportFace()
+ */
+#define OBJECT_FACTORY_MAX_FACE_VERTICES	32
 
 /**
  * \brief interface description for other primitives (box, plane, sphere)
@@ -42,8 +48,9 @@ public:
 	{
 		TYPE_SPHERE,
 		TYPE_PLANE,
-		TYPE_BOX
-//		TYPE_MESH	// not implemented yet
+		TYPE_BOX,
+		TYPE_CONVEX,	// any other convex shape, collisions are computed with its support points
+		TYPE_MESH		// static triangle mesh (cObjectFactoryTriangleMesh)
 	};
 	int type;
 
@@ -67,9 +74,58 @@ public:
 	bool normals_valid;
 	bool texcoords_valid;
 
+	/**
+	 * incremented whenever the triangles are changed. the renderer uploads
+	 * the triangles again if this differs from the version it uploaded.
+	 */
+	unsigned int geometry_version;
+
+	/**
+	 * triangles stored by the renderer (e. g. buffer objects), deleted
+	 * together with the factory
+	 */
+	iBase *graphics_data;
+
+private:
+	// built on demand by getIndexedMesh()
+	cIndexedMesh *indexed_mesh;
+
+public:
+	/**
+	 * return the triangles with welded vertices. the mesh is built again if
+	 * the geometry changed since the last call.
+	 *
+	 * the mesh is used for drawing and ray picking, the physics engine uses
+	 * the separate triangles. this is not thread safe, call it from the
+	 * thread which draws the objects only.
+	 */
+	const cIndexedMesh &getIndexedMesh();
+
 	virtual CMatrix3<float> getRotationalInertia() = 0;
 	virtual float getInverseMass() = 0;
 
+	/**
+	 * return the support point in object space: the point of the shape with
+	 * the maximum dot product with p_direction (not necessarily normalized).
+	 *
+	 * the default implementation searches all vertices, thus it is exact for
+	 * convex polyhedra only.
+	 */
+	virtual CVector<3,float> getSupportPoint(const CVector<3,float> &p_direction) const;
+
+	/**
+	 * return the face whose normal is the closest one to p_direction (object
+	 * space) to compute a contact manifold for flat contacts.
+	 *
+	 * the vertices are stored counter clockwise seen from outside. the
+	 * default implementation returns only the support point for shapes
+	 * without flat faces.
+	 *
+	 * \param o_vertices	array with OBJECT_FACTORY_MAX_FACE_VERTICES elements
+	 * \return	number of vertices
+	 */
+	virtual int getSupportFace(const CVector<3,float> &p_direction, CVector<3,float> *o_vertices, CVector<3,float> &o_normal) const;
+
 	void setTriangleDataV(
 			int id,
 			const CVector<3,float> &vertex0,
@@ -111,6 +167,12 @@ public:
 
 	void computeTriangleFlatNormals();
 
+	/**
+	 * call this function after modifying the vertices, normals or texture
+	 * coordinates directly
+	 */
+	void setGeometryChanged();
+
 	void setupBoundingSphereRadius();
 
 	void init();
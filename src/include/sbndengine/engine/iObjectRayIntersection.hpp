@@ -29,7 +29,7 @@ class iObjectRayIntersectionData	: public iBase
 public:
 	iRef<iObject> collidingObject;
 
-	// triangle nr of intersection point
+	// triangle nr of intersection point in the indexed mesh (iObjectFactory::getIndexedMesh())
 	int triangle_nr;
 
 	// triangle coordinates
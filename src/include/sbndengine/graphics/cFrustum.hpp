@@ -0,0 +1,122 @@
+/*
+ * Copyright 2010 Martin Schreiber
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef __C_FRUSTUM_HPP__
+#define __C_FRUSTUM_HPP__
+
+#include "libmath/CMatrix.hpp"
+#include "libmath/CVector.hpp"
+
+/**
+ * \brief view frustum of a camera given by its 6 planes
+ *
+ * the planes are extracted from the matrix projection_matrix*view_matrix
+ * (Gribb, Hartmann: "Fast Extraction of Viewing Frustum Planes from the
+ * World-View-Projection Matrix"). the normals point into the frustum.
+ */
+class cFrustum
+{
+	// normal and distance of the planes: left, right, bottom, top, near, far
+	float planes[6][4];
+
+public:
+	enum
+	{
+		OUTSIDE,
+		INTERSECTING,
+		INSIDE
+	};
+
+	cFrustum(const CMatrix4<float> &p_view_projection_matrix)
+	{
+		const float (*m)[4] = p_view_projection_matrix.matrix;
+
+		for (int i = 0; i < 3; i++)
+		{
+			for (int c = 0; c < 4; c++)
+			{
+				planes[i*2+0][c] = m[3][c] + m[i][c];
+				planes[i*2+1][c] = m[3][c] - m[i][c];
+			}
+		}
+
+		for (int p = 0; p < 6; p++)
+		{
+			float length = CMath<float>::sqrt(planes[p][0]*planes[p][0] + planes[p][1]*planes[p][1] + planes[p][2]*planes[p][2]);
+			if (length == 0)
+				continue;
+
+			float inv_length = 1.0f/length;
+			for (int c = 0; c < 4; c++)
+				planes[p][c] *= inv_length;
+		}
+	}
+
+	/**
+	 * return false if the sphere is completely outside
+	 */
+	bool isSphereVisible(const CVector<3,float> &p_center, float p_radius) const
+	{
+		for (int p = 0; p < 6; p++)
+		{
+			const float *plane = planes[p];
+			if (plane[0]*p_center.data[0] + plane[1]*p_center.data[1] + plane[2]*p_center.data[2] + plane[3] < -p_radius)
+				return false;
+		}
+		return true;
+	}
+
+	/**
+	 * return OUTSIDE, INTERSECTING or INSIDE for an axis aligned box
+	 */
+	int testBox(const CVector<3,float> &p_min, const CVector<3,float> &p_max) const
+	{
+		int result = INSIDE;
+
+		for (int p = 0; p < 6; p++)
+		{
+			const float *plane = planes[p];
+
+			// distance of the corner furthest along the normal and of the opposite corner
+			float far_distance = plane[3];
+			float near_distance = plane[3];
+
+			for (int c = 0; c < 3; c++)
+			{
+				if (plane[c] > 0)
+				{
+					far_distance += plane[c]*p_max.data[c];
+					near_distance += plane[c]*p_min.data[c];
+				}
+				else
+				{
+					far_distance += plane[c]*p_min.data[c];
+					near_distance += plane[c]*p_max.data[c];
+				}
+			}
+
+			if (far_distance < 0)
+				return OUTSIDE;
+
+			if (near_distance < 0)
+				result = INTERSECTING;
+		}
+
+		return result;
+	}
+};
+
+#endif //__C_FRUSTUM_HPP__
@@ -0,0 +1,124 @@
+/*
+ * Copyright 2010 Martin Schreiber
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef __C_GRAPHICS_BVH_HPP__
+#define __C_GRAPHICS_BVH_HPP__
+
+#include "sbndengine/graphics/iGraphicsObject.hpp"
+#include "sbndengine/graphics/cFrustum.hpp"
+#include "sbndengine/iRef.hpp"
+#include "libmath/CVector.hpp"
+#include <list>
+#include <vector>
+
+/**
+ * maximum number of objects stored in a leaf of the hierarchy
+ */
+#define GRAPHICS_BVH_MAX_LEAF_OBJECTS		4
+
+/**
+ * maximum depth of the hierarchy (size of the traversal stack)
+ */
+#define GRAPHICS_BVH_MAX_DEPTH				64
+
+/**
+ * the hierarchy is built again if the surface area of all nodes grew by this
+ * factor since the hierarchy was built
+ */
+#define GRAPHICS_BVH_REBUILD_AREA_FACTOR	2.0f
+
+
+/**
+ * \brief bounding volume hierarchy of the graphics objects for view frustum
+ * culling
+ *
+ * every object is bounded by the sphere with the bounding sphere radius of its
+ * factory around the translation of its render model matrix. the hierarchy of
+ * axis aligned boxes is built by splitting the objects at the median of the
+ * longest axis of their centers.
+ *
+ * the boxes are refitted to the moved objects each frame. the hierarchy is
+ * built again if objects were added or removed or if the refitted boxes
+ * became too large.
+ */
+class cGraphicsBVH
+{
+	/**
+	 * node of the hierarchy. the children of an inner node are stored at
+	 * first and first+1, the objects of a leaf in the range [first,
+	 * first+count) of objects.
+	 */
+	class cNode
+	{
+	public:
+		CVector<3,float> min;
+		CVector<3,float> max;
+
+		int first;
+
+		// 0 for inner nodes
+		int count;
+	};
+
+	std::vector<cNode> nodes;
+
+	// objects sorted by the leaves
+	std::vector<iGraphicsObject*> objects;
+
+	// world space bounding sphere centers of objects
+	std::vector<CVector<3,float> > centers;
+
+	// objects without a finite bounding sphere, they are never culled
+	std::vector<iGraphicsObject*> unbounded_objects;
+
+	// surface area of all nodes after the last build
+	float build_area;
+
+	bool objects_changed;
+
+	void updateCenters();
+
+	void buildNode(int p_node, int p_first, int p_count, int p_depth);
+
+	void setupLeafBounds(cNode &p_node);
+
+	float refit();
+
+	void build(const std::list<iRef<iGraphicsObject> > &p_object_list);
+
+public:
+	cGraphicsBVH();
+
+	/**
+	 * call this after objects were added or removed
+	 */
+	void setObjectsChanged();
+
+	/**
+	 * refit or build the hierarchy for the current positions of the objects
+	 */
+	void update(const std::list<iRef<iGraphicsObject> > &p_object_list);
+
+	/**
+	 * store the visible objects which are not outside of the frustum
+	 */
+	void findVisibleObjects(
+			const cFrustum &p_frustum,
+			std::vector<iGraphicsObject*> &o_objects
+		)	const;
+};
+
+#endif //__C_GRAPHICS_BVH_HPP__
@@ -0,0 +1,107 @@
+/*
+ * Copyright 2010 Martin Schreiber
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef __C_RENDER_QUEUE_HPP__
+#define __C_RENDER_QUEUE_HPP__
+
+#include "sbndengine/graphics/iGraphicsObject.hpp"
+#include "libmath/CMatrix.hpp"
+#include <map>
+#include <vector>
+
+/*
+ * bits of the sort key fields, from the most to the least significant field
+ */
+#define RENDER_QUEUE_SHADER_BITS		2
+#define RENDER_QUEUE_TEXTURE_BITS		12
+#define RENDER_QUEUE_NORMAL_MAP_BITS	12
+#define RENDER_QUEUE_MATERIAL_BITS		12
+#define RENDER_QUEUE_FACTORY_BITS		12
+#define RENDER_QUEUE_DEPTH_BITS			14
+
+
+/**
+ * \brief visible objects of a frame sorted by their render state
+ *
+ * the queue is built each frame from the visible objects. every object gets
+ * a 64 bit sort key with the fields (most significant first):
+ *
+ * - shader (no texture, texture, texture with normal map)
+ * - texture
+ * - normal map
+ * - material
+ * - factory
+ * - depth (front to back)
+ *
+ * thus the objects using the same shader and textures are drawn one after
+ * the other and only the state changes between them have to be applied.
+ * the objects with the same material and factory are adjacent and can be
+ * drawn with a single instanced draw call.
+ *
+ * the textures, materials and factories are numbered in the order of their
+ * first use in the frame. if there are more than fit into a field, the
+ * numbers wrap around. this only changes the order, since the groups are
+ * compared with the pointers (isSameGroup()).
+ */
+class cRenderQueue
+{
+	class cItem
+	{
+	public:
+		unsigned long long key;
+		iGraphicsObject *object;
+
+		// distance in front of the camera
+		float depth;
+
+		bool operator<(const cItem &p_item) const
+		{
+			return key < p_item.key;
+		}
+	};
+
+	std::vector<cItem> items;
+
+	// numbers of the textures, materials and factories in the current frame
+	std::map<const void*, unsigned int> texture_ids;
+	std::map<const void*, unsigned int> material_ids;
+	std::map<const void*, unsigned int> factory_ids;
+
+	static unsigned int getId(std::map<const void*, unsigned int> &p_ids, const void *p_pointer);
+
+public:
+	/**
+	 * visible objects sorted by the sort key
+	 */
+	std::vector<iGraphicsObject*> objects;
+
+	/**
+	 * setup the queue with the objects to draw
+	 *
+	 * \param p_view_matrix	view matrix of the camera to compute the depth
+	 */
+	void build(
+			const std::vector<iGraphicsObject*> &p_objects,
+			const CMatrix4<float> &p_view_matrix
+		);
+
+	/**
+	 * return true if both objects use the same factory and material
+	 */
+	static bool isSameGroup(const iGraphicsObject &a, const iGraphicsObject &b);
+};
+
+#endif //__C_RENDER_QUEUE_HPP__
@@ -39,10 +39,24 @@ class iDraw3D
 	iShaderManager shaderManager;
 
 	/** Default shader for objects */
-	GLuint defaultShader;
+	unsigned int defaultShader;
 
 	/** Shader for objects with normal map */
-	GLuint normalShader;
+	unsigned int normalShader;
+
+	/**
+	 * setup the texture, color and shader of the material of an object.
+	 * only the changes to the render state of the last object are applied.
+	 *
+	 * \param p_instanced	use the shaders for instanced drawing
+	 */
+	void setupMaterial(iGraphicsObject &p_graphics_object, bool p_instanced);
+
+	/**
+	 * draw an object without resetting the render state
+	 */
+	void drawSingleObject(iGraphicsObject &p_graphics_object);
+
 public:
 	iDraw3D();
 	virtual ~iDraw3D();
@@ -72,6 +86,22 @@ public:
 	void drawObject(iObject &object, iGraphicsMaterial &material);
 	void drawObject(iGraphicsObject &object);
 
+	/**
+	 * draw objects with the same factory and material. the objects are drawn
+	 * with a single instanced draw call if the shaders are available.
+	 *
+	 * only the changes to the render state of the last drawn object are
+	 * applied, thus resetRenderState() has to be called before the first
+	 * and after the last call.
+	 */
+	void drawObjectInstances(iGraphicsObject *const *p_objects, size_t p_count);
+
+	/**
+	 * set the render state (shader, textures, lighting) of the fixed
+	 * function pipeline without texture
+	 */
+	void resetRenderState();
+
 	void drawLine(
 			const CVector<3,float> &p1,
 			const CVector<3,float> &p2,
@@ -20,8 +20,11 @@
 #include "sbndengine/graphics/iGraphicsObject.hpp"
 #include "sbndengine/graphics/iGraphicsObjectConnector.hpp"
 #include "sbndengine/graphics/iDraw3D.hpp"
+#include "sbndengine/graphics/cRenderQueue.hpp"
+#include "sbndengine/graphics/cGraphicsBVH.hpp"
 #include "sbndengine/iRef.hpp"
 #include <list>
+#include <vector>
 
 /**
  * \brief graphic objects abstraction layer of the 3d engine
@@ -37,6 +40,15 @@ class iGraphics	: public iDraw3D
 	// list with objects to draw
 	std::list<iRef<iGraphicsObjectConnector> > objectConnectorList;
 
+	// hierarchy of the objects to find the objects inside of the view frustum
+	cGraphicsBVH objectHierarchy;
+
+	// objects of the current frame inside of the view frustum
+	std::vector<iGraphicsObject*> visibleObjects;
+
+	// visible objects of the current frame sorted by their render state
+	cRenderQueue renderQueue;
+
 public:
 	void clear();
 
@@ -39,6 +39,8 @@
 #include "engine/cObjectFactoryBox.hpp"
 #include "engine/cObjectFactoryPlane.hpp"
 #include "engine/cObjectFactorySphere.hpp"
+#include "engine/cObjectFactoryConvexHull.hpp"
+#include "engine/cObjectFactoryTriangleMesh.hpp"
 #include "engine/iObjectRayIntersection.hpp"
 #include "graphics/iGraphics.hpp"
 #include "graphics/iTexture.hpp"
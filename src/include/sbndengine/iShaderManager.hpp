@@ -21,17 +21,20 @@
 #include <map>
 #include <fstream>
 
-#include <GL/gl.h>
+/*
+ * the OpenGL names are stored as unsigned int (GLuint) to keep OpenGL out of
+ * the engine headers
+ */
 
 struct shaderComponent {
-    GLuint vertexShader;
-    GLuint fragmentShader;
+    unsigned int vertexShader;
+    unsigned int fragmentShader;
 };
 
 class iShaderManager
 {
 private:
-    std::map<GLuint, shaderComponent> shaders;
+    std::map<unsigned int, shaderComponent> shaders;
     
 public:
     iShaderManager() {};
@@ -45,13 +48,13 @@ public:
      */
     bool createProgram(const char* vertexShaderFilename,
     		const char* fragmentShaderFilename,
-    		GLuint &program);
+    		unsigned int &program);
     
 private:
     /**
      * \brief Loads and compiles a shader from a file
      */
-    static bool loadCompileShader(const char* filename, GLuint shader);
+    static bool loadCompileShader(const char* filename, unsigned int shader);
 
     /**
      * \brief Return the size of a file
@@ -61,7 +64,7 @@ private:
     /**
      * \brief Prints to log information of a shader to stderr
      */
-    static void printInfo(GLuint object, bool isShader = true);
+    static void printInfo(unsigned int object, bool isShader = true);
 };
 
 #endif // __ISHADERMANAGER_HPP
@@ -55,6 +55,8 @@ public:
 	virtual ~cPhysicsHardConstraintRope();
 
 	bool updateHardConstraintsCollisions(class CPhysicsCollisionData &c);
+
+	void getPhysicsObjects(iPhysicsObject *&o_physics_object1, iPhysicsObject *&o_physics_object2);
 };
 
 #endif
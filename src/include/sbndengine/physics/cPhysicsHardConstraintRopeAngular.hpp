@@ -61,6 +61,8 @@ public:
 	virtual ~cPhysicsHardConstraintRopeAngular();
 
 	bool updateHardConstraintsCollisions(class CPhysicsCollisionData &c);
+
+	void getPhysicsObjects(iPhysicsObject *&o_physics_object1, iPhysicsObject *&o_physics_object2);
 };
 
 #endif
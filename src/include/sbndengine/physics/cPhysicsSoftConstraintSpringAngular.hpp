@@ -64,6 +64,8 @@ public:
 
 	void updateAcceleration(double frame_elapsed_seconds);
 
+	void getPhysicsObjects(iPhysicsObject *&o_physics_object1, iPhysicsObject *&o_physics_object2);
+
 	void activate();
 	void deactivate();
 };
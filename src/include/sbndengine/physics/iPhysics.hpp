@@ -25,6 +25,7 @@
 #include "libmath/CVector.hpp"
 #include "sbndengine/iTime.hpp"
 #include "sbndengine/physics/iPhysicsDebug.hpp"
+#include "sbndengine/physics/iPhysicsStatistics.hpp"
 
 class iPhysicsDebug;
 
@@ -42,6 +43,16 @@ class iPhysics
 public:
 	class iPhysicsDebug debug;
 
+	/**
+	 * algorithms available to find the pairs of objects which may collide
+	 */
+	enum
+	{
+		BROADPHASE_SWEEP_AND_PRUNE,	///< sorted bounding boxes along one axis
+		BROADPHASE_SPATIAL_HASH,	///< uniform grid with cell size depending on the object sizes
+		BROADPHASE_AABB_TREE		///< bounding volume trees for static and movable objects (default)
+	};
+
 	iPhysics();
 	~iPhysics();
 
@@ -93,12 +104,28 @@ public:
 	void setGravitation(const CVector<3,float> &p_gravitation_vector);
 
 	/**
-	 * do one timestep
+	 * do all fixed timesteps which are due until p_elapsed_seconds (at most
+	 * the maximum number of substeps) and interpolate the render model
+	 * matrices of the objects between the last two timesteps
 	 *
 	 * \param p_elapsed_seconds	elapsed seconds since start of simulation
 	 */
 	void simulationTimestep(double p_elapsed_seconds);
 
+	/**
+	 * set the maximum number of fixed timesteps done by one call of
+	 * simulationTimestep(). if the program runs slower, the simulation slows
+	 * down instead of falling behind further and further.
+	 */
+	void setMaximumSubsteps(int p_max_substeps);
+
+	/**
+	 * return the position of the current frame between the states before (0)
+	 * and after (1) the last timestep which was used to interpolate the
+	 * render model matrices
+	 */
+	double getInterpolationAlpha();
+
 	/**
 	 * reset the whole class to a virgin state
 	 */
@@ -107,11 +134,48 @@ public:
 	/**
 	 * set maximum values for iterations
 	 *
-	 * global iterations are used to solve interpenetrations between all objects.
-	 * local iterations are used to solve interpenetrations between a pair of objects.
+	 * the collisions are detected once per timestep. position iterations are
+	 * used to solve the interpenetrations of the detected collisions, velocity
+	 * iterations to solve the collision impulses.
+	 */
+	void setMaximumIterations(int p_max_position_iterations, int p_velocity_iterations);
+
+	/**
+	 * objects which are connected by collisions or constraints form an island.
+	 * if all objects of an island move slower than the velocity thresholds for
+	 * p_time_threshold seconds, the island is sent to sleep until it is
+	 * touched by another object.
+	 *
+	 * set p_time_threshold to zero to disable sleeping.
 	 */
-	void setMaximumIterations(int p_max_global_iterations, int p_max_local_iterations);
+	void setSleepingParameters(float p_linear_velocity_threshold, float p_angular_velocity_threshold, float p_time_threshold);
 
+	/**
+	 * set the number of threads used by the physics engine
+	 *
+	 * the results do not depend on the number of threads.
+	 *
+	 * \param p_number_of_threads	number of threads (0 = one thread for each processor, default 1)
+	 */
+	void setNumberOfThreads(int p_number_of_threads);
+
+	/**
+	 * choose the algorithm to find the pairs of objects which may collide
+	 *
+	 * \param p_broadphase_type	one of the BROADPHASE_* values
+	 */
+	void setBroadphase(int p_broadphase_type);
+
+	/**
+	 * return the runtime and workload accumulated since the last reset of
+	 * the statistics (see iPhysicsStatistics)
+	 */
+	iPhysicsStatistics getStatistics();
+
+	/**
+	 * reset the statistics. reset() also resets the statistics.
+	 */
+	void resetStatistics();
 
 	/**
 	 * sets the time interval in seconds which have to be gone until one simulation step is done.
@@ -125,6 +189,35 @@ public:
 			double p_elapsed_seconds
 		);
 
+	/**
+	 * run the timesteps on an own thread with the fixed update interval
+	 * independent of the frame rate.
+	 *
+	 * simulationTimestep() then only takes over the newest object states of
+	 * the simulation thread for rendering and addImpulseToObjectAtPoint()
+	 * queues the impulses for the next timestep. the methods of this class
+	 * synchronize with the simulation thread. objects and constraints which
+	 * are modified directly have to be modified between lock() and unlock().
+	 *
+	 * the debug mode is stopped.
+	 */
+	void startSimulationThread();
+
+	/**
+	 * stop the simulation thread and continue with the timesteps of
+	 * simulationTimestep()
+	 */
+	void stopSimulationThread();
+
+	bool isSimulationThreadRunning();
+
+	/**
+	 * wait until the simulation thread finished its timesteps and keep it
+	 * from starting new ones until unlock() is called (may be nested)
+	 */
+	void lock();
+	void unlock();
+
 	/**
 	 * return a reference to the physics object if one exists with the given
 	 * identifier string
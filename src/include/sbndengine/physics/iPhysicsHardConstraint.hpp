@@ -33,6 +33,11 @@ class iPhysicsHardConstraint	: public iBase
 {
 public:
 	virtual bool updateHardConstraintsCollisions(class CPhysicsCollisionData &c) = 0;
+
+	/**
+	 * return both objects connected by the constraint
+	 */
+	virtual void getPhysicsObjects(class iPhysicsObject *&o_physics_object1, class iPhysicsObject *&o_physics_object2) = 0;
 };
 
 #endif
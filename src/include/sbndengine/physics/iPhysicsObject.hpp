@@ -32,6 +32,9 @@
  *  - the physical relevant parameters
  *  - the current state of the object
  *  - the accumulators for the integrator regarding the object
+ *
+ * the values used by the integrator are references to the slot of the
+ * iObject in cObjectStore.
  */
 class iPhysicsObject	:	public iBase
 {
@@ -40,6 +43,10 @@ class iPhysicsObject	:	public iBase
 	friend class iPhysicsConstraintSpring;
 	friend class cPhysicsEngine_Private;
 
+	// the references to the object store must not be copied
+	iPhysicsObject(const iPhysicsObject &);
+	iPhysicsObject &operator=(const iPhysicsObject &);
+
 public:
 	/**
 	 * reference to the iObject
@@ -49,24 +56,24 @@ public:
 	/**
 	 * the linear velocity of the object
 	 */
-	CVector<3,float> velocity;
+	CVector<3,float> &velocity;
 
 	/**
 	 * the angular speed and angular speed alignment of the object - given in world-space
 	 *
 	 * the length of this vector specifies the amount of speed
 	 */
-	CVector<3,float> angular_velocity;
+	CVector<3,float> &angular_velocity;
 
 	/**
 	 * integrator variable: the linear acceleration for which the object is exerted for one frame
 	 */
-	CVector<3,float> linear_acceleration_accumulator;
+	CVector<3,float> &linear_acceleration_accumulator;
 
 	/**
 	 * integrator variable: the linear acceleration for which the object is exerted for one frame
 	 */
-	CVector<3,float> torque_accumulator;
+	CVector<3,float> &torque_accumulator;
 
 	/**
 	 * this flag controls how to apply impulses for collision handling.
@@ -79,7 +86,7 @@ public:
 	 * movable is set to false to avoid any movements of the object.
 	 * this can also be done by setting inv_mass to zero
 	 */
-	bool movable;
+	bool &movable;
 
 	/**
 	 * inverse mass
@@ -88,7 +95,7 @@ public:
 	 * mass is more frequently used and the equations using 'only' the mass can be rewritten to
 	 * utilize the inverse mass
 	 */
-	float inv_mass;
+	float &inv_mass;
 
 	/**
 	 * coefficient of restitution (COF) controls the amount of separating velocity depending
@@ -117,7 +124,42 @@ public:
 	 * the rotational inertia setup once from the factory
 	 */
 	CMatrix3<float> rotational_inertia;
-	CMatrix3<float> rotational_inverse_inertia;
+	CMatrix3<float> &rotational_inverse_inertia;
+
+	/**
+	 * sleeping objects are neither integrated nor tested for collisions with
+	 * other sleeping or fixed objects until they are woken up
+	 */
+	bool &sleeping;
+
+	/**
+	 * set to false to keep the object awake (e. g. objects which are moved
+	 * directly by the application)
+	 */
+	bool sleeping_allowed;
+
+	/**
+	 * fast spheres (e. g. projectiles) are swept from their position at the
+	 * beginning of the timestep to the new one to avoid that they tunnel
+	 * through thin planes and boxes
+	 */
+	bool &continuous_collision_detection;
+
+	/**
+	 * seconds for which the velocities stayed below the sleeping thresholds
+	 */
+	float sleep_time;
+
+	/**
+	 * simulation island of the object. only valid during a timestep.
+	 */
+	int island;
+
+	/**
+	 * id of the island with which the object was sent to sleep. all objects
+	 * with the same id are woken up together.
+	 */
+	unsigned int sleeping_island_id;
 
 public:
 	iPhysicsObject(
@@ -133,11 +175,41 @@ public:
 
 	void setMoveability(bool movable);
 
+	/**
+	 * wake up the object if it is sleeping
+	 */
+	void wakeUp();
+
+	/**
+	 * return true, if the object is sleeping
+	 */
+	bool isSleeping();
+
+	/**
+	 * allow or forbid sending the object to sleep
+	 */
+	void setSleepingAllowed(bool p_sleeping_allowed);
+
+	/**
+	 * enable or disable the continuous collision detection (spheres only)
+	 */
+	void setContinuousCollisionDetection(bool p_flag);
+
 	/**
 	 * set the acceleration and torque to zero
 	 */
 	void setZero();
 
+	/**
+	 * move the object to the given position and wake it up
+	 */
+	void setPosition(const CVector<3,float> &p_position);
+
+	/**
+	 * move the object by p_translation and wake it up
+	 */
+	void translate(const CVector<3,float> &p_translation);
+
 	/**
 	 * set the speed to the given value
 	 */
@@ -31,6 +31,11 @@ class iPhysicsSoftConstraint	: public iBase
 {
 public:
 	virtual void updateAcceleration(double frame_elapsed_seconds) = 0;
+
+	/**
+	 * return both objects connected by the constraint
+	 */
+	virtual void getPhysicsObjects(class iPhysicsObject *&o_physics_object1, class iPhysicsObject *&o_physics_object2) = 0;
 };
 
 #endif
@@ -0,0 +1,93 @@
+/*
+ * Copyright 2010 Martin Schreiber
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef __I_PHYSICS_STATISTICS_HPP__
+#define __I_PHYSICS_STATISTICS_HPP__
+
+/**
+ * \brief runtime and workload of the timesteps
+ *
+ * all values are accumulated over the timesteps since the last reset of the
+ * statistics. the seconds are measured with a monotonic clock.
+ */
+class iPhysicsStatistics
+{
+public:
+	// number of timesteps
+	long timesteps;
+
+	// seconds of all timesteps
+	double total_seconds;
+
+	// constant accelerations, soft constraints and integration
+	double integrate_seconds;
+
+	// pairs of objects with overlapping bounding boxes
+	double broadphase_seconds;
+
+	// contact points of the broadphase pairs and hard constraints
+	double narrowphase_seconds;
+
+	// simulation islands
+	double islands_seconds;
+
+	// collision impulses
+	double impulse_seconds;
+
+	// resolution of the interpenetrations
+	double interpenetration_seconds;
+
+	// pairs returned by the broadphase
+	long broadphase_pairs;
+
+	// contact points including the hard constraints
+	long contacts;
+
+	// islands with contacts
+	long islands;
+
+	// iterations over the contacts to solve the impulses
+	long velocity_iterations;
+
+	// iterations to resolve the interpenetrations (maximum of all islands)
+	long position_iterations;
+
+	iPhysicsStatistics()
+	{
+		clear();
+	}
+
+	void clear()
+	{
+		timesteps = 0;
+
+		total_seconds = 0;
+		integrate_seconds = 0;
+		broadphase_seconds = 0;
+		narrowphase_seconds = 0;
+		islands_seconds = 0;
+		impulse_seconds = 0;
+		interpenetration_seconds = 0;
+
+		broadphase_pairs = 0;
+		contacts = 0;
+		islands = 0;
+		velocity_iterations = 0;
+		position_iterations = 0;
+	}
+};
+
+#endif //__I_PHYSICS_STATISTICS_HPP__
@@ -322,6 +322,8 @@ public:
 		engine.graphics.addObject(character.graphics_object);
 		engine.addObject(*character.object);
 		character.physics_object = new iPhysicsObject(*character.object);
+		// the character is moved directly and must not fall asleep
+		character.physics_object->setSleepingAllowed(false);
 		engine.physics.addObject(character.physics_object);
 	}
 
@@ -538,6 +540,9 @@ public:
 						// set the mass of the object mouse cube to the same as the object
 						physicObjects.sphere_mouse_start->setInverseMass(((iPhysicsObject*)selected_object->physics_engine_ptr)->inv_mass);
 
+						// spheres thrown with the mouse get fast enough to tunnel through the walls
+						((iPhysicsObject*)selected_object->physics_engine_ptr)->setContinuousCollisionDetection(true);
+
 						engineObjects.sphere_mouse_end->setPosition(intersection_point);
 						engineObjects.sphere_mouse_end->updateModelMatrix();
 						graphicsObjects.sphere_mouse_end->setVisible();
@@ -618,7 +623,7 @@ public:
 			/*
 			 * CAMERA MOVEMENTS
 			 */
-            character.object->translate(playerVelocity * game_camera.view_matrix * engine.time.frame_elapsed_seconds);
+            character.physics_object->translate(playerVelocity * game_camera.view_matrix * engine.time.frame_elapsed_seconds);
 			game_camera.update(character.object->position);
 			game_camera.frustum(-1.5f,1.5f,-1.5f*engine.window.aspect_ratio,1.5f*engine.window.aspect_ratio,1,100);
 			game_camera.computeMatrices();
@@ -800,6 +805,7 @@ public:
 				case 'b':       scene_id = 27;    setupWorld();    break;
 				case 'n':       scene_id = 28;    setupWorld();    break;
 				case 'm':       scene_id = 29;    setupWorld();    break;
+				case ',':		scene_id = 30;	setupWorld();	break;
 
 				/*
 				 * physics engine debug stuff
@@ -825,14 +831,26 @@ public:
                     break;
 				case SBND_EVENT_KEY_LEFT:
                 case 'a': case 'A':
-                    character.physics_object->angular_velocity[1] = 1.5;
+				{
+					CVector<3,float> angular_velocity = character.physics_object->angular_velocity;
+					angular_velocity[1] = 1.5;
+					character.physics_object->setAngularSpeed(angular_velocity);
+				}
                     break;
 				case SBND_EVENT_KEY_RIGHT:
                 case 'd': case 'D':
-                    character.physics_object->angular_velocity[1] = -1.5;
+				{
+					CVector<3,float> angular_velocity = character.physics_object->angular_velocity;
+					angular_velocity[1] = -1.5;
+					character.physics_object->setAngularSpeed(angular_velocity);
+				}
 					break;
 				case ' ':
-					character.physics_object->velocity[1] = 10;
+				{
+					CVector<3,float> velocity = character.physics_object->velocity;
+					velocity[1] = 10;
+					character.physics_object->setSpeed(velocity);
+				}
 					break;
 			}
 		}
@@ -865,7 +883,11 @@ public:
                 case 'a': case 'A':
 				case SBND_EVENT_KEY_RIGHT:
                 case 'd': case 'D':
-					character.physics_object->angular_velocity[1] = 0;
+				{
+					CVector<3,float> angular_velocity = character.physics_object->angular_velocity;
+					angular_velocity[1] = 0;
+					character.physics_object->setAngularSpeed(angular_velocity);
+				}
 					break;
 			}
 		}
@@ -0,0 +1,372 @@
+/*
+ * Copyright 2010 Martin Schreiber
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "sbndengine/engine/cIndexedMesh.hpp"
+#include <algorithm>
+#include <math.h>
+
+
+/**
+ * strict ordering of the separate vertices by position, normal and texture
+ * coordinate, thus equal vertices are adjacent after sorting
+ */
+class cVertexLess
+{
+	const float *vertices;
+	const float *normals;
+	const float *texcoords;
+
+	static inline int compare(const float *a, const float *b, int n)
+	{
+		for (int i = 0; i < n; i++)
+		{
+			if (a[i] < b[i])	return -1;
+			if (b[i] < a[i])	return 1;
+		}
+		return 0;
+	}
+
+public:
+	cVertexLess(const float *p_vertices, const float *p_normals, const float *p_texcoords)	:
+		vertices(p_vertices),
+		normals(p_normals),
+		texcoords(p_texcoords)
+	{
+	}
+
+	int compare(int a, int b) const
+	{
+		int c = compare(vertices+a*3, vertices+b*3, 3);
+
+		if (c == 0 && normals != NULL)
+			c = compare(normals+a*3, normals+b*3, 3);
+
+		if (c == 0 && texcoords != NULL)
+			c = compare(texcoords+a*2, texcoords+b*2, 2);
+
+		return c;
+	}
+
+	bool operator()(int a, int b) const
+	{
+		return compare(a, b) < 0;
+	}
+};
+
+
+cIndexedMesh::cIndexedMesh()	:
+	geometry_version(0)
+{
+}
+
+
+void cIndexedMesh::build(
+		const float *p_vertices,
+		const float *p_normals,
+		const float *p_texcoords,
+		int p_triangles_count
+	)
+{
+	weld(p_vertices, p_normals, p_texcoords, p_triangles_count);
+	optimizeVertexCache();
+	reorderVertices();
+}
+
+
+void cIndexedMesh::weld(
+		const float *p_vertices,
+		const float *p_normals,
+		const float *p_texcoords,
+		int p_triangles_count
+	)
+{
+	int count = p_triangles_count*3;
+
+	cVertexLess less(p_vertices, p_normals, p_texcoords);
+
+	/*
+	 * sort the separate vertices. the stable sort keeps the first vertex of
+	 * a group of equal vertices in front, this one is used for all of them.
+	 */
+	std::vector<int> sorted(count);
+	for (int i = 0; i < count; i++)
+		sorted[i] = i;
+
+	std::stable_sort(sorted.begin(), sorted.end(), less);
+
+	std::vector<int> first_equal(count);
+	for (int i = 0; i < count; i++)
+	{
+		if (i > 0 && less.compare(sorted[i-1], sorted[i]) == 0)
+			first_equal[sorted[i]] = first_equal[sorted[i-1]];
+		else
+			first_equal[sorted[i]] = sorted[i];
+	}
+
+	// number the welded vertices in the order of the triangles
+	std::vector<unsigned int> welded_index(count);
+
+	vertices.clear();
+	normals.clear();
+	texcoords.clear();
+	indices.clear();
+
+	for (int i = 0; i < count; i++)
+	{
+		int f = first_equal[i];
+
+		if (f < i)
+		{
+			welded_index[i] = welded_index[f];
+			continue;
+		}
+
+		welded_index[i] = vertices.size()/3;
+
+		vertices.insert(vertices.end(), p_vertices+i*3, p_vertices+i*3+3);
+
+		if (p_normals != NULL)
+			normals.insert(normals.end(), p_normals+i*3, p_normals+i*3+3);
+
+		if (p_texcoords != NULL)
+			texcoords.insert(texcoords.end(), p_texcoords+i*2, p_texcoords+i*2+2);
+	}
+
+	indices.reserve(count);
+	for (int i = 0; i < count; i += 3)
+	{
+		unsigned int i0 = welded_index[i];
+		unsigned int i1 = welded_index[i+1];
+		unsigned int i2 = welded_index[i+2];
+
+		if (i0 == i1 || i1 == i2 || i2 == i0)
+			continue;
+
+		indices.push_back(i0);
+		indices.push_back(i1);
+		indices.push_back(i2);
+	}
+}
+
+
+/**
+ * score of a vertex: vertices in the cache and vertices with only a few
+ * triangles left are preferred
+ *
+ * \param p_cache_position	-1 if the vertex is not in the cache
+ */
+static float getVertexScore(int p_cache_position, int p_remaining_triangles)
+{
+	if (p_remaining_triangles == 0)
+		return -1.0f;
+
+	float score = 0;
+
+	if (p_cache_position >= 0)
+	{
+		// the vertices of the last triangle get a fixed score
+		if (p_cache_position < 3)
+		{
+			score = 0.75f;
+		}
+		else
+		{
+			float s = 1.0f - (float)(p_cache_position - 3)/(float)(INDEXED_MESH_VERTEX_CACHE_SIZE - 3);
+			score = powf(s, 1.5f);
+		}
+	}
+
+	score += 2.0f/sqrtf((float)p_remaining_triangles);
+
+	return score;
+}
+
+
+void cIndexedMesh::optimizeVertexCache()
+{
+	int triangles_count = indices.size()/3;
+	int vertex_count = vertices.size()/3;
+
+	if (triangles_count == 0)
+		return;
+
+	/*
+	 * triangles of each vertex: the not yet emitted triangles of vertex v are
+	 * vertex_triangles[vertex_first[v], vertex_first[v]+remaining[v])
+	 */
+	std::vector<int> remaining(vertex_count, 0);
+	for (size_t i = 0; i < indices.size(); i++)
+		remaining[indices[i]]++;
+
+	std::vector<int> vertex_first(vertex_count+1, 0);
+	for (int v = 0; v < vertex_count; v++)
+		vertex_first[v+1] = vertex_first[v] + remaining[v];
+
+	std::vector<int> vertex_triangles(indices.size());
+	{
+		std::vector<int> fill(vertex_first.begin(), vertex_first.end()-1);
+		for (size_t i = 0; i < indices.size(); i++)
+			vertex_triangles[fill[indices[i]]++] = i/3;
+	}
+
+	std::vector<int> cache_position(vertex_count, -1);
+	std::vector<float> vertex_score(vertex_count);
+	for (int v = 0; v < vertex_count; v++)
+		vertex_score[v] = getVertexScore(-1, remaining[v]);
+
+	std::vector<float> triangle_score(triangles_count);
+	for (int t = 0; t < triangles_count; t++)
+		triangle_score[t] = vertex_score[indices[t*3]] + vertex_score[indices[t*3+1]] + vertex_score[indices[t*3+2]];
+
+	std::vector<bool> emitted(triangles_count, false);
+
+	std::vector<unsigned int> optimized_indices;
+	optimized_indices.reserve(indices.size());
+
+	// the cache may hold the vertices of one more triangle before it is truncated
+	std::vector<int> cache;
+	std::vector<int> new_cache;
+	cache.reserve(INDEXED_MESH_VERTEX_CACHE_SIZE+3);
+	new_cache.reserve(INDEXED_MESH_VERTEX_CACHE_SIZE+3);
+
+	int best_triangle = 0;
+
+	// next triangle to check if no triangle of the cached vertices is left
+	int next_unused = 0;
+
+	for (int emitted_count = 0; emitted_count < triangles_count; emitted_count++)
+	{
+		if (best_triangle < 0)
+		{
+			while (emitted[next_unused])
+				next_unused++;
+
+			best_triangle = next_unused;
+		}
+
+		const unsigned int *tri = &indices[best_triangle*3];
+
+		optimized_indices.insert(optimized_indices.end(), tri, tri+3);
+		emitted[best_triangle] = true;
+
+		// remove the triangle from the lists of its vertices
+		for (int k = 0; k < 3; k++)
+		{
+			int v = tri[k];
+			int *list = &vertex_triangles[vertex_first[v]];
+
+			for (int j = 0; j < remaining[v]; j++)
+			{
+				if (list[j] == best_triangle)
+				{
+					list[j] = list[remaining[v]-1];
+					break;
+				}
+			}
+			remaining[v]--;
+		}
+
+		// move the vertices of the triangle to the front of the cache
+		new_cache.clear();
+		new_cache.insert(new_cache.end(), tri, tri+3);
+
+		for (size_t c = 0; c < cache.size(); c++)
+			if (cache[c] != (int)tri[0] && cache[c] != (int)tri[1] && cache[c] != (int)tri[2])
+				new_cache.push_back(cache[c]);
+
+		// update the scores of the vertices whose cache position changed
+		for (size_t c = 0; c < new_cache.size(); c++)
+		{
+			int v = new_cache[c];
+			cache_position[v] = (c < INDEXED_MESH_VERTEX_CACHE_SIZE ? (int)c : -1);
+
+			float score = getVertexScore(cache_position[v], remaining[v]);
+			float delta = score - vertex_score[v];
+			vertex_score[v] = score;
+
+			const int *list = &vertex_triangles[vertex_first[v]];
+			for (int j = 0; j < remaining[v]; j++)
+				triangle_score[list[j]] += delta;
+		}
+
+		// the next triangle is the best one of the cached vertices
+		best_triangle = -1;
+		float best_score = -1.0f;
+
+		for (size_t c = 0; c < new_cache.size() && c < INDEXED_MESH_VERTEX_CACHE_SIZE; c++)
+		{
+			int v = new_cache[c];
+			const int *list = &vertex_triangles[vertex_first[v]];
+
+			for (int j = 0; j < remaining[v]; j++)
+			{
+				if (triangle_score[list[j]] > best_score)
+				{
+					best_score = triangle_score[list[j]];
+					best_triangle = list[j];
+				}
+			}
+		}
+
+		if (new_cache.size() > INDEXED_MESH_VERTEX_CACHE_SIZE)
+			new_cache.resize(INDEXED_MESH_VERTEX_CACHE_SIZE);
+
+		cache.swap(new_cache);
+	}
+
+	indices.swap(optimized_indices);
+}
+
+
+void cIndexedMesh::reorderVertices()
+{
+	size_t vertex_count = vertices.size()/3;
+
+	std::vector<unsigned int> new_index(vertex_count, (unsigned int)-1);
+
+	std::vector<float> new_vertices;
+	std::vector<float> new_normals;
+	std::vector<float> new_texcoords;
+
+	new_vertices.reserve(vertices.size());
+	new_normals.reserve(normals.size());
+	new_texcoords.reserve(texcoords.size());
+
+	for (size_t i = 0; i < indices.size(); i++)
+	{
+		unsigned int v = indices[i];
+
+		if (new_index[v] == (unsigned int)-1)
+		{
+			new_index[v] = new_vertices.size()/3;
+
+			new_vertices.insert(new_vertices.end(), vertices.begin()+v*3, vertices.begin()+v*3+3);
+
+			if (!normals.empty())
+				new_normals.insert(new_normals.end(), normals.begin()+v*3, normals.begin()+v*3+3);
+
+			if (!texcoords.empty())
+				new_texcoords.insert(new_texcoords.end(), texcoords.begin()+v*2, texcoords.begin()+v*2+2);
+		}
+
+		indices[i] = new_index[v];
+	}
+
+	// vertices which are only used by degenerated triangles are dropped
+	vertices.swap(new_vertices);
+	normals.swap(new_normals);
+	texcoords.swap(new_texcoords);
+}
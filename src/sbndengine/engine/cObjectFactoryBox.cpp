@@ -33,6 +33,42 @@ float cObjectFactoryBox::getInverseMass()
 	return inv_mass;
 }
 
+CVector<3,float> cObjectFactoryBox::getSupportPoint(const CVector<3,float> &p_direction) const
+{
+	return CVector<3,float>(
+			p_direction.data[0] < 0 ? -half_size.data[0] : half_size.data[0],
+			p_direction.data[1] < 0 ? -half_size.data[1] : half_size.data[1],
+			p_direction.data[2] < 0 ? -half_size.data[2] : half_size.data[2]
+		);
+}
+
+int cObjectFactoryBox::getSupportFace(const CVector<3,float> &p_direction, CVector<3,float> *o_vertices, CVector<3,float> &o_normal) const
+{
+	int a = 0;
+	for (int i = 1; i < 3; i++)
+		if (CMath<float>::abs(p_direction.data[i]) > CMath<float>::abs(p_direction.data[a]))
+			a = i;
+
+	float sign = (p_direction.data[a] < 0 ? -1.0f : 1.0f);
+
+	CVector<3,float> center(0,0,0);
+	CVector<3,float> u(0,0,0);
+	CVector<3,float> v(0,0,0);
+	center.data[a] = half_size.data[a]*sign;
+	u.data[(a+1)%3] = half_size.data[(a+1)%3];
+	v.data[(a+2)%3] = half_size.data[(a+2)%3]*sign;
+
+	o_normal = CVector<3,float>(0,0,0);
+	o_normal.data[a] = sign;
+
+	// u x v has the direction of the normal
+	o_vertices[0] = center + u + v;
+	o_vertices[1] = center - u + v;
+	o_vertices[2] = center - u - v;
+	o_vertices[3] = center + u - v;
+	return 4;
+}
+
 cObjectFactoryBox::cObjectFactoryBox(
 		float p_size_x,
 		float p_size_y,
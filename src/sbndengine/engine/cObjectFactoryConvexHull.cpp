@@ -0,0 +1,616 @@
+/*
+ * Copyright 2010 Martin Schreiber
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "sbndengine/engine/cObjectFactoryConvexHull.hpp"
+#include <algorithm>
+#include <iostream>
+#include <map>
+
+
+/**
+ * points closer than HULL_RELATIVE_TOLERANCE * the size of the point cloud
+ * to the hull are not added to the hull
+ */
+#define HULL_RELATIVE_TOLERANCE		0.00001f
+
+/**
+ * adjacent triangles are merged to one face if the dot product of their
+ * normals is larger than HULL_COPLANAR_MIN_DOT
+ */
+#define HULL_COPLANAR_MIN_DOT		0.9999f
+
+
+typedef CVector<3,float> Vector;
+
+
+/**
+ * triangle of the hull during its construction
+ */
+class cHullTriangle
+{
+public:
+	int vertices[3];
+	Vector normal;
+	float offset;
+
+	cHullTriangle(const std::vector<Vector> &p_points, int a, int b, int c)
+	{
+		vertices[0] = a;
+		vertices[1] = b;
+		vertices[2] = c;
+
+		normal = ((p_points[b] - p_points[a]) % (p_points[c] - p_points[a])).getNormalized();
+		offset = normal.dotProd(p_points[a]);
+	}
+};
+
+
+CMatrix3<float> cObjectFactoryConvexHull::getRotationalInertia()
+{
+	CMatrix3<float> m = unit_rotational_inertia;
+	return m*mass;
+}
+
+float cObjectFactoryConvexHull::getInverseMass()
+{
+	return inv_mass;
+}
+
+
+CVector<3,float> cObjectFactoryConvexHull::getSupportPoint(const CVector<3,float> &p_direction) const
+{
+	if (hull_vertices.empty())
+		return Vector(0,0,0);
+
+	int v = extreme_vertices[0];
+	float max_dot = hull_vertices[v].dotProd(p_direction);
+
+	for (int i = 1; i < 6; i++)
+	{
+		float dot = hull_vertices[extreme_vertices[i]].dotProd(p_direction);
+		if (dot > max_dot)
+		{
+			max_dot = dot;
+			v = extreme_vertices[i];
+		}
+	}
+
+	/*
+	 * the hull is convex, thus a vertex without a better neighbour is the
+	 * support point
+	 */
+	while (true)
+	{
+		int next = -1;
+		for (int i = adjacency_start[v]; i < adjacency_start[v+1]; i++)
+		{
+			float dot = hull_vertices[adjacency[i]].dotProd(p_direction);
+			if (dot > max_dot)
+			{
+				max_dot = dot;
+				next = adjacency[i];
+			}
+		}
+
+		if (next < 0)
+			break;
+		v = next;
+	}
+
+	return hull_vertices[v];
+}
+
+
+int cObjectFactoryConvexHull::getSupportFace(const CVector<3,float> &p_direction, CVector<3,float> *o_vertices, CVector<3,float> &o_normal) const
+{
+	if (face_normals.empty())
+		return iObjectFactory::getSupportFace(p_direction, o_vertices, o_normal);
+
+	int best = 0;
+	float max_dot = face_normals[0].dotProd(p_direction);
+	for (size_t f = 1; f < face_normals.size(); f++)
+	{
+		float dot = face_normals[f].dotProd(p_direction);
+		if (dot > max_dot)
+		{
+			max_dot = dot;
+			best = f;
+		}
+	}
+
+	int n = 0;
+	for (int i = face_vertices_start[best]; i < face_vertices_start[best+1]; i++)
+		o_vertices[n++] = hull_vertices[face_vertices[i]];
+
+	o_normal = face_normals[best];
+	return n;
+}
+
+
+/**
+ * incremental construction: each point which is outside of the current hull
+ * replaces the triangles it sees with triangles connecting it to their
+ * horizon.
+ *
+ * the triangles are stored to o_triangles (3 indices of hull_vertices each).
+ */
+void cObjectFactoryConvexHull::computeHull(const CVector<3,float> *p_points, int p_points_count, std::vector<int> &o_triangles)
+{
+	o_triangles.clear();
+	hull_vertices.clear();
+
+	if (p_points_count < 4)
+	{
+		std::cerr << "ERROR: convex hull needs at least 4 points" << std::endl;
+		return;
+	}
+
+	std::vector<Vector> points(p_points, p_points + p_points_count);
+
+	Vector min = points[0];
+	Vector max = points[0];
+	for (int i = 1; i < p_points_count; i++)
+	{
+		for (int k = 0; k < 3; k++)
+		{
+			min.data[k] = CMath<float>::min(min.data[k], points[i].data[k]);
+			max.data[k] = CMath<float>::max(max.data[k], points[i].data[k]);
+		}
+	}
+
+	float tolerance = (max - min).getLength()*HULL_RELATIVE_TOLERANCE;
+
+	/*
+	 * initial tetrahedron: the point with the minimum x coordinate, the point
+	 * farthest away from it, the one farthest away from the line through
+	 * both and the one farthest away from the plane through all 3
+	 */
+	int t[4] = {0, 0, 0, 0};
+	for (int i = 1; i < p_points_count; i++)
+		if (points[i].data[0] < points[t[0]].data[0])
+			t[0] = i;
+
+	float max_distance = -1;
+	for (int i = 0; i < p_points_count; i++)
+	{
+		float distance = (points[i] - points[t[0]]).getLength2();
+		if (distance > max_distance)
+		{
+			max_distance = distance;
+			t[1] = i;
+		}
+	}
+
+	Vector line = (points[t[1]] - points[t[0]]).getNormalized();
+	max_distance = -1;
+	for (int i = 0; i < p_points_count; i++)
+	{
+		Vector d = points[i] - points[t[0]];
+		float distance = (d - line*line.dotProd(d)).getLength2();
+		if (distance > max_distance)
+		{
+			max_distance = distance;
+			t[2] = i;
+		}
+	}
+
+	Vector plane_normal = (line % (points[t[2]] - points[t[0]])).getNormalized();
+	max_distance = -1;
+	for (int i = 0; i < p_points_count; i++)
+	{
+		float distance = CMath<float>::abs(plane_normal.dotProd(points[i] - points[t[0]]));
+		if (distance > max_distance)
+		{
+			max_distance = distance;
+			t[3] = i;
+		}
+	}
+
+	if (	(points[t[1]] - points[t[0]]).getLength() <= tolerance ||
+			(points[t[2]] - points[t[0]]).getLength() <= tolerance ||
+			max_distance <= tolerance
+	)
+	{
+		std::cerr << "ERROR: convex hull of a flat point cloud" << std::endl;
+		return;
+	}
+
+	if (plane_normal.dotProd(points[t[3]] - points[t[0]]) > 0)
+		std::swap(t[1], t[2]);
+
+	std::vector<cHullTriangle> triangles;
+	triangles.push_back(cHullTriangle(points, t[0], t[1], t[2]));
+	triangles.push_back(cHullTriangle(points, t[0], t[3], t[1]));
+	triangles.push_back(cHullTriangle(points, t[1], t[3], t[2]));
+	triangles.push_back(cHullTriangle(points, t[2], t[3], t[0]));
+
+	std::vector<std::pair<int,int> > horizon;
+
+	for (int p = 0; p < p_points_count; p++)
+	{
+		if (p == t[0] || p == t[1] || p == t[2] || p == t[3])
+			continue;
+
+		horizon.clear();
+
+		for (int i = triangles.size()-1; i >= 0; i--)
+		{
+			cHullTriangle &tri = triangles[i];
+			if (tri.normal.dotProd(points[p]) - tri.offset <= tolerance)
+				continue;
+
+			/*
+			 * edges shared by 2 visible triangles are removed again, thus
+			 * only the horizon is left
+			 */
+			for (int e = 0; e < 3; e++)
+			{
+				std::pair<int,int> edge(tri.vertices[e], tri.vertices[(e+1)%3]);
+				std::vector<std::pair<int,int> >::iterator r = std::find(horizon.begin(), horizon.end(), std::make_pair(edge.second, edge.first));
+
+				if (r != horizon.end())
+					horizon.erase(r);
+				else
+					horizon.push_back(edge);
+			}
+
+			tri = triangles.back();
+			triangles.pop_back();
+		}
+
+		for (size_t e = 0; e < horizon.size(); e++)
+			triangles.push_back(cHullTriangle(points, horizon[e].first, horizon[e].second, p));
+	}
+
+	/*
+	 * store only the points used by the triangles
+	 */
+	std::vector<int> index(p_points_count, -1);
+
+	for (size_t i = 0; i < triangles.size(); i++)
+	{
+		for (int k = 0; k < 3; k++)
+		{
+			int v = triangles[i].vertices[k];
+			if (index[v] < 0)
+			{
+				index[v] = hull_vertices.size();
+				hull_vertices.push_back(points[v]);
+			}
+			o_triangles.push_back(index[v]);
+		}
+	}
+}
+
+
+/**
+ * the hull is split into tetrahedra with the origin. the volume, center of
+ * mass and covariance of each tetrahedron are known analytically.
+ */
+void cObjectFactoryConvexHull::computeMassProperties(const std::vector<int> &p_triangles)
+{
+	int triangles_count = p_triangles.size()/3;
+
+	// reference point inside of the hull for a better precision
+	Vector reference(0,0,0);
+	for (size_t i = 0; i < hull_vertices.size(); i++)
+		reference += hull_vertices[i];
+	reference *= 1.0f/(float)hull_vertices.size();
+
+	double total_volume = 0;
+	double center[3] = {0, 0, 0};
+
+	for (int t = 0; t < triangles_count; t++)
+	{
+		Vector a = hull_vertices[p_triangles[t*3+0]] - reference;
+		Vector b = hull_vertices[p_triangles[t*3+1]] - reference;
+		Vector c = hull_vertices[p_triangles[t*3+2]] - reference;
+
+		double det = a.dotProd(b % c);
+		total_volume += det/6.0;
+
+		for (int k = 0; k < 3; k++)
+			center[k] += det/24.0*(a.data[k] + b.data[k] + c.data[k]);
+	}
+
+	center_of_mass = reference + Vector(center[0]/total_volume, center[1]/total_volume, center[2]/total_volume);
+
+	for (size_t i = 0; i < hull_vertices.size(); i++)
+		hull_vertices[i] -= center_of_mass;
+
+	/*
+	 * covariance of a tetrahedron (0, a, b, c):
+	 * det(a,b,c)/120 * (a*a^T + b*b^T + c*c^T + (a+b+c)*(a+b+c)^T)
+	 */
+	double covariance[3][3] = {{0, 0, 0}, {0, 0, 0}, {0, 0, 0}};
+
+	for (int t = 0; t < triangles_count; t++)
+	{
+		const Vector &a = hull_vertices[p_triangles[t*3+0]];
+		const Vector &b = hull_vertices[p_triangles[t*3+1]];
+		const Vector &c = hull_vertices[p_triangles[t*3+2]];
+		Vector s = a + b + c;
+
+		double det = a.dotProd(b % c);
+
+		for (int i = 0; i < 3; i++)
+			for (int j = 0; j < 3; j++)
+				covariance[i][j] += det/120.0*(
+						a.data[i]*a.data[j] + b.data[i]*b.data[j] +
+						c.data[i]*c.data[j] + s.data[i]*s.data[j]
+					);
+	}
+
+	double trace = covariance[0][0] + covariance[1][1] + covariance[2][2];
+
+	for (int i = 0; i < 3; i++)
+		for (int j = 0; j < 3; j++)
+			unit_rotational_inertia[i][j] = ((i == j ? trace : 0) - covariance[i][j])/total_volume;
+
+	volume = total_volume;
+}
+
+
+/**
+ * merge the coplanar triangles to the faces returned by getSupportFace()
+ */
+void cObjectFactoryConvexHull::computeFaces(const std::vector<int> &p_triangles)
+{
+	int triangles_count = p_triangles.size()/3;
+
+	face_vertices.clear();
+	face_vertices_start.clear();
+	face_normals.clear();
+
+	std::vector<Vector> normals(triangles_count);
+	for (int t = 0; t < triangles_count; t++)
+	{
+		const Vector &a = hull_vertices[p_triangles[t*3+0]];
+		normals[t] = ((hull_vertices[p_triangles[t*3+1]] - a) % (hull_vertices[p_triangles[t*3+2]] - a)).getNormalized();
+	}
+
+	// triangle of each directed edge
+	std::map<std::pair<int,int>, int> edge_triangles;
+	for (int t = 0; t < triangles_count; t++)
+		for (int e = 0; e < 3; e++)
+			edge_triangles[std::make_pair(p_triangles[t*3+e], p_triangles[t*3+(e+1)%3])] = t;
+
+	/*
+	 * flood fill the groups of coplanar triangles
+	 */
+	std::vector<int> group(triangles_count, -1);
+	std::vector<int> stack;
+	int groups_count = 0;
+
+	for (int t = 0; t < triangles_count; t++)
+	{
+		if (group[t] >= 0)
+			continue;
+
+		group[t] = groups_count;
+		stack.push_back(t);
+
+		while (!stack.empty())
+		{
+			int u = stack.back();
+			stack.pop_back();
+
+			for (int e = 0; e < 3; e++)
+			{
+				std::map<std::pair<int,int>, int>::iterator n = edge_triangles.find(std::make_pair(p_triangles[u*3+(e+1)%3], p_triangles[u*3+e]));
+				if (n == edge_triangles.end() || group[n->second] >= 0)
+					continue;
+
+				if (normals[t].dotProd(normals[n->second]) < HULL_COPLANAR_MIN_DOT)
+					continue;
+
+				group[n->second] = groups_count;
+				stack.push_back(n->second);
+			}
+		}
+
+		groups_count++;
+	}
+
+	/*
+	 * the boundary of each group is the face. the next vertex of each
+	 * boundary vertex is stored to chain the boundary edges.
+	 */
+	std::vector<int> next(hull_vertices.size(), -1);
+	std::vector<int> members;
+
+	for (int g = 0; g < groups_count; g++)
+	{
+		members.clear();
+		for (int t = 0; t < triangles_count; t++)
+			if (group[t] == g)
+				members.push_back(t);
+
+		int start = -1;
+		int boundary_count = 0;
+		Vector normal(0,0,0);
+
+		for (size_t m = 0; m < members.size(); m++)
+		{
+			int t = members[m];
+			normal += normals[t];
+
+			for (int e = 0; e < 3; e++)
+			{
+				int a = p_triangles[t*3+e];
+				int b = p_triangles[t*3+(e+1)%3];
+
+				std::map<std::pair<int,int>, int>::iterator n = edge_triangles.find(std::make_pair(b, a));
+				if (n != edge_triangles.end() && group[n->second] == g)
+					continue;
+
+				next[a] = b;
+				start = a;
+				boundary_count++;
+			}
+		}
+
+		if (boundary_count > OBJECT_FACTORY_MAX_FACE_VERTICES)
+		{
+			// keep the triangles as separate faces
+			for (size_t m = 0; m < members.size(); m++)
+			{
+				face_vertices_start.push_back(face_vertices.size());
+				for (int e = 0; e < 3; e++)
+					face_vertices.push_back(p_triangles[members[m]*3+e]);
+				face_normals.push_back(normals[members[m]]);
+			}
+			continue;
+		}
+
+		face_vertices_start.push_back(face_vertices.size());
+
+		int v = start;
+		for (int i = 0; i < boundary_count; i++)
+		{
+			face_vertices.push_back(v);
+			v = next[v];
+		}
+
+		face_normals.push_back(normal.getNormalized());
+	}
+
+	face_vertices_start.push_back(face_vertices.size());
+}
+
+
+void cObjectFactoryConvexHull::computeAdjacency(const std::vector<int> &p_triangles)
+{
+	std::vector<std::pair<int,int> > edges;
+	for (size_t i = 0; i < p_triangles.size(); i += 3)
+		for (int e = 0; e < 3; e++)
+			edges.push_back(std::make_pair(p_triangles[i+e], p_triangles[i+(e+1)%3]));
+
+	// each edge is stored in both directions by the 2 adjacent triangles
+	std::sort(edges.begin(), edges.end());
+
+	adjacency.clear();
+	adjacency_start.assign(hull_vertices.size()+1, 0);
+
+	for (size_t i = 0; i < edges.size(); i++)
+	{
+		adjacency.push_back(edges[i].second);
+		adjacency_start[edges[i].first+1]++;
+	}
+
+	for (size_t i = 0; i < hull_vertices.size(); i++)
+		adjacency_start[i+1] += adjacency_start[i];
+
+	for (int k = 0; k < 6; k++)
+	{
+		int axis = k >> 1;
+		float sign = (k & 1 ? -1.0f : 1.0f);
+
+		extreme_vertices[k] = 0;
+		for (size_t i = 1; i < hull_vertices.size(); i++)
+			if (hull_vertices[i].data[axis]*sign > hull_vertices[extreme_vertices[k]].data[axis]*sign)
+				extreme_vertices[k] = i;
+	}
+}
+
+
+cObjectFactoryConvexHull::cObjectFactoryConvexHull(
+		const CVector<3,float> *p_points,
+		int p_points_count
+	)
+{
+	resizeConvexHull(p_points, p_points_count);
+
+	type = TYPE_CONVEX;
+	original_factory_ptr = this;
+}
+
+
+void cObjectFactoryConvexHull::resizeConvexHull(
+		const CVector<3,float> *p_points,
+		int p_points_count
+	)
+{
+	std::vector<int> triangles;
+	computeHull(p_points, p_points_count, triangles);
+
+	if (triangles.empty())
+	{
+		/*
+		 * degenerated point cloud (flat or collinear): keep an empty static
+		 * object since there's no valid rotational inertia
+		 */
+		hull_vertices.clear();
+		adjacency.clear();
+		adjacency_start.clear();
+		face_vertices.clear();
+		face_vertices_start.clear();
+		face_normals.clear();
+		center_of_mass = Vector(0,0,0);
+		volume = 0;
+		unit_rotational_inertia.setZero();
+		mass = CMath<float>::inf();
+		inv_mass = 0;
+		resizeTriangleList(0);
+		setupBoundingSphereRadius();
+		return;
+	}
+
+	computeMassProperties(triangles);
+	computeFaces(triangles);
+	computeAdjacency(triangles);
+
+	mass = volume;
+	inv_mass = 1.0f/mass;
+
+	int count = triangles.size()/3;
+	resizeTriangleList(count);
+
+	CVector<2,float> t00(0, 0);
+	CVector<2,float> t10(1, 0);
+	CVector<2,float> t01(0, 1);
+
+	for (int i = 0; i < count; i++)
+		setTriangleDataVT(i,
+				hull_vertices[triangles[i*3+0]],
+				hull_vertices[triangles[i*3+1]],
+				hull_vertices[triangles[i*3+2]],
+				t00, t10, t01
+			);
+
+	setTexcoordsValid(true);
+
+	computeTriangleFlatNormals();
+	setNormalsValid(true);
+
+	setupBoundingSphereRadius();
+}
+
+
+/**
+ * set the mass
+ */
+void cObjectFactoryConvexHull::setMass(
+		float p_mass
+	)
+{
+	// a degenerated hull stays static
+	if (hull_vertices.empty())
+		return;
+
+	mass = p_mass;
+	inv_mass = 1.0f/p_mass;
+}
@@ -34,6 +34,35 @@ float cObjectFactoryPlane::getInverseMass()
 	return inv_mass;
 }
 
+/**
+ * the plane is aligned along the x and z axis
+ */
+CVector<3,float> cObjectFactoryPlane::getSupportPoint(const CVector<3,float> &p_direction) const
+{
+	return CVector<3,float>(
+			p_direction.data[0] < 0 ? -size_x*0.5f : size_x*0.5f,
+			0,
+			p_direction.data[2] < 0 ? -size_z*0.5f : size_z*0.5f
+		);
+}
+
+int cObjectFactoryPlane::getSupportFace(const CVector<3,float> &p_direction, CVector<3,float> *o_vertices, CVector<3,float> &o_normal) const
+{
+	float sign = (p_direction.data[1] < 0 ? -1.0f : 1.0f);
+
+	// z x x is the y axis
+	CVector<3,float> u(0, 0, size_z*0.5f);
+	CVector<3,float> v(size_x*0.5f*sign, 0, 0);
+
+	o_normal = CVector<3,float>(0, sign, 0);
+
+	o_vertices[0] = u + v;
+	o_vertices[1] = -u + v;
+	o_vertices[2] = -u - v;
+	o_vertices[3] = u - v;
+	return 4;
+}
+
 void cObjectFactoryPlane::setInverseMass(float p_inv_mass)
 {
 	inv_mass = p_inv_mass;
@@ -31,6 +31,15 @@ float cObjectFactorySphere::getInverseMass()
 	return inv_mass;
 }
 
+CVector<3,float> cObjectFactorySphere::getSupportPoint(const CVector<3,float> &p_direction) const
+{
+	float length = p_direction.getLength();
+	if (length == 0)
+		return CVector<3,float>(radius, 0, 0);
+
+	return p_direction*(radius/length);
+}
+
 
 cObjectFactorySphere::cObjectFactorySphere(
 		float p_radius,
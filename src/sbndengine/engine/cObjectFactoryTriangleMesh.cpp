@@ -0,0 +1,288 @@
+/*
+ * Copyright 2010 Martin Schreiber
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "sbndengine/engine/cObjectFactoryTriangleMesh.hpp"
+#include <string.h>
+
+
+typedef CVector<3,float> Vector;
+
+
+/**
+ * half of the surface area of a box
+ */
+static inline float halfArea(const Vector &p_min, const Vector &p_max)
+{
+	Vector d = p_max - p_min;
+	return d.data[0]*d.data[1] + d.data[1]*d.data[2] + d.data[2]*d.data[0];
+}
+
+
+/**
+ * bin of the surface area heuristic
+ */
+class cTriangleMeshBin
+{
+public:
+	Vector min;
+	Vector max;
+	int count;
+
+	void clear()
+	{
+		min = Vector(CMath<float>::inf(), CMath<float>::inf(), CMath<float>::inf());
+		max = -min;
+		count = 0;
+	}
+
+	void extend(const Vector &p_min, const Vector &p_max)
+	{
+		for (int i = 0; i < 3; i++)
+		{
+			if (p_min.data[i] < min.data[i])	min.data[i] = p_min.data[i];
+			if (p_max.data[i] > max.data[i])	max.data[i] = p_max.data[i];
+		}
+	}
+};
+
+
+CMatrix3<float> cObjectFactoryTriangleMesh::getRotationalInertia()
+{
+	CMatrix3<float> m;
+	m.setZero();
+	return m;
+}
+
+float cObjectFactoryTriangleMesh::getInverseMass()
+{
+	return 0.0f;
+}
+
+
+/**
+ * split the triangles [p_first, p_first+p_count) of triangle_indices at the
+ * bin border with the lowest cost estimated by the surface area heuristic:
+ *
+ * cost = 1 + (area(left)*count(left) + area(right)*count(right)) / area(node)
+ *
+ * the node becomes a leaf if the cost is not lower than the number of its
+ * triangles.
+ */
+void cObjectFactoryTriangleMesh::buildNode(
+		int p_node,
+		int p_first,
+		int p_count,
+		int p_depth,
+		const std::vector<CVector<3,float> > &p_centers
+	)
+{
+	cTriangleMeshBin bounds, center_bounds;
+	bounds.clear();
+	center_bounds.clear();
+
+	for (int i = p_first; i < p_first+p_count; i++)
+	{
+		int t = triangle_indices[i];
+		for (int k = 0; k < 3; k++)
+		{
+			Vector v = getTriangleVertex(t, k);
+			bounds.extend(v, v);
+		}
+		center_bounds.extend(p_centers[t], p_centers[t]);
+	}
+
+	nodes[p_node].min = bounds.min;
+	nodes[p_node].max = bounds.max;
+	nodes[p_node].first = p_first;
+	nodes[p_node].count = p_count;
+
+	if (p_count <= TRIANGLE_MESH_MAX_LEAF_TRIANGLES || p_depth >= TRIANGLE_MESH_MAX_DEPTH-1)
+		return;
+
+	float area = halfArea(bounds.min, bounds.max);
+
+	int best_axis = -1;
+	int best_split = 0;
+	float best_cost = (float)p_count;
+
+	for (int axis = 0; axis < 3; axis++)
+	{
+		float center_min = center_bounds.min.data[axis];
+		float extent = center_bounds.max.data[axis] - center_min;
+		if (extent <= 0)
+			continue;
+
+		float scale = (float)TRIANGLE_MESH_SAH_BINS / extent;
+
+		cTriangleMeshBin bins[TRIANGLE_MESH_SAH_BINS];
+		for (int b = 0; b < TRIANGLE_MESH_SAH_BINS; b++)
+			bins[b].clear();
+
+		for (int i = p_first; i < p_first+p_count; i++)
+		{
+			int t = triangle_indices[i];
+			int b = (int)((p_centers[t].data[axis] - center_min)*scale);
+			if (b >= TRIANGLE_MESH_SAH_BINS)
+				b = TRIANGLE_MESH_SAH_BINS-1;
+
+			for (int k = 0; k < 3; k++)
+			{
+				Vector v = getTriangleVertex(t, k);
+				bins[b].extend(v, v);
+			}
+			bins[b].count++;
+		}
+
+		// area and number of triangles left of the split b (between bin b-1 and b)
+		float left_areas[TRIANGLE_MESH_SAH_BINS];
+		int left_counts[TRIANGLE_MESH_SAH_BINS];
+
+		cTriangleMeshBin left;
+		left.clear();
+		for (int b = 1; b < TRIANGLE_MESH_SAH_BINS; b++)
+		{
+			if (bins[b-1].count > 0)
+				left.extend(bins[b-1].min, bins[b-1].max);
+			left.count += bins[b-1].count;
+
+			left_areas[b] = (left.count > 0 ? halfArea(left.min, left.max) : 0);
+			left_counts[b] = left.count;
+		}
+
+		cTriangleMeshBin right;
+		right.clear();
+		for (int b = TRIANGLE_MESH_SAH_BINS-1; b > 0; b--)
+		{
+			if (bins[b].count > 0)
+				right.extend(bins[b].min, bins[b].max);
+			right.count += bins[b].count;
+
+			if (left_counts[b] == 0 || right.count == 0)
+				continue;
+
+			float cost = 1.0f + (left_areas[b]*(float)left_counts[b] + halfArea(right.min, right.max)*(float)right.count) / area;
+			if (cost < best_cost)
+			{
+				best_cost = cost;
+				best_axis = axis;
+				best_split = b;
+			}
+		}
+	}
+
+	if (best_axis < 0)
+		return;
+
+	/*
+	 * move the triangles of the left bins to the front
+	 */
+	float center_min = center_bounds.min.data[best_axis];
+	float scale = (float)TRIANGLE_MESH_SAH_BINS / (center_bounds.max.data[best_axis] - center_min);
+
+	int middle = p_first;
+	for (int i = p_first; i < p_first+p_count; i++)
+	{
+		int t = triangle_indices[i];
+		int b = (int)((p_centers[t].data[best_axis] - center_min)*scale);
+		if (b >= TRIANGLE_MESH_SAH_BINS)
+			b = TRIANGLE_MESH_SAH_BINS-1;
+
+		if (b < best_split)
+		{
+			triangle_indices[i] = triangle_indices[middle];
+			triangle_indices[middle] = t;
+			middle++;
+		}
+	}
+
+	int child = nodes.size();
+	nodes.resize(child+2);
+
+	nodes[p_node].first = child;
+	nodes[p_node].count = 0;
+
+	buildNode(child, p_first, middle-p_first, p_depth+1, p_centers);
+	buildNode(child+1, middle, p_first+p_count-middle, p_depth+1, p_centers);
+}
+
+
+void cObjectFactoryTriangleMesh::buildHierarchy()
+{
+	nodes.clear();
+	triangle_indices.resize(triangles_count);
+	triangle_normals.resize(triangles_count);
+
+	if (triangles_count == 0)
+		return;
+
+	std::vector<Vector> centers(triangles_count);
+
+	for (int t = 0; t < triangles_count; t++)
+	{
+		Vector v0 = getTriangleVertex(t, 0);
+		Vector v1 = getTriangleVertex(t, 1);
+		Vector v2 = getTriangleVertex(t, 2);
+
+		centers[t] = (v0 + v1 + v2)*(1.0f/3.0f);
+
+		// degenerated triangles get a zero normal and never collide
+		Vector normal = (v1 - v0) % (v2 - v0);
+		float length = normal.getLength();
+		triangle_normals[t] = (length > 0 ? normal*(1.0f/length) : Vector(0,0,0));
+
+		triangle_indices[t] = t;
+	}
+
+	nodes.reserve(2*triangles_count);
+	nodes.resize(1);
+	buildNode(0, 0, triangles_count, 0, centers);
+}
+
+
+cObjectFactoryTriangleMesh::cObjectFactoryTriangleMesh(
+		const iObjectFactory &p_factory
+	)
+{
+	resizeTriangleMesh(p_factory);
+
+	type = TYPE_MESH;
+	original_factory_ptr = this;
+}
+
+
+void cObjectFactoryTriangleMesh::resizeTriangleMesh(
+		const iObjectFactory &p_factory
+	)
+{
+	resizeTriangleList(p_factory.triangles_count);
+
+	memcpy(vertices, p_factory.vertices, sizeof(float)*triangles_count*3*3);
+	memcpy(texCoords, p_factory.texCoords, sizeof(float)*triangles_count*3*2);
+	setTexcoordsValid(p_factory.texcoords_valid);
+
+	if (p_factory.normals_valid)
+		memcpy(normals, p_factory.normals, sizeof(float)*triangles_count*3*3);
+	else
+		computeTriangleFlatNormals();
+	setNormalsValid(true);
+
+	mass = CMath<float>::inf();
+	inv_mass = 0;
+
+	setupBoundingSphereRadius();
+
+	buildHierarchy();
+}
@@ -0,0 +1,98 @@
+/*
+ * Copyright 2010 Martin Schreiber
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "sbndengine/engine/cObjectStore.hpp"
+#include <stddef.h>
+#include <stdlib.h>
+#include <assert.h>
+#include <iostream>
+
+
+cObjectStore::cObjectStore()	:
+		chunks_count(0)
+{
+	// the arrays of vectors are also used as plain float arrays
+	assert(sizeof(CVector<3,float>) == 3*sizeof(float));
+}
+
+
+cObjectStore &cObjectStore::getInstance()
+{
+	/*
+	 * the store is never deleted since objects referenced by global variables
+	 * may be destroyed after any static store
+	 */
+	static cObjectStore *store = new cObjectStore;
+	return *store;
+}
+
+
+int cObjectStore::allocate(iObject *p_object)
+{
+	if (free_handles.empty())
+	{
+		if (chunks_count == OBJECT_STORE_MAX_CHUNKS)
+		{
+			std::cerr << "ERROR: object store full (" << OBJECT_STORE_MAX_CHUNKS*OBJECT_STORE_CHUNK_SIZE << " objects)" << std::endl;
+			abort();
+		}
+
+		int first_handle = chunks_count << OBJECT_STORE_CHUNK_SHIFT;
+		chunks[chunks_count] = new cChunk;
+		chunks_count++;
+
+		// use the slots with the lowest handles first
+		for (int i = OBJECT_STORE_CHUNK_SIZE-1; i >= 0; i--)
+			free_handles.push_back(first_handle + i);
+	}
+
+	int handle = free_handles.back();
+	free_handles.pop_back();
+
+	cChunk &c = getChunk(handle);
+	int i = getIndex(handle);
+
+	c.objects[i] = p_object;
+
+	c.position[i] = CVector<3,float>();
+	c.rotation[i] = CQuaternion<float>();
+	c.model_matrix[i] = CMatrix4<float>();
+	c.inverse_model_matrix[i] = CMatrix4<float>();
+	c.render_model_matrix[i] = CMatrix4<float>();
+
+	c.velocity[i] = CVector<3,float>();
+	c.angular_velocity[i] = CVector<3,float>();
+	c.linear_acceleration_accumulator[i] = CVector<3,float>();
+	c.torque_accumulator[i] = CVector<3,float>();
+	c.inv_mass[i] = 0;
+	c.rotational_inverse_inertia[i] = CMatrix3<float>();
+	c.movable[i] = false;
+	c.sleeping[i] = false;
+	c.continuous_collision_detection[i] = false;
+	c.previous_position[i] = CVector<3,float>();
+	c.previous_rotation[i] = CQuaternion<float>();
+
+	return handle;
+}
+
+
+void cObjectStore::release(int p_handle)
+{
+	assert(getChunk(p_handle).objects[getIndex(p_handle)] != NULL);
+
+	getChunk(p_handle).objects[getIndex(p_handle)] = NULL;
+	free_handles.push_back(p_handle);
+}
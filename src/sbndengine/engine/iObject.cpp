@@ -15,24 +15,44 @@
  */
 
 #include "sbndengine/engine/iObject.hpp"
+#include "sbndengine/engine/cObjectStore.hpp"
 #include "libmath/CGlSlMath.hpp"
 #include <string.h>
 
+
+/**
+ * value of the given array for this object in the object store
+ */
+#define OBJECT_STORE_SLOT(array)	cObjectStore::getInstance().getChunk(store_handle).array[cObjectStore::getIndex(store_handle)]
+
 void iObject::init()
 {
 	model_matrix.loadIdentity();
+	render_model_matrix.loadIdentity();
 	physics_engine_ptr = NULL;
 	graphics_engine_ptr = NULL;
 	intersections_computable = true;
 }
 
 
-iObject::iObject()
+iObject::iObject()	:
+		store_handle(cObjectStore::getInstance().allocate(this)),
+		position(OBJECT_STORE_SLOT(position)),
+		rotation(OBJECT_STORE_SLOT(rotation)),
+		model_matrix(OBJECT_STORE_SLOT(model_matrix)),
+		inverse_model_matrix(OBJECT_STORE_SLOT(inverse_model_matrix)),
+		render_model_matrix(OBJECT_STORE_SLOT(render_model_matrix))
 {
 	init();
 }
 
-iObject::iObject(const std::string &p_identifier_string)
+iObject::iObject(const std::string &p_identifier_string)	:
+		store_handle(cObjectStore::getInstance().allocate(this)),
+		position(OBJECT_STORE_SLOT(position)),
+		rotation(OBJECT_STORE_SLOT(rotation)),
+		model_matrix(OBJECT_STORE_SLOT(model_matrix)),
+		inverse_model_matrix(OBJECT_STORE_SLOT(inverse_model_matrix)),
+		render_model_matrix(OBJECT_STORE_SLOT(render_model_matrix))
 {
 	init();
 	identifier_string = p_identifier_string;
@@ -41,6 +61,7 @@ iObject::iObject(const std::string &p_identifier_string)
 iObject::~iObject()
 {
 //	std::cout << "OBJECT DELETE" << std::endl;
+	cObjectStore::getInstance().release(store_handle);
 }
 
 void iObject::createFromFactory(
@@ -109,10 +130,34 @@ void iObject::setRotation(const CQuaternion<float> &p_rotation)
 }
 
 void iObject::updateModelMatrix()
+{
+	updateModelMatrix(position, rotation, model_matrix, inverse_model_matrix);
+	render_model_matrix = model_matrix;
+
+	// the object was placed by the application: don't interpolate from the old state
+	OBJECT_STORE_SLOT(previous_position) = position;
+	OBJECT_STORE_SLOT(previous_rotation) = rotation;
+}
+
+void iObject::updateModelMatrix(
+		const CVector<3,float> &p_position,
+		const CQuaternion<float> &p_rotation,
+		CMatrix4<float> &o_model_matrix,
+		CMatrix4<float> &o_inverse_model_matrix
+	)
 {
 	// the rotation is applied at first
-	model_matrix = GLSL::translate(position)*rotation.getRotationMatrix();
-	inverse_model_matrix = model_matrix.getInverse();
+	o_model_matrix = GLSL::translate(p_position)*p_rotation.getRotationMatrix();
+	o_inverse_model_matrix = o_model_matrix.getInverse();
+}
+
+void iObject::updateModelMatrix(
+		const CVector<3,float> &p_position,
+		const CQuaternion<float> &p_rotation,
+		CMatrix4<float> &o_model_matrix
+	)
+{
+	o_model_matrix = GLSL::translate(p_position)*p_rotation.getRotationMatrix();
 }
 
 void iObject::setIntersectionsComputable(bool p_computable)
@@ -26,6 +26,9 @@ void iObjectFactory::init()
 
 	normals_valid = false;
 	texcoords_valid = false;
+	geometry_version = 0;
+	graphics_data = NULL;
+	indexed_mesh = NULL;
 
 	bounding_sphere_radius = CMath<float>::inf();
 }
@@ -46,14 +49,73 @@ void iObjectFactory::setupBoundingSphereRadius()
 	bounding_sphere_radius = CMath<float>::sqrt(quad_bounding_sphere_radius);
 }
 
+CVector<3,float> iObjectFactory::getSupportPoint(const CVector<3,float> &p_direction) const
+{
+	const float *v = vertices;
+	const float *max_v = vertices;
+	float max_dot = -CMath<float>::inf();
+
+	for (int i = 0; i < triangles_count*3; i++)
+	{
+		float dot = v[0]*p_direction.data[0] + v[1]*p_direction.data[1] + v[2]*p_direction.data[2];
+		if (dot > max_dot)
+		{
+			max_dot = dot;
+			max_v = v;
+		}
+		v+=3;
+	}
+
+	if (max_v == NULL)
+		return CVector<3,float>(0,0,0);
+
+	return CVector<3,float>(max_v[0], max_v[1], max_v[2]);
+}
+
+int iObjectFactory::getSupportFace(const CVector<3,float> &p_direction, CVector<3,float> *o_vertices, CVector<3,float> &o_normal) const
+{
+	o_vertices[0] = getSupportPoint(p_direction);
+	o_normal = p_direction.getNormalized();
+	return 1;
+}
+
 void iObjectFactory::setNormalsValid(bool valid)
 {
 	normals_valid = valid;
+	setGeometryChanged();
 }
 
 void iObjectFactory::setTexcoordsValid(bool valid)
 {
 	texcoords_valid = valid;
+	setGeometryChanged();
+}
+
+void iObjectFactory::setGeometryChanged()
+{
+	geometry_version++;
+}
+
+const cIndexedMesh &iObjectFactory::getIndexedMesh()
+{
+	if (indexed_mesh == NULL)
+	{
+		indexed_mesh = new cIndexedMesh;
+	}
+	else if (indexed_mesh->geometry_version == geometry_version)
+	{
+		return *indexed_mesh;
+	}
+
+	indexed_mesh->build(
+			vertices,
+			normals_valid ? normals : NULL,
+			texcoords_valid ? texCoords : NULL,
+			triangles_count
+		);
+	indexed_mesh->geometry_version = geometry_version;
+
+	return *indexed_mesh;
 }
 
 iObjectFactory::iObjectFactory()
@@ -73,6 +135,7 @@ void iObjectFactory::resizeTriangleList(size_t size)
 	clear();
 
 	triangles_count = size;
+	setGeometryChanged();
 
 	vertices = new float[size*3*3];
 	normals = new float[size*3*3];
@@ -198,9 +261,13 @@ void iObjectFactory::computeTriangleFlatNormals()
 		normals[idx+7] = normal[1];
 		normals[idx+8] = normal[2];
 	}
+
+	setGeometryChanged();
 }
 
 iObjectFactory::~iObjectFactory()
 {
 	clear();
+	delete graphics_data;
+	delete indexed_mesh;
 }
@@ -70,14 +70,21 @@ void iObjectRayIntersection::computeRayIntersection(iObject &object)
 
 	iObjectFactory &fac = object.objectFactory.getClass();
 
-	float *v = fac.vertices;
+	const cIndexedMesh &mesh = fac.getIndexedMesh();
+	if (mesh.indices.empty())
+		return;
 
-	for (int triangle_nr = 0; triangle_nr < fac.triangles_count; triangle_nr++)
-	{
-		CVector<3,float> v0(v);	v+=3;
-		CVector<3,float> v1(v);	v+=3;
+	const float *mesh_vertices = &mesh.vertices[0];
+	const unsigned int *index = &mesh.indices[0];
 
-		CVector<3,float> v2(v);	v+=3;
+	int triangles_count = mesh.getTrianglesCount();
+
+	for (int triangle_nr = 0; triangle_nr < triangles_count; triangle_nr++)
+	{
+		CVector<3,float> v0(mesh_vertices + index[0]*3);
+		CVector<3,float> v1(mesh_vertices + index[1]*3);
+		CVector<3,float> v2(mesh_vertices + index[2]*3);
+		index += 3;
 
 		CVector<3,float> e1 = v1 - v0;
 		CVector<3,float> e2 = v2 - v0;
@@ -0,0 +1,292 @@
+/*
+ * Copyright 2010 Martin Schreiber
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "sbndengine/graphics/cGraphicsBVH.hpp"
+#include <algorithm>
+
+
+/**
+ * center of the bounding sphere in world space
+ */
+static inline CVector<3,float> getCenter(const iGraphicsObject *p_object)
+{
+	const CMatrix4<float> &m = p_object->object->render_model_matrix;
+	return CVector<3,float>(m.matrix[0][3], m.matrix[1][3], m.matrix[2][3]);
+}
+
+static inline float getRadius(const iGraphicsObject *p_object)
+{
+	return p_object->object->objectFactory->bounding_sphere_radius;
+}
+
+static inline float halfArea(const CVector<3,float> &p_min, const CVector<3,float> &p_max)
+{
+	CVector<3,float> d = p_max - p_min;
+	return d.data[0]*d.data[1] + d.data[1]*d.data[2] + d.data[2]*d.data[0];
+}
+
+
+/**
+ * order of the objects along an axis to split them at the median
+ */
+class cGraphicsBVHCenterLess
+{
+	int axis;
+
+public:
+	cGraphicsBVHCenterLess(int p_axis)	:
+		axis(p_axis)
+	{
+	}
+
+	bool operator()(const iGraphicsObject *a, const iGraphicsObject *b) const
+	{
+		return getCenter(a).data[axis] < getCenter(b).data[axis];
+	}
+};
+
+
+cGraphicsBVH::cGraphicsBVH()	:
+	build_area(0),
+	objects_changed(true)
+{
+}
+
+
+void cGraphicsBVH::setObjectsChanged()
+{
+	objects_changed = true;
+}
+
+
+void cGraphicsBVH::updateCenters()
+{
+	centers.resize(objects.size());
+
+	for (size_t i = 0; i < objects.size(); i++)
+		centers[i] = getCenter(objects[i]);
+}
+
+
+void cGraphicsBVH::setupLeafBounds(cNode &p_node)
+{
+	p_node.min = CVector<3,float>(CMath<float>::inf());
+	p_node.max = CVector<3,float>(-CMath<float>::inf());
+
+	for (int i = p_node.first; i < p_node.first+p_node.count; i++)
+	{
+		float r = getRadius(objects[i]);
+		const CVector<3,float> &c = centers[i];
+
+		for (int axis = 0; axis < 3; axis++)
+		{
+			p_node.min.data[axis] = CMath<float>::min(p_node.min.data[axis], c.data[axis] - r);
+			p_node.max.data[axis] = CMath<float>::max(p_node.max.data[axis], c.data[axis] + r);
+		}
+	}
+}
+
+
+void cGraphicsBVH::buildNode(int p_node, int p_first, int p_count, int p_depth)
+{
+	nodes[p_node].first = p_first;
+	nodes[p_node].count = p_count;
+	setupLeafBounds(nodes[p_node]);
+
+	if (p_count <= GRAPHICS_BVH_MAX_LEAF_OBJECTS || p_depth >= GRAPHICS_BVH_MAX_DEPTH-1)
+		return;
+
+	// split at the median of the longest axis of the centers
+	CVector<3,float> center_min(CMath<float>::inf());
+	CVector<3,float> center_max(-CMath<float>::inf());
+
+	for (int i = p_first; i < p_first+p_count; i++)
+	{
+		for (int axis = 0; axis < 3; axis++)
+		{
+			center_min.data[axis] = CMath<float>::min(center_min.data[axis], centers[i].data[axis]);
+			center_max.data[axis] = CMath<float>::max(center_max.data[axis], centers[i].data[axis]);
+		}
+	}
+
+	CVector<3,float> extent = center_max - center_min;
+	int axis = 0;
+	if (extent.data[1] > extent.data[axis])	axis = 1;
+	if (extent.data[2] > extent.data[axis])	axis = 2;
+
+	int middle = p_first + p_count/2;
+
+	std::nth_element(
+			objects.begin()+p_first,
+			objects.begin()+middle,
+			objects.begin()+p_first+p_count,
+			cGraphicsBVHCenterLess(axis)
+		);
+
+	for (int i = p_first; i < p_first+p_count; i++)
+		centers[i] = getCenter(objects[i]);
+
+	int child = nodes.size();
+	nodes.resize(child+2);
+
+	nodes[p_node].first = child;
+	nodes[p_node].count = 0;
+
+	buildNode(child, p_first, middle-p_first, p_depth+1);
+	buildNode(child+1, middle, p_first+p_count-middle, p_depth+1);
+}
+
+
+void cGraphicsBVH::build(const std::list<iRef<iGraphicsObject> > &p_object_list)
+{
+	objects.clear();
+	unbounded_objects.clear();
+
+	for (std::list<iRef<iGraphicsObject> >::const_iterator i = p_object_list.begin(); i != p_object_list.end(); i++)
+	{
+		iGraphicsObject *go = &(*i).getClass();
+
+		if (getRadius(go) < CMath<float>::inf())
+			objects.push_back(go);
+		else
+			unbounded_objects.push_back(go);
+	}
+
+	updateCenters();
+
+	nodes.clear();
+	build_area = 0;
+	objects_changed = false;
+
+	if (objects.empty())
+		return;
+
+	nodes.reserve(2*objects.size());
+	nodes.resize(1);
+	buildNode(0, 0, objects.size(), 0);
+
+	for (size_t n = 0; n < nodes.size(); n++)
+		build_area += halfArea(nodes[n].min, nodes[n].max);
+}
+
+
+/**
+ * update the boxes bottom up (the children are stored behind their parent)
+ * and return their surface area
+ */
+float cGraphicsBVH::refit()
+{
+	updateCenters();
+
+	float area = 0;
+
+	for (int n = (int)nodes.size()-1; n >= 0; n--)
+	{
+		cNode &node = nodes[n];
+
+		if (node.count > 0)
+		{
+			setupLeafBounds(node);
+		}
+		else
+		{
+			const cNode &a = nodes[node.first];
+			const cNode &b = nodes[node.first+1];
+
+			for (int axis = 0; axis < 3; axis++)
+			{
+				node.min.data[axis] = CMath<float>::min(a.min.data[axis], b.min.data[axis]);
+				node.max.data[axis] = CMath<float>::max(a.max.data[axis], b.max.data[axis]);
+			}
+		}
+
+		area += halfArea(node.min, node.max);
+	}
+
+	return area;
+}
+
+
+void cGraphicsBVH::update(const std::list<iRef<iGraphicsObject> > &p_object_list)
+{
+	if (objects_changed)
+	{
+		build(p_object_list);
+		return;
+	}
+
+	if (refit() > build_area*GRAPHICS_BVH_REBUILD_AREA_FACTOR)
+		build(p_object_list);
+}
+
+
+void cGraphicsBVH::findVisibleObjects(
+		const cFrustum &p_frustum,
+		std::vector<iGraphicsObject*> &o_objects
+	)	const
+{
+	o_objects.clear();
+
+	for (size_t i = 0; i < unbounded_objects.size(); i++)
+		if (unbounded_objects[i]->visible)
+			o_objects.push_back(unbounded_objects[i]);
+
+	if (nodes.empty())
+		return;
+
+	// node and flag if the node is completely inside of the frustum
+	int stack[GRAPHICS_BVH_MAX_DEPTH+1];
+	bool stack_inside[GRAPHICS_BVH_MAX_DEPTH+1];
+	int stack_size = 1;
+	stack[0] = 0;
+	stack_inside[0] = false;
+
+	while (stack_size > 0)
+	{
+		stack_size--;
+		const cNode &node = nodes[stack[stack_size]];
+		bool inside = stack_inside[stack_size];
+
+		if (!inside)
+		{
+			int result = p_frustum.testBox(node.min, node.max);
+			if (result == cFrustum::OUTSIDE)
+				continue;
+
+			inside = (result == cFrustum::INSIDE);
+		}
+
+		if (node.count == 0)
+		{
+			stack[stack_size] = node.first;
+			stack_inside[stack_size] = inside;
+			stack[stack_size+1] = node.first+1;
+			stack_inside[stack_size+1] = inside;
+			stack_size += 2;
+			continue;
+		}
+
+		for (int i = node.first; i < node.first+node.count; i++)
+		{
+			iGraphicsObject *go = objects[i];
+			if (!go->visible)
+				continue;
+
+			if (inside || p_frustum.isSphereVisible(centers[i], getRadius(go)))
+				o_objects.push_back(go);
+		}
+	}
+}
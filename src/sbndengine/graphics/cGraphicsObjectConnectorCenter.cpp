@@ -42,6 +42,6 @@ void cGraphicsObjectConnectorCenter::setVisibility(bool p_visibility)
 
 void cGraphicsObjectConnectorCenter::getStartAndEndPoint(CVector<3,float> &start_point, CVector<3,float> &end_point)
 {
-	start_point = object1->position;
-	end_point = object2->position;
+	start_point = object1->render_model_matrix*CVector<3,float>(0,0,0);
+	end_point = object2->render_model_matrix*CVector<3,float>(0,0,0);
 }
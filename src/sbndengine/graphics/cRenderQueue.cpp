@@ -0,0 +1,140 @@
+/*
+ * Copyright 2010 Martin Schreiber
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "sbndengine/graphics/cRenderQueue.hpp"
+#include <algorithm>
+
+
+/**
+ * return the number of the material, texture or factory in the current
+ * frame, 0 is used for NULL
+ */
+unsigned int cRenderQueue::getId(std::map<const void*, unsigned int> &p_ids, const void *p_pointer)
+{
+	if (p_pointer == NULL)
+		return 0;
+
+	std::map<const void*, unsigned int>::iterator i = p_ids.find(p_pointer);
+	if (i != p_ids.end())
+		return i->second;
+
+	unsigned int id = p_ids.size()+1;
+	p_ids[p_pointer] = id;
+	return id;
+}
+
+
+static inline const void *getMaterial(const iGraphicsObject &p_object)
+{
+	return p_object.material.isNull() ? NULL : &p_object.material.getClass();
+}
+
+
+bool cRenderQueue::isSameGroup(const iGraphicsObject &a, const iGraphicsObject &b)
+{
+	return	&a.object->objectFactory.getClass() == &b.object->objectFactory.getClass() &&
+			getMaterial(a) == getMaterial(b);
+}
+
+
+/**
+ * store p_value in the field of p_bits bits below p_shift
+ */
+static inline unsigned long long getKeyField(unsigned int p_value, int p_bits, int &p_shift)
+{
+	p_shift -= p_bits;
+	return ((unsigned long long)p_value & ((1ull << p_bits) - 1)) << p_shift;
+}
+
+
+void cRenderQueue::build(
+		const std::vector<iGraphicsObject*> &p_objects,
+		const CMatrix4<float> &p_view_matrix
+	)
+{
+	items.clear();
+	texture_ids.clear();
+	material_ids.clear();
+	factory_ids.clear();
+
+	float min_depth = CMath<float>::inf();
+	float max_depth = -CMath<float>::inf();
+
+	for (std::vector<iGraphicsObject*>::const_iterator i = p_objects.begin(); i != p_objects.end(); i++)
+	{
+		iGraphicsObject &go = **i;
+
+		cItem item;
+		item.object = &go;
+
+		// the camera looks along the negative z axis
+		const CMatrix4<float> &m = go.object->render_model_matrix;
+		item.depth = -(p_view_matrix*CVector<3,float>(m.matrix[0][3], m.matrix[1][3], m.matrix[2][3]))[2];
+
+		min_depth = CMath<float>::min(min_depth, item.depth);
+		max_depth = CMath<float>::max(max_depth, item.depth);
+
+		items.push_back(item);
+	}
+
+	float depth_scale = 0;
+	if (max_depth > min_depth)
+		depth_scale = (float)((1 << RENDER_QUEUE_DEPTH_BITS) - 1)/(max_depth - min_depth);
+
+	for (std::vector<cItem>::iterator i = items.begin(); i != items.end(); i++)
+	{
+		iGraphicsObject &go = *i->object;
+
+		/*
+		 * the shader is selected in the same way as by iDraw3D: textures are
+		 * only used if the factory has texture coordinates
+		 */
+		unsigned int shader = 0;
+		const void *texture = NULL;
+		const void *normal_map = NULL;
+
+		if (go.material.isNotNull() && go.material->texture.isNotNull() && go.object->objectFactory->texcoords_valid)
+		{
+			texture = &go.material->texture.getClass();
+
+			if (go.material->normalTexture.isNotNull())
+			{
+				normal_map = &go.material->normalTexture.getClass();
+				shader = 2;
+			}
+			else
+			{
+				shader = 1;
+			}
+		}
+
+		unsigned int depth = (unsigned int)((i->depth - min_depth)*depth_scale);
+
+		int shift = 64;
+		i->key =	getKeyField(shader, RENDER_QUEUE_SHADER_BITS, shift) |
+					getKeyField(getId(texture_ids, texture), RENDER_QUEUE_TEXTURE_BITS, shift) |
+					getKeyField(getId(texture_ids, normal_map), RENDER_QUEUE_NORMAL_MAP_BITS, shift) |
+					getKeyField(getId(material_ids, getMaterial(go)), RENDER_QUEUE_MATERIAL_BITS, shift) |
+					getKeyField(getId(factory_ids, &go.object->objectFactory.getClass()), RENDER_QUEUE_FACTORY_BITS, shift) |
+					getKeyField(depth, RENDER_QUEUE_DEPTH_BITS, shift);
+	}
+
+	std::sort(items.begin(), items.end());
+
+	objects.resize(items.size());
+	for (size_t i = 0; i < items.size(); i++)
+		objects[i] = items[i].object;
+}
@@ -21,6 +21,7 @@ void iGraphics::clear()
 {
 	objectList.clear();
 	objectConnectorList.clear();
+	objectHierarchy.setObjectsChanged();
 }
 
 
@@ -28,6 +29,7 @@ void iGraphics::clear()
 void iGraphics::addObject(const iRef<iGraphicsObject> &p_graphics_object)
 {
 	objectList.push_back(p_graphics_object);
+	objectHierarchy.setObjectsChanged();
 }
 
 void iGraphics::addObjectConnector(const iRef<iGraphicsObjectConnector> &p_graphics_object_connector)
@@ -41,13 +43,30 @@ void iGraphics::drawFrame(iCamera &p_camera)
 	setupCamera(p_camera);
 	setupLight();
 
-	for (std::list<iRef<iGraphicsObject> >::iterator i = objectList.begin(); i != objectList.end(); i++)
+	// only the objects inside of the view frustum are drawn
+	objectHierarchy.update(objectList);
+	objectHierarchy.findVisibleObjects(cFrustum(p_camera.projection_matrix*p_camera.view_matrix), visibleObjects);
+
+	renderQueue.build(visibleObjects, p_camera.view_matrix);
+
+	// the render state is tracked from here on to apply only its changes
+	resetRenderState();
+
+	// one draw call for each group of objects with the same factory and material
+	std::vector<iGraphicsObject*> &objects = renderQueue.objects;
+
+	for (size_t first = 0; first < objects.size();)
 	{
-		iGraphicsObject &go = **i;
-		if (go.visible)
-			drawObject(*go.object, *go.material);
+		size_t end = first+1;
+		while (end < objects.size() && cRenderQueue::isSameGroup(*objects[first], *objects[end]))
+			end++;
+
+		drawObjectInstances(&objects[first], end - first);
+		first = end;
 	}
 
+	resetRenderState();
+
 	for (std::list<iRef<iGraphicsObjectConnector> >::iterator i = objectConnectorList.begin(); i != objectConnectorList.end(); i++)
 	{
 		iGraphicsObjectConnector &goc = **i;
@@ -47,6 +47,6 @@ void cGraphicsObjectConnectorAngular::setVisibility(bool p_visibility)
 
 void cGraphicsObjectConnectorAngular::getStartAndEndPoint(CVector<3,float> &start_point, CVector<3,float> &end_point)
 {
-	start_point = object1->position + object1->model_matrix.getInverseTranspose3x3()*object_point1;
-	end_point = object2->position + object2->model_matrix.getInverseTranspose3x3()*object_point2;
+	start_point = object1->render_model_matrix*object_point1;
+	end_point = object2->render_model_matrix*object_point2;
 }
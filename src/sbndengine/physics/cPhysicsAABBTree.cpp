@@ -0,0 +1,427 @@
+/*
+ * Copyright 2010 Martin Schreiber
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include "cPhysicsAABBTree.hpp"
+#include "libmath/CMath.hpp"
+
+
+/**
+ * the box coordinates are clamped to this range to compute the insertion
+ * costs. otherwise the infinite boxes of planes lead to inf - inf = NaN and
+ * all cost comparisons fail.
+ */
+#define AABB_TREE_MAX_COST_EXTENT	1.0e5f
+
+
+static inline float clampExtent(float p_value)
+{
+	return CMath<float>::max(-AABB_TREE_MAX_COST_EXTENT, CMath<float>::min(p_value, AABB_TREE_MAX_COST_EXTENT));
+}
+
+
+/**
+ * sum of the edge lengths of a box.
+ *
+ * this is used instead of the surface area since it does not vanish for
+ * boxes with an edge length of 0 (e. g. planes).
+ */
+static inline float perimeter(const CVector<3,float> &min, const CVector<3,float> &max)
+{
+	float p = 0;
+	for (int a = 0; a < 3; a++)
+		p += clampExtent(max.data[a]) - clampExtent(min.data[a]);
+	return p;
+}
+
+
+static inline float unionPerimeter(
+		const CVector<3,float> &min1, const CVector<3,float> &max1,
+		const CVector<3,float> &min2, const CVector<3,float> &max2
+	)
+{
+	float p = 0;
+	for (int a = 0; a < 3; a++)
+		p += clampExtent(CMath<float>::max(max1.data[a], max2.data[a])) - clampExtent(CMath<float>::min(min1.data[a], min2.data[a]));
+	return p;
+}
+
+
+cPhysicsAABBTree::cPhysicsAABBTree()	:
+		root(AABB_TREE_NULL_NODE),
+		free_list(AABB_TREE_NULL_NODE)
+{
+}
+
+
+void cPhysicsAABBTree::clear()
+{
+	nodes.clear();
+	root = AABB_TREE_NULL_NODE;
+	free_list = AABB_TREE_NULL_NODE;
+}
+
+
+int cPhysicsAABBTree::allocateNode()
+{
+	int node;
+
+	if (free_list != AABB_TREE_NULL_NODE)
+	{
+		node = free_list;
+		free_list = nodes[node].parent;
+	}
+	else
+	{
+		node = nodes.size();
+		nodes.push_back(cNode());
+	}
+
+	cNode &n = nodes[node];
+	n.parent = AABB_TREE_NULL_NODE;
+	n.child1 = AABB_TREE_NULL_NODE;
+	n.child2 = AABB_TREE_NULL_NODE;
+	n.height = 0;
+	n.user_data = NULL;
+	return node;
+}
+
+
+void cPhysicsAABBTree::freeNode(int node)
+{
+	nodes[node].parent = free_list;
+	nodes[node].height = -1;
+	free_list = node;
+}
+
+
+/**
+ * recompute the box and the height of an inner node from its children
+ */
+inline void cPhysicsAABBTree::updateNode(int node)
+{
+	cNode &n = nodes[node];
+	cNode &c1 = nodes[n.child1];
+	cNode &c2 = nodes[n.child2];
+
+	for (int a = 0; a < 3; a++)
+	{
+		n.min[a] = CMath<float>::min(c1.min[a], c2.min[a]);
+		n.max[a] = CMath<float>::max(c1.max[a], c2.max[a]);
+	}
+	n.height = 1 + CMath<int>::max(c1.height, c2.height);
+}
+
+
+int cPhysicsAABBTree::createProxy(
+		const CVector<3,float> &p_min,
+		const CVector<3,float> &p_max,
+		void *p_user_data
+	)
+{
+	int proxy = allocateNode();
+
+	nodes[proxy].min = p_min;
+	nodes[proxy].max = p_max;
+	nodes[proxy].user_data = p_user_data;
+
+	insertLeaf(proxy);
+	return proxy;
+}
+
+
+void cPhysicsAABBTree::destroyProxy(int proxy)
+{
+	removeLeaf(proxy);
+	freeNode(proxy);
+}
+
+
+void cPhysicsAABBTree::moveProxy(
+		int proxy,
+		const CVector<3,float> &p_min,
+		const CVector<3,float> &p_max
+	)
+{
+	removeLeaf(proxy);
+
+	nodes[proxy].min = p_min;
+	nodes[proxy].max = p_max;
+
+	insertLeaf(proxy);
+}
+
+
+void cPhysicsAABBTree::insertLeaf(int leaf)
+{
+	if (root == AABB_TREE_NULL_NODE)
+	{
+		root = leaf;
+		nodes[root].parent = AABB_TREE_NULL_NODE;
+		return;
+	}
+
+	CVector<3,float> leaf_min = nodes[leaf].min;
+	CVector<3,float> leaf_max = nodes[leaf].max;
+
+	/*
+	 * search the sibling which leads to the smallest increase of the perimeters
+	 */
+	int index = root;
+	while (!nodes[index].isLeaf())
+	{
+		cNode &n = nodes[index];
+		int child1 = n.child1;
+		int child2 = n.child2;
+
+		float area = perimeter(n.min, n.max);
+		float combined_area = unionPerimeter(n.min, n.max, leaf_min, leaf_max);
+
+		// cost of creating a new parent for this node and the new leaf
+		float cost = 2.0f*combined_area;
+
+		// minimum cost of pushing the leaf further down the tree
+		float inheritance_cost = 2.0f*(combined_area - area);
+
+		cNode &c1 = nodes[child1];
+		float cost1 = unionPerimeter(c1.min, c1.max, leaf_min, leaf_max) + inheritance_cost;
+		if (!c1.isLeaf())
+			cost1 -= perimeter(c1.min, c1.max);
+
+		cNode &c2 = nodes[child2];
+		float cost2 = unionPerimeter(c2.min, c2.max, leaf_min, leaf_max) + inheritance_cost;
+		if (!c2.isLeaf())
+			cost2 -= perimeter(c2.min, c2.max);
+
+		if (cost < cost1 && cost < cost2)
+			break;
+
+		index = (cost1 < cost2 ? child1 : child2);
+	}
+
+	int sibling = index;
+
+	/*
+	 * create a new parent for the sibling and the leaf
+	 */
+	int old_parent = nodes[sibling].parent;
+	int new_parent = allocateNode();
+
+	nodes[new_parent].parent = old_parent;
+	nodes[new_parent].child1 = sibling;
+	nodes[new_parent].child2 = leaf;
+	nodes[sibling].parent = new_parent;
+	nodes[leaf].parent = new_parent;
+
+	if (old_parent != AABB_TREE_NULL_NODE)
+	{
+		if (nodes[old_parent].child1 == sibling)
+			nodes[old_parent].child1 = new_parent;
+		else
+			nodes[old_parent].child2 = new_parent;
+	}
+	else
+	{
+		root = new_parent;
+	}
+
+	/*
+	 * walk back up the tree to fix the heights and boxes
+	 */
+	index = new_parent;
+	while (index != AABB_TREE_NULL_NODE)
+	{
+		index = balance(index);
+		updateNode(index);
+		index = nodes[index].parent;
+	}
+}
+
+
+void cPhysicsAABBTree::removeLeaf(int leaf)
+{
+	if (leaf == root)
+	{
+		root = AABB_TREE_NULL_NODE;
+		return;
+	}
+
+	int parent = nodes[leaf].parent;
+	int grand_parent = nodes[parent].parent;
+	int sibling = (nodes[parent].child1 == leaf ? nodes[parent].child2 : nodes[parent].child1);
+
+	if (grand_parent == AABB_TREE_NULL_NODE)
+	{
+		root = sibling;
+		nodes[sibling].parent = AABB_TREE_NULL_NODE;
+		freeNode(parent);
+		return;
+	}
+
+	// replace the parent by the sibling
+	if (nodes[grand_parent].child1 == parent)
+		nodes[grand_parent].child1 = sibling;
+	else
+		nodes[grand_parent].child2 = sibling;
+	nodes[sibling].parent = grand_parent;
+	freeNode(parent);
+
+	int index = grand_parent;
+	while (index != AABB_TREE_NULL_NODE)
+	{
+		index = balance(index);
+		updateNode(index);
+		index = nodes[index].parent;
+	}
+}
+
+
+/**
+ * if one subtree of node a is more than one level higher than the other
+ * one, the higher child is rotated up.
+ *
+ * \return	the index of the node which replaced node a
+ */
+int cPhysicsAABBTree::balance(int ia)
+{
+	if (nodes[ia].isLeaf() || nodes[ia].height < 2)
+		return ia;
+
+	int ib = nodes[ia].child1;
+	int ic = nodes[ia].child2;
+
+	int height_difference = nodes[ic].height - nodes[ib].height;
+
+	if (height_difference > 1)
+	{
+		// rotate c up
+		int i_f = nodes[ic].child1;
+		int ig = nodes[ic].child2;
+
+		nodes[ic].child1 = ia;
+		nodes[ic].parent = nodes[ia].parent;
+		nodes[ia].parent = ic;
+
+		int p = nodes[ic].parent;
+		if (p != AABB_TREE_NULL_NODE)
+		{
+			if (nodes[p].child1 == ia)
+				nodes[p].child1 = ic;
+			else
+				nodes[p].child2 = ic;
+		}
+		else
+		{
+			root = ic;
+		}
+
+		// the higher child of c stays at c, the other one is moved to a
+		if (nodes[i_f].height > nodes[ig].height)
+		{
+			nodes[ic].child2 = i_f;
+			nodes[ia].child2 = ig;
+			nodes[ig].parent = ia;
+		}
+		else
+		{
+			nodes[ic].child2 = ig;
+			nodes[ia].child2 = i_f;
+			nodes[i_f].parent = ia;
+		}
+
+		updateNode(ia);
+		updateNode(ic);
+		return ic;
+	}
+
+	if (height_difference < -1)
+	{
+		// rotate b up
+		int id = nodes[ib].child1;
+		int ie = nodes[ib].child2;
+
+		nodes[ib].child1 = ia;
+		nodes[ib].parent = nodes[ia].parent;
+		nodes[ia].parent = ib;
+
+		int p = nodes[ib].parent;
+		if (p != AABB_TREE_NULL_NODE)
+		{
+			if (nodes[p].child1 == ia)
+				nodes[p].child1 = ib;
+			else
+				nodes[p].child2 = ib;
+		}
+		else
+		{
+			root = ib;
+		}
+
+		if (nodes[id].height > nodes[ie].height)
+		{
+			nodes[ib].child2 = id;
+			nodes[ia].child1 = ie;
+			nodes[ie].parent = ia;
+		}
+		else
+		{
+			nodes[ib].child2 = ie;
+			nodes[ia].child1 = id;
+			nodes[id].parent = ia;
+		}
+
+		updateNode(ia);
+		updateNode(ib);
+		return ib;
+	}
+
+	return ia;
+}
+
+
+void cPhysicsAABBTree::query(
+		const CVector<3,float> &p_min,
+		const CVector<3,float> &p_max,
+		std::vector<void*> &o_user_data
+	)
+{
+	if (root == AABB_TREE_NULL_NODE)
+		return;
+
+	stack.clear();
+	stack.push_back(root);
+
+	while (!stack.empty())
+	{
+		const cNode &n = nodes[stack.back()];
+		stack.pop_back();
+
+		if (	p_max.data[0] < n.min.data[0] || n.max.data[0] < p_min.data[0] ||
+				p_max.data[1] < n.min.data[1] || n.max.data[1] < p_min.data[1] ||
+				p_max.data[2] < n.min.data[2] || n.max.data[2] < p_min.data[2]
+		)
+			continue;
+
+		if (n.isLeaf())
+		{
+			o_user_data.push_back(n.user_data);
+			continue;
+		}
+
+		stack.push_back(n.child1);
+		stack.push_back(n.child2);
+	}
+}
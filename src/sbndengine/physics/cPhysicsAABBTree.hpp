@@ -0,0 +1,136 @@
+/*
+ * Copyright 2010 Martin Schreiber
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef CPHYSICS_AABB_TREE_HPP
+#define CPHYSICS_AABB_TREE_HPP
+
+#include <vector>
+#include "libmath/CVector.hpp"
+
+
+/**
+ * index used for non existing nodes
+ */
+#define AABB_TREE_NULL_NODE	(-1)
+
+
+/**
+ * \brief dynamic bounding volume tree of axis aligned bounding boxes
+ *
+ * the leaves store the boxes of the objects, the inner nodes the union of
+ * the boxes of their children. new leaves are inserted next to the sibling
+ * with the smallest increase of the box perimeters and the tree is kept
+ * balanced with tree rotations.
+ *
+ * all nodes are stored in one array and are referenced by their index. thus
+ * no memory is allocated once the array is large enough.
+ */
+class cPhysicsAABBTree
+{
+	class cNode
+	{
+	public:
+		CVector<3,float> min;
+		CVector<3,float> max;
+
+		void *user_data;
+
+		// parent node or next free node if the node is not used
+		int parent;
+
+		int child1, child2;
+
+		// 0 for leaves, -1 for unused nodes
+		int height;
+
+		inline bool isLeaf()	const
+		{
+			return child1 == AABB_TREE_NULL_NODE;
+		}
+	};
+
+	std::vector<cNode> nodes;
+
+	int root;
+	int free_list;
+
+	/**
+	 * stack of nodes to traverse during queries
+	 */
+	std::vector<int> stack;
+
+	int allocateNode();
+	void freeNode(int node);
+
+	void insertLeaf(int leaf);
+	void removeLeaf(int leaf);
+
+	int balance(int node);
+
+	void updateNode(int node);
+
+public:
+	cPhysicsAABBTree();
+
+	/**
+	 * insert a new box and return the index of the leaf
+	 */
+	int createProxy(
+			const CVector<3,float> &p_min,
+			const CVector<3,float> &p_max,
+			void *p_user_data
+		);
+
+	/**
+	 * remove the leaf of a box
+	 */
+	void destroyProxy(int proxy);
+
+	/**
+	 * change the box of a leaf
+	 */
+	void moveProxy(
+			int proxy,
+			const CVector<3,float> &p_min,
+			const CVector<3,float> &p_max
+		);
+
+	inline const CVector<3,float> &getMin(int proxy)	const
+	{
+		return nodes[proxy].min;
+	}
+
+	inline const CVector<3,float> &getMax(int proxy)	const
+	{
+		return nodes[proxy].max;
+	}
+
+	/**
+	 * append the user data of all leaves whose boxes overlap the given box
+	 */
+	void query(
+			const CVector<3,float> &p_min,
+			const CVector<3,float> &p_max,
+			std::vector<void*> &o_user_data
+		);
+
+	/**
+	 * remove all boxes
+	 */
+	void clear();
+};
+
+#endif
@@ -0,0 +1,351 @@
+/*
+ * Copyright 2010 Martin Schreiber
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef CPHYSICS_BOX_BOX_SAT_HPP
+#define CPHYSICS_BOX_BOX_SAT_HPP
+
+#include <math.h>
+#include "libmath/CVector.hpp"
+#include "libmath/CMath.hpp"
+
+#if defined(__SSE2__)
+	#include <emmintrin.h>
+	#define PHYSICS_BOX_BOX_SAT_SSE	1
+#endif
+
+/**
+ * an edge-edge separating axis is only used if its overlap is smaller than
+ * the one of the best face axis by these tolerances. otherwise nearly
+ * parallel boxes would flip between face and edge contacts.
+ */
+#define BOX_EDGE_AXIS_RELATIVE_TOLERANCE	1.05f
+#define BOX_EDGE_AXIS_ABSOLUTE_TOLERANCE	0.005f
+
+/**
+ * edge axes with a smaller length of the cross product are skipped
+ * (the edges are parallel and a face axis separates the boxes as well)
+ */
+#define BOX_EDGE_AXIS_MIN_LENGTH			0.00001f
+
+
+/**
+ * \brief separating axis test for 2 oriented boxes
+ *
+ * the 15 axes are tested with the rotation of box 2 relative to box 1 and the
+ * half sizes (the classical OBB test). no vertex is transformed.
+ *
+ * axes 0-2 are the axes of box 1, 3-5 the axes of box 2 and 6+3*i+j the cross
+ * product of axis i of box 1 and axis j of box 2.
+ *
+ * the kernel is written once for a generic number type. it is instantiated
+ * with float for one pair and with a SSE vector for 4 pairs at once. both
+ * use the same operations in the same order, thus the results are identical.
+ */
+class cPhysicsBoxBoxSAT
+{
+public:
+	/**
+	 * world space description of a box
+	 */
+	class cBox
+	{
+	public:
+		CVector<3,float> position;
+		CVector<3,float> axes[3];
+		CVector<3,float> half_size;
+	};
+
+	class cResult
+	{
+	public:
+		/**
+		 * axis with the smallest (biased) overlap or -1 if the boxes are separated
+		 */
+		int axis;
+
+		/**
+		 * overlap of the boxes along this axis
+		 */
+		float depth;
+	};
+
+private:
+	/*
+	 * scalar operations
+	 */
+	static inline float opAbs(float a)						{	return fabsf(a);	}
+	static inline float opSqrt(float a)						{	return sqrtf(a);	}
+	static inline bool opLess(float a, float b)				{	return a < b;	}
+	static inline bool opLessEqual(float a, float b)		{	return a <= b;	}
+	static inline bool opOr(bool a, bool b)					{	return a || b;	}
+	static inline bool opAll(bool a)						{	return a;	}
+	static inline float opSelect(bool m, float a, float b)	{	return m ? a : b;	}
+
+#if PHYSICS_BOX_BOX_SAT_SSE
+public:
+	/**
+	 * 4 floats processed with SSE
+	 */
+	class cFloat4
+	{
+	public:
+		__m128 v;
+
+		inline cFloat4()	{}
+		inline cFloat4(__m128 p_v)	:	v(p_v)	{}
+		inline cFloat4(float p_f)	:	v(_mm_set1_ps(p_f))	{}
+
+		inline cFloat4 operator+(const cFloat4 &b)	const	{	return _mm_add_ps(v, b.v);	}
+		inline cFloat4 operator-(const cFloat4 &b)	const	{	return _mm_sub_ps(v, b.v);	}
+		inline cFloat4 operator*(const cFloat4 &b)	const	{	return _mm_mul_ps(v, b.v);	}
+		inline cFloat4 operator/(const cFloat4 &b)	const	{	return _mm_div_ps(v, b.v);	}
+	};
+
+private:
+	static inline cFloat4 opAbs(const cFloat4 &a)			{	return _mm_andnot_ps(_mm_set1_ps(-0.0f), a.v);	}
+	static inline cFloat4 opSqrt(const cFloat4 &a)			{	return _mm_sqrt_ps(a.v);	}
+	static inline cFloat4 opLess(const cFloat4 &a, const cFloat4 &b)		{	return _mm_cmplt_ps(a.v, b.v);	}
+	static inline cFloat4 opLessEqual(const cFloat4 &a, const cFloat4 &b)	{	return _mm_cmple_ps(a.v, b.v);	}
+	static inline cFloat4 opOr(const cFloat4 &a, const cFloat4 &b)			{	return _mm_or_ps(a.v, b.v);	}
+	static inline bool opAll(const cFloat4 &a)				{	return _mm_movemask_ps(a.v) == 0xf;	}
+	static inline cFloat4 opSelect(const cFloat4 &m, const cFloat4 &a, const cFloat4 &b)
+	{
+		return _mm_or_ps(_mm_and_ps(m.v, a.v), _mm_andnot_ps(m.v, b.v));
+	}
+#endif
+
+	/**
+	 * take the axis as the new best one if its biased overlap is smaller
+	 */
+	template <typename T, typename M>
+	static inline void updateBestAxis(
+			const T &p_overlap, const T &p_biased_overlap, float p_axis,
+			M &io_separated, T &io_best_biased_overlap, T &io_best_overlap, T &io_best_axis
+	)
+	{
+		io_separated = opOr(io_separated, opLessEqual(p_overlap, T(0.0f)));
+
+		M better = opLess(p_biased_overlap, io_best_biased_overlap);
+		io_best_biased_overlap = opSelect(better, p_biased_overlap, io_best_biased_overlap);
+		io_best_overlap = opSelect(better, p_overlap, io_best_overlap);
+		io_best_axis = opSelect(better, T(p_axis), io_best_axis);
+	}
+
+public:
+	/**
+	 * generic kernel
+	 *
+	 * the vectors are given as arrays of components (pA[0] is the x component
+	 * of the position of box A).
+	 *
+	 * \return	false, if the boxes are separated (for all pairs)
+	 */
+	template <typename T, typename M>
+	static inline bool kernel(
+			const T pA[3], const T A[3][3], const T hA[3],
+			const T pB[3], const T B[3][3], const T hB[3],
+			M &o_separated, T &o_best_overlap, T &o_best_axis
+	)
+	{
+		T t[3];
+		for (int k = 0; k < 3; k++)
+			t[k] = pB[k] - pA[k];
+
+		// rotation of box B in the coordinate system of box A
+		T R[3][3], AbsR[3][3];
+		for (int i = 0; i < 3; i++)
+			for (int j = 0; j < 3; j++)
+			{
+				R[i][j] = A[i][0]*B[j][0] + A[i][1]*B[j][1] + A[i][2]*B[j][2];
+				AbsR[i][j] = opAbs(R[i][j]);
+			}
+
+		T best_biased_overlap = T(CMath<float>::inf());
+		o_best_overlap = T(CMath<float>::inf());
+		o_best_axis = T(-1.0f);
+		o_separated = opLess(T(1.0f), T(0.0f));
+
+		/*
+		 * axes of box A
+		 */
+		for (int i = 0; i < 3; i++)
+		{
+			T ra = hA[i];
+			T rb = hB[0]*AbsR[i][0] + hB[1]*AbsR[i][1] + hB[2]*AbsR[i][2];
+			T d = opAbs(A[i][0]*t[0] + A[i][1]*t[1] + A[i][2]*t[2]);
+
+			T overlap = ra + rb - d;
+			updateBestAxis(overlap, overlap, (float)i, o_separated, best_biased_overlap, o_best_overlap, o_best_axis);
+		}
+
+		if (opAll(o_separated))
+			return false;
+
+		/*
+		 * axes of box B
+		 */
+		for (int j = 0; j < 3; j++)
+		{
+			T ra = hA[0]*AbsR[0][j] + hA[1]*AbsR[1][j] + hA[2]*AbsR[2][j];
+			T rb = hB[j];
+			T d = opAbs(B[j][0]*t[0] + B[j][1]*t[1] + B[j][2]*t[2]);
+
+			T overlap = ra + rb - d;
+			updateBestAxis(overlap, overlap, (float)(3+j), o_separated, best_biased_overlap, o_best_overlap, o_best_axis);
+		}
+
+		if (opAll(o_separated))
+			return false;
+
+		/*
+		 * cross products of the edges. the projections are computed for the
+		 * cross product and divided by its length afterwards.
+		 */
+		for (int i = 0; i < 3; i++)
+		{
+			int i1 = (i+1)%3;
+			int i2 = (i+2)%3;
+
+			for (int j = 0; j < 3; j++)
+			{
+				int j1 = (j+1)%3;
+				int j2 = (j+2)%3;
+
+				T L[3];
+				L[0] = A[i][1]*B[j][2] - A[i][2]*B[j][1];
+				L[1] = A[i][2]*B[j][0] - A[i][0]*B[j][2];
+				L[2] = A[i][0]*B[j][1] - A[i][1]*B[j][0];
+
+				T length = opSqrt(L[0]*L[0] + L[1]*L[1] + L[2]*L[2]);
+				M parallel = opLess(length, T(BOX_EDGE_AXIS_MIN_LENGTH));
+				length = opSelect(parallel, T(1.0f), length);
+
+				T ra = hA[i1]*AbsR[i2][j] + hA[i2]*AbsR[i1][j];
+				T rb = hB[j1]*AbsR[i][j2] + hB[j2]*AbsR[i][j1];
+				T d = opAbs(L[0]*t[0] + L[1]*t[1] + L[2]*t[2]);
+
+				T overlap = (ra + rb - d) / length;
+				overlap = opSelect(parallel, T(CMath<float>::inf()), overlap);
+
+				T biased_overlap = overlap*T(BOX_EDGE_AXIS_RELATIVE_TOLERANCE) + T(BOX_EDGE_AXIS_ABSOLUTE_TOLERANCE);
+				updateBestAxis(overlap, biased_overlap, (float)(6+i*3+j), o_separated, best_biased_overlap, o_best_overlap, o_best_axis);
+			}
+		}
+
+		return !opAll(o_separated);
+	}
+
+
+	/**
+	 * test one pair of boxes
+	 */
+	static inline void test(const cBox &a, const cBox &b, cResult &o_result)
+	{
+		float pA[3], A[3][3], hA[3];
+		float pB[3], B[3][3], hB[3];
+
+		for (int k = 0; k < 3; k++)
+		{
+			pA[k] = a.position.data[k];
+			hA[k] = a.half_size.data[k];
+			pB[k] = b.position.data[k];
+			hB[k] = b.half_size.data[k];
+
+			for (int l = 0; l < 3; l++)
+			{
+				A[k][l] = a.axes[k].data[l];
+				B[k][l] = b.axes[k].data[l];
+			}
+		}
+
+		bool separated;
+		float best_overlap, best_axis;
+		kernel(pA, A, hA, pB, B, hB, separated, best_overlap, best_axis);
+
+		o_result.axis = (separated || best_axis < 0 ? -1 : (int)best_axis);
+		o_result.depth = best_overlap;
+	}
+
+
+	/**
+	 * test p_count pairs of boxes (4 at once if SSE is available)
+	 */
+	static inline void test(const cBox * const *a, const cBox * const *b, int p_count, cResult *o_results)
+	{
+		int p = 0;
+
+#if PHYSICS_BOX_BOX_SAT_SSE
+		for (; p+4 <= p_count; p += 4)
+		{
+			float values[2][3+9+3][4];
+
+			for (int lane = 0; lane < 4; lane++)
+			{
+				const cBox *boxes[2] = {a[p+lane], b[p+lane]};
+
+				for (int n = 0; n < 2; n++)
+				{
+					for (int k = 0; k < 3; k++)
+					{
+						values[n][k][lane] = boxes[n]->position.data[k];
+						values[n][12+k][lane] = boxes[n]->half_size.data[k];
+
+						for (int l = 0; l < 3; l++)
+							values[n][3+k*3+l][lane] = boxes[n]->axes[k].data[l];
+					}
+				}
+			}
+
+			cFloat4 pA[3], A[3][3], hA[3];
+			cFloat4 pB[3], B[3][3], hB[3];
+
+			for (int k = 0; k < 3; k++)
+			{
+				pA[k] = _mm_loadu_ps(values[0][k]);
+				hA[k] = _mm_loadu_ps(values[0][12+k]);
+				pB[k] = _mm_loadu_ps(values[1][k]);
+				hB[k] = _mm_loadu_ps(values[1][12+k]);
+
+				for (int l = 0; l < 3; l++)
+				{
+					A[k][l] = _mm_loadu_ps(values[0][3+k*3+l]);
+					B[k][l] = _mm_loadu_ps(values[1][3+k*3+l]);
+				}
+			}
+
+			cFloat4 separated, best_overlap, best_axis;
+			kernel(pA, A, hA, pB, B, hB, separated, best_overlap, best_axis);
+
+			int separated_mask = _mm_movemask_ps(separated.v);
+			float depths[4], axes[4];
+			_mm_storeu_ps(depths, best_overlap.v);
+			_mm_storeu_ps(axes, best_axis.v);
+
+			for (int lane = 0; lane < 4; lane++)
+			{
+				cResult &r = o_results[p+lane];
+				r.axis = ((separated_mask & (1 << lane)) || axes[lane] < 0 ? -1 : (int)axes[lane]);
+				r.depth = depths[lane];
+			}
+		}
+#endif
+
+		for (; p < p_count; p++)
+			test(*a[p], *b[p], o_results[p]);
+	}
+};
+
+#endif
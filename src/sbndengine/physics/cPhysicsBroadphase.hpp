@@ -0,0 +1,118 @@
+/*
+ * Copyright 2010 Martin Schreiber
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef CPHYSICS_BROADPHASE_HPP
+#define CPHYSICS_BROADPHASE_HPP
+
+#include <vector>
+#include "sbndengine/physics/iPhysicsObject.hpp"
+
+
+/**
+ * pair of objects whose bounding volumes overlap
+ *
+ * physics_object1 was always added to the physics engine before
+ * physics_object2. this keeps the order of the collision tests
+ * independent of the broadphase algorithm.
+ */
+class cPhysicsBroadphasePair
+{
+public:
+	iPhysicsObject *physics_object1;
+	iPhysicsObject *physics_object2;
+
+	// sequence numbers given to the objects when they were added to the broadphase
+	unsigned int id1, id2;
+
+	cPhysicsBroadphasePair()
+	{
+	}
+
+	cPhysicsBroadphasePair(
+			iPhysicsObject *p_physics_object1,	unsigned int p_id1,
+			iPhysicsObject *p_physics_object2,	unsigned int p_id2
+		)
+	{
+		// store the object which was added first as first object
+		if (p_id1 < p_id2)
+		{
+			physics_object1 = p_physics_object1;	id1 = p_id1;
+			physics_object2 = p_physics_object2;	id2 = p_id2;
+		}
+		else
+		{
+			physics_object1 = p_physics_object2;	id1 = p_id2;
+			physics_object2 = p_physics_object1;	id2 = p_id1;
+		}
+	}
+
+	inline bool operator<(const cPhysicsBroadphasePair &p)	const
+	{
+		return id1 < p.id1 || (id1 == p.id1 && id2 < p.id2);
+	}
+};
+
+
+/**
+ * \brief interface for the broadphase collision detection
+ *
+ * the broadphase has to find all pairs of objects which may collide. only
+ * those pairs are handed over to the exact intersection tests
+ * (CPhysicsIntersections).
+ */
+class cPhysicsBroadphase
+{
+public:
+	virtual ~cPhysicsBroadphase()
+	{
+	}
+
+	/**
+	 * insert a new object into the broadphase
+	 */
+	virtual void addObject(iPhysicsObject *physics_object) = 0;
+
+	/**
+	 * remove an object from the broadphase
+	 */
+	virtual void removeObject(iPhysicsObject *physics_object) = 0;
+
+	/**
+	 * remove all objects
+	 */
+	virtual void clear() = 0;
+
+	/**
+	 * update the bounding volumes with the current object positions and
+	 * return all pairs with overlapping bounding volumes.
+	 *
+	 * pairs of 2 objects which are both not movable are never returned.
+	 * the pairs are sorted by the order in which the objects were added.
+	 */
+	virtual void computePairs(std::vector<cPhysicsBroadphasePair> &o_pairs) = 0;
+
+	/**
+	 * append all objects whose bounding volumes may overlap the given box
+	 * (e. g. to find the objects along the path of a fast object)
+	 */
+	virtual void query(
+			const CVector<3,float> &p_min,
+			const CVector<3,float> &p_max,
+			std::vector<iPhysicsObject*> &o_physics_objects
+		) = 0;
+};
+
+#endif
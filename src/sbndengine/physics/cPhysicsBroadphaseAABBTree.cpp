@@ -0,0 +1,398 @@
+/*
+ * Copyright 2010 Martin Schreiber
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include "cPhysicsBroadphaseAABBTree.hpp"
+#include <algorithm>
+#include "libmath/CMath.hpp"
+
+
+/**
+ * static boxes are enlarged by this distance to avoid missing contacts
+ * with objects lying exactly on a plane due to rounding errors
+ */
+#define AABB_TREE_STATIC_MARGIN			0.01f
+
+/**
+ * fat boxes of movable objects are enlarged by this fraction of the
+ * largest edge length of the tight box, but at least by the minimum margin
+ */
+#define AABB_TREE_FAT_MARGIN_FACTOR		0.1f
+#define AABB_TREE_FAT_MARGIN_MIN		0.05f
+
+/**
+ * fat boxes are additionally enlarged along the velocity by the distance
+ * which is moved within this time (2 timesteps with the default update rate)
+ */
+#define AABB_TREE_VELOCITY_PREDICTION	(2.0f/50.0f)
+
+
+static inline bool overlap(
+		const CVector<3,float> &min1, const CVector<3,float> &max1,
+		const CVector<3,float> &min2, const CVector<3,float> &max2
+	)
+{
+	return !(	max1.data[0] < min2.data[0] || max2.data[0] < min1.data[0] ||
+				max1.data[1] < min2.data[1] || max2.data[1] < min1.data[1] ||
+				max1.data[2] < min2.data[2] || max2.data[2] < min1.data[2]	);
+}
+
+
+cPhysicsBroadphaseAABBTree::cPhysicsBroadphaseAABBTree()	:
+		next_id(0)
+{
+}
+
+
+void cPhysicsBroadphaseAABBTree::addObject(iPhysicsObject *physics_object)
+{
+	proxies.push_back(cProxy());
+	cProxy &p = proxies.back();
+	p.physics_object = physics_object;
+	p.id = next_id++;
+	p.is_static = false;
+	p.valid = false;
+
+	/*
+	 * the position of the object is usually set after adding it to the
+	 * physics engine. thus the leaf is inserted during the next update or
+	 * the next query.
+	 */
+	p.leaf = AABB_TREE_NULL_NODE;
+	pending_proxies.push_back(&p);
+
+	updateLocalBox(p);
+}
+
+
+void cPhysicsBroadphaseAABBTree::removeObject(iPhysicsObject *physics_object)
+{
+	for (std::list<cProxy>::iterator i = proxies.begin(); i != proxies.end(); i++)
+	{
+		if ((*i).physics_object == physics_object)
+		{
+			std::vector<cProxy*>::iterator pending = std::find(pending_proxies.begin(), pending_proxies.end(), &*i);
+			if (pending != pending_proxies.end())
+				pending_proxies.erase(pending);
+
+			removeLeaf(*i);
+			proxies.erase(i);
+			return;
+		}
+	}
+}
+
+
+void cPhysicsBroadphaseAABBTree::clear()
+{
+	proxies.clear();
+	pending_proxies.clear();
+	static_tree.clear();
+	dynamic_tree.clear();
+	next_id = 0;
+}
+
+
+/**
+ * compute the box around the vertices of the object factory.
+ *
+ * spheres use their radius since the tessellated sphere is smaller than the
+ * sphere used for the collision tests.
+ */
+void cPhysicsBroadphaseAABBTree::updateLocalBox(cProxy &p)
+{
+	iObjectFactory &factory = *p.physics_object->object->objectFactory;
+
+	p.local_vertices = factory.vertices;
+	p.local_center.setZero();
+
+	if (factory.type == iObjectFactory::TYPE_SPHERE || factory.vertices == NULL || factory.triangles_count == 0)
+	{
+		float radius = factory.bounding_sphere_radius;
+		p.local_half_size = CVector<3,float>(radius, radius, radius);
+		return;
+	}
+
+	CVector<3,float> min(CMath<float>::inf(), CMath<float>::inf(), CMath<float>::inf());
+	CVector<3,float> max(-CMath<float>::inf(), -CMath<float>::inf(), -CMath<float>::inf());
+
+	float *v = factory.vertices;
+	for (int i = 0; i < factory.triangles_count*3; i++)
+	{
+		for (int a = 0; a < 3; a++)
+		{
+			min[a] = CMath<float>::min(min[a], v[a]);
+			max[a] = CMath<float>::max(max[a], v[a]);
+		}
+		v += 3;
+	}
+
+	p.local_center = (min + max)*0.5f;
+	p.local_half_size = (max - min)*0.5f;
+}
+
+
+/**
+ * transform the local box to world space and compute the axis aligned box
+ * enclosing it
+ */
+void cPhysicsBroadphaseAABBTree::updateWorldBox(cProxy &p)
+{
+	CMatrix4<float> &m = p.physics_object->object->model_matrix;
+
+	if (p.local_half_size[0] == CMath<float>::inf())
+	{
+		// objects without vertices overlap everything
+		p.min = CVector<3,float>(-CMath<float>::inf(), -CMath<float>::inf(), -CMath<float>::inf());
+		p.max = CVector<3,float>(CMath<float>::inf(), CMath<float>::inf(), CMath<float>::inf());
+		p.valid = true;
+		return;
+	}
+
+	p.valid = true;
+
+	for (int i = 0; i < 3; i++)
+	{
+		float center =	m[i][0]*p.local_center[0] + m[i][1]*p.local_center[1] +
+						m[i][2]*p.local_center[2] + m[i][3];
+
+		float half_size =	CMath<float>::abs(m[i][0])*p.local_half_size[0] +
+							CMath<float>::abs(m[i][1])*p.local_half_size[1] +
+							CMath<float>::abs(m[i][2])*p.local_half_size[2];
+
+		p.min[i] = center - half_size;
+		p.max[i] = center + half_size;
+
+		if (CMath<float>::isNan(p.min[i]) || CMath<float>::isNan(p.max[i]))
+			p.valid = false;
+	}
+
+	if (p.physics_object->object->objectFactory->type == iObjectFactory::TYPE_PLANE)
+	{
+		/*
+		 * the collision tests treat everything below a plane as penetrating.
+		 * thus the box is extended to infinity opposite to the plane normal
+		 * (local y axis) to keep objects which sank through the surface.
+		 */
+		for (int i = 0; i < 3; i++)
+		{
+			if (m[i][1] > 0)
+				p.min[i] = -CMath<float>::inf();
+			else if (m[i][1] < 0)
+				p.max[i] = CMath<float>::inf();
+		}
+	}
+}
+
+
+void cPhysicsBroadphaseAABBTree::insertLeaf(cProxy &p)
+{
+	p.is_static = !p.physics_object->isMovable();
+
+	if (p.is_static)
+	{
+		CVector<3,float> margin(AABB_TREE_STATIC_MARGIN, AABB_TREE_STATIC_MARGIN, AABB_TREE_STATIC_MARGIN);
+		p.leaf = static_tree.createProxy(p.min - margin, p.max + margin, &p);
+		return;
+	}
+
+	CVector<3,float> size = p.max - p.min;
+	float m = CMath<float>::max(AABB_TREE_FAT_MARGIN_MIN, CMath<float>::max(size[0], CMath<float>::max(size[1], size[2]))*AABB_TREE_FAT_MARGIN_FACTOR);
+
+	CVector<3,float> fat_min = p.min - CVector<3,float>(m, m, m);
+	CVector<3,float> fat_max = p.max + CVector<3,float>(m, m, m);
+
+	// enlarge the box in the direction of the movement
+	CVector<3,float> displacement = p.physics_object->velocity*AABB_TREE_VELOCITY_PREDICTION;
+	for (int a = 0; a < 3; a++)
+	{
+		if (displacement[a] < 0)
+			fat_min[a] += displacement[a];
+		else if (displacement[a] > 0)
+			fat_max[a] += displacement[a];
+	}
+
+	p.leaf = dynamic_tree.createProxy(fat_min, fat_max, &p);
+}
+
+
+void cPhysicsBroadphaseAABBTree::removeLeaf(cProxy &p)
+{
+	if (p.leaf == AABB_TREE_NULL_NODE)
+		return;
+
+	if (p.is_static)
+		static_tree.destroyProxy(p.leaf);
+	else
+		dynamic_tree.destroyProxy(p.leaf);
+
+	p.leaf = AABB_TREE_NULL_NODE;
+}
+
+
+void cPhysicsBroadphaseAABBTree::updateProxy(cProxy &p)
+{
+	iObject &object = *p.physics_object->object;
+
+	// the factory was resized
+	if (object.objectFactory->vertices != p.local_vertices)
+	{
+		updateLocalBox(p);
+		removeLeaf(p);
+	}
+
+	// the moveability of the object changed
+	if (p.leaf != AABB_TREE_NULL_NODE && p.is_static == p.physics_object->isMovable())
+		removeLeaf(p);
+
+	if (p.leaf != AABB_TREE_NULL_NODE && p.is_static)
+	{
+		bool moved = false;
+		for (int i = 0; i < 3 && !moved; i++)
+			for (int j = 0; j < 4; j++)
+				if (object.model_matrix[i][j] != p.static_model_matrix[i][j])
+				{
+					moved = true;
+					break;
+				}
+
+		if (!moved)
+			return;
+
+		removeLeaf(p);
+	}
+
+	updateWorldBox(p);
+
+	if (!p.valid)
+	{
+		removeLeaf(p);
+		return;
+	}
+
+	if (p.leaf != AABB_TREE_NULL_NODE)
+	{
+		// the object is still inside its fat box
+		const CVector<3,float> &fat_min = dynamic_tree.getMin(p.leaf);
+		const CVector<3,float> &fat_max = dynamic_tree.getMax(p.leaf);
+
+		if (	fat_min.data[0] <= p.min[0] && fat_min.data[1] <= p.min[1] && fat_min.data[2] <= p.min[2] &&
+				p.max[0] <= fat_max.data[0] && p.max[1] <= fat_max.data[1] && p.max[2] <= fat_max.data[2]
+		)
+			return;
+
+		removeLeaf(p);
+	}
+
+	insertLeaf(p);
+
+	if (p.is_static)
+		p.static_model_matrix = object.model_matrix;
+}
+
+
+/**
+ * insert the proxies of the objects which were added since the last update
+ */
+void cPhysicsBroadphaseAABBTree::insertPendingProxies()
+{
+	for (std::vector<cProxy*>::iterator i = pending_proxies.begin(); i != pending_proxies.end(); i++)
+		updateProxy(**i);
+
+	pending_proxies.clear();
+}
+
+
+void cPhysicsBroadphaseAABBTree::computePairs(std::vector<cPhysicsBroadphasePair> &o_pairs)
+{
+	o_pairs.clear();
+
+	for (std::list<cProxy>::iterator i = proxies.begin(); i != proxies.end(); i++)
+		updateProxy(*i);
+
+	pending_proxies.clear();
+
+	for (std::list<cProxy>::iterator i = proxies.begin(); i != proxies.end(); i++)
+	{
+		cProxy &p1 = *i;
+
+		if (p1.leaf == AABB_TREE_NULL_NODE || p1.is_static)
+			continue;
+
+		/*
+		 * static objects
+		 */
+		query_results.clear();
+		static_tree.query(p1.min, p1.max, query_results);
+
+		for (std::vector<void*>::iterator r = query_results.begin(); r != query_results.end(); r++)
+		{
+			cProxy &p2 = *static_cast<cProxy*>(*r);
+
+			o_pairs.push_back(cPhysicsBroadphasePair(p1.physics_object, p1.id, p2.physics_object, p2.id));
+		}
+
+		/*
+		 * movable objects - the fat boxes are only used to find the candidates
+		 */
+		query_results.clear();
+		dynamic_tree.query(p1.min, p1.max, query_results);
+
+		for (std::vector<void*>::iterator r = query_results.begin(); r != query_results.end(); r++)
+		{
+			cProxy &p2 = *static_cast<cProxy*>(*r);
+
+			// every pair is found twice
+			if (p1.id >= p2.id)
+				continue;
+
+			if (!overlap(p1.min, p1.max, p2.min, p2.max))
+				continue;
+
+			o_pairs.push_back(cPhysicsBroadphasePair(p1.physics_object, p1.id, p2.physics_object, p2.id));
+		}
+	}
+
+	/*
+	 * sort the pairs to get the same order of collision tests as with testing
+	 * all object pairs in the order in which they were added
+	 */
+	std::sort(o_pairs.begin(), o_pairs.end());
+}
+
+
+/**
+ * the trees are searched with the boxes of the last update. the fat boxes
+ * of the movable objects are enlarged along their velocity, thus they usually
+ * still enclose the objects. objects which were added since the last update
+ * are inserted at first.
+ */
+void cPhysicsBroadphaseAABBTree::query(
+		const CVector<3,float> &p_min,
+		const CVector<3,float> &p_max,
+		std::vector<iPhysicsObject*> &o_physics_objects
+	)
+{
+	if (!pending_proxies.empty())
+		insertPendingProxies();
+
+	query_results.clear();
+	static_tree.query(p_min, p_max, query_results);
+	dynamic_tree.query(p_min, p_max, query_results);
+
+	for (std::vector<void*>::iterator r = query_results.begin(); r != query_results.end(); r++)
+		o_physics_objects.push_back(static_cast<cProxy*>(*r)->physics_object);
+}
@@ -0,0 +1,112 @@
+/*
+ * Copyright 2010 Martin Schreiber
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef CPHYSICS_BROADPHASE_AABB_TREE_HPP
+#define CPHYSICS_BROADPHASE_AABB_TREE_HPP
+
+#include <list>
+#include <vector>
+#include "cPhysicsBroadphase.hpp"
+#include "cPhysicsAABBTree.hpp"
+
+
+/**
+ * \brief broadphase with dynamic bounding volume trees
+ *
+ * the boxes are computed from the oriented bounding box of the object
+ * vertices instead of the bounding sphere. thus e. g. a floor plane only
+ * overlaps the objects which are close to it.
+ *
+ * objects which are not movable (walls, floors) are stored in a separate
+ * tree. this tree is not refitted during the simulation - a leaf is only
+ * reinserted if the application moves the object.
+ *
+ * movable objects are stored with enlarged ("fat") boxes in a second tree.
+ * as long as the object stays inside its fat box, the tree is not modified.
+ */
+class cPhysicsBroadphaseAABBTree	:	public cPhysicsBroadphase
+{
+	class cProxy
+	{
+	public:
+		iPhysicsObject *physics_object;
+		unsigned int id;
+
+		// true, if the leaf is stored in the static tree
+		bool is_static;
+
+		// leaf in the static or dynamic tree
+		int leaf;
+
+		// tight box around the object in world space
+		CVector<3,float> min;
+		CVector<3,float> max;
+
+		// box around the object in object space
+		CVector<3,float> local_center;
+		CVector<3,float> local_half_size;
+
+		// vertices which were used to compute the local box
+		float *local_vertices;
+
+		// model matrix of a static object when it was inserted into the tree
+		CMatrix4<float> static_model_matrix;
+
+		// false, if the object has an invalid position
+		bool valid;
+	};
+
+	std::list<cProxy> proxies;
+
+	/**
+	 * proxies which were added since the last update and are not inserted
+	 * into a tree yet
+	 */
+	std::vector<cProxy*> pending_proxies;
+
+	cPhysicsAABBTree static_tree;
+	cPhysicsAABBTree dynamic_tree;
+
+	/**
+	 * temporary storage for query results
+	 */
+	std::vector<void*> query_results;
+
+	/**
+	 * sequence number for the next added object
+	 */
+	unsigned int next_id;
+
+	void updateLocalBox(cProxy &p);
+	void updateWorldBox(cProxy &p);
+	void updateProxy(cProxy &p);
+
+	void insertLeaf(cProxy &p);
+	void removeLeaf(cProxy &p);
+
+	void insertPendingProxies();
+
+public:
+	cPhysicsBroadphaseAABBTree();
+
+	void addObject(iPhysicsObject *physics_object);
+	void removeObject(iPhysicsObject *physics_object);
+	void clear();
+	void computePairs(std::vector<cPhysicsBroadphasePair> &o_pairs);
+	void query(const CVector<3,float> &p_min, const CVector<3,float> &p_max, std::vector<iPhysicsObject*> &o_physics_objects);
+};
+
+#endif
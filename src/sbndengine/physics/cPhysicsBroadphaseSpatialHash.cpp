@@ -0,0 +1,310 @@
+/*
+ * Copyright 2010 Martin Schreiber
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include "cPhysicsBroadphaseSpatialHash.hpp"
+#include <algorithm>
+#include <cmath>
+#include "libmath/CMath.hpp"
+
+
+/**
+ * objects overlapping more cells along one axis are handled as large objects
+ */
+#define SPATIAL_HASH_MAX_CELLS_PER_AXIS	4
+
+/**
+ * cell coordinates are clamped to this range to fit into 21 bits
+ */
+#define SPATIAL_HASH_MAX_CELL_COORDINATE	((1 << 20) - 1)
+
+
+cPhysicsBroadphaseSpatialHash::cPhysicsBroadphaseSpatialHash()	:
+		cell_size(1),
+		inv_cell_size(1),
+		next_id(0)
+{
+}
+
+
+void cPhysicsBroadphaseSpatialHash::addObject(iPhysicsObject *physics_object)
+{
+	proxies.push_back(cProxy());
+	cProxy &p = proxies.back();
+	p.physics_object = physics_object;
+	p.id = next_id++;
+}
+
+
+void cPhysicsBroadphaseSpatialHash::removeObject(iPhysicsObject *physics_object)
+{
+	for (std::list<cProxy>::iterator i = proxies.begin(); i != proxies.end(); i++)
+	{
+		if ((*i).physics_object == physics_object)
+		{
+			proxies.erase(i);
+			return;
+		}
+	}
+}
+
+
+void cPhysicsBroadphaseSpatialHash::clear()
+{
+	proxies.clear();
+	cell_entries.clear();
+	large_proxies.clear();
+	next_id = 0;
+}
+
+
+void cPhysicsBroadphaseSpatialHash::updateProxies()
+{
+	for (std::list<cProxy>::iterator i = proxies.begin(); i != proxies.end(); i++)
+	{
+		cProxy &p = *i;
+
+		CVector<3,float> &position = p.physics_object->object->position;
+		float radius = p.physics_object->object->objectFactory->bounding_sphere_radius;
+
+		for (int a = 0; a < 3; a++)
+		{
+			p.min[a] = position[a] - radius;
+			p.max[a] = position[a] + radius;
+		}
+
+		p.movable = p.physics_object->isMovable();
+	}
+}
+
+
+/**
+ * set the cell size to twice the median bounding sphere radius
+ */
+void cPhysicsBroadphaseSpatialHash::updateCellSize()
+{
+	radii.clear();
+
+	for (std::list<cProxy>::iterator i = proxies.begin(); i != proxies.end(); i++)
+	{
+		float radius = (*i).physics_object->object->objectFactory->bounding_sphere_radius;
+
+		if (radius > 0 && radius != CMath<float>::inf())
+			radii.push_back(radius);
+	}
+
+	if (radii.empty())
+		return;
+
+	std::vector<float>::iterator median = radii.begin() + radii.size()/2;
+	std::nth_element(radii.begin(), median, radii.end());
+
+	cell_size = (*median)*2.0f;
+	inv_cell_size = 1.0f/cell_size;
+}
+
+
+inline int cPhysicsBroadphaseSpatialHash::getCellCoordinate(float value)
+{
+	float c = std::floor(value*inv_cell_size);
+
+	if (c < -SPATIAL_HASH_MAX_CELL_COORDINATE)
+		return -SPATIAL_HASH_MAX_CELL_COORDINATE;
+	if (c > SPATIAL_HASH_MAX_CELL_COORDINATE)
+		return SPATIAL_HASH_MAX_CELL_COORDINATE;
+	return (int)c;
+}
+
+
+/**
+ * pack the 3 cell coordinates into one key
+ */
+inline unsigned long long cPhysicsBroadphaseSpatialHash::getCellKey(int x, int y, int z)
+{
+	return	((unsigned long long)(x + SPATIAL_HASH_MAX_CELL_COORDINATE) << 42) |
+			((unsigned long long)(y + SPATIAL_HASH_MAX_CELL_COORDINATE) << 21) |
+			((unsigned long long)(z + SPATIAL_HASH_MAX_CELL_COORDINATE));
+}
+
+
+void cPhysicsBroadphaseSpatialHash::computePairs(std::vector<cPhysicsBroadphasePair> &o_pairs)
+{
+	o_pairs.clear();
+
+	updateProxies();
+	updateCellSize();
+
+	cell_entries.clear();
+	large_proxies.clear();
+
+	/*
+	 * insert the objects into the cells
+	 */
+	for (std::list<cProxy>::iterator i = proxies.begin(); i != proxies.end(); i++)
+	{
+		cProxy &p = *i;
+
+		int cmin[3], cmax[3];
+		p.large = false;
+
+		for (int a = 0; a < 3; a++)
+		{
+			// objects with invalid positions are also handled as large objects
+			if (!(p.max[a] - p.min[a] <= cell_size*SPATIAL_HASH_MAX_CELLS_PER_AXIS))
+			{
+				p.large = true;
+				break;
+			}
+
+			cmin[a] = getCellCoordinate(p.min[a]);
+			cmax[a] = getCellCoordinate(p.max[a]);
+		}
+
+		if (p.large)
+		{
+			large_proxies.push_back(&p);
+			continue;
+		}
+
+		cCellEntry e;
+		e.proxy = &p;
+
+		for (int x = cmin[0]; x <= cmax[0]; x++)
+			for (int y = cmin[1]; y <= cmax[1]; y++)
+				for (int z = cmin[2]; z <= cmax[2]; z++)
+				{
+					e.cell_key = getCellKey(x, y, z);
+					cell_entries.push_back(e);
+				}
+	}
+
+	std::sort(cell_entries.begin(), cell_entries.end());
+
+	/*
+	 * test all objects sharing a cell
+	 */
+	size_t size = cell_entries.size();
+	size_t cell_start = 0;
+
+	while (cell_start < size)
+	{
+		unsigned long long cell_key = cell_entries[cell_start].cell_key;
+
+		size_t cell_end = cell_start+1;
+		while (cell_end < size && cell_entries[cell_end].cell_key == cell_key)
+			cell_end++;
+
+		for (size_t i1 = cell_start; i1 < cell_end; i1++)
+		{
+			cProxy &p1 = *cell_entries[i1].proxy;
+
+			for (size_t i2 = i1+1; i2 < cell_end; i2++)
+			{
+				cProxy &p2 = *cell_entries[i2].proxy;
+
+				if (!p1.movable && !p2.movable)
+					continue;
+
+				if (	p1.max[0] < p2.min[0] || p2.max[0] < p1.min[0] ||
+						p1.max[1] < p2.min[1] || p2.max[1] < p1.min[1] ||
+						p1.max[2] < p2.min[2] || p2.max[2] < p1.min[2]
+				)
+					continue;
+
+				/*
+				 * objects overlapping several cells share more than one cell.
+				 * the pair is only reported in the cell which contains the minimum
+				 * corner of the intersection of both boxes.
+				 */
+				if (getCellKey(
+						getCellCoordinate(std::max(p1.min[0], p2.min[0])),
+						getCellCoordinate(std::max(p1.min[1], p2.min[1])),
+						getCellCoordinate(std::max(p1.min[2], p2.min[2]))
+					) != cell_key)
+					continue;
+
+				o_pairs.push_back(cPhysicsBroadphasePair(p1.physics_object, p1.id, p2.physics_object, p2.id));
+			}
+		}
+
+		cell_start = cell_end;
+	}
+
+	/*
+	 * test the large objects against all other objects
+	 */
+	for (std::vector<cProxy*>::iterator l = large_proxies.begin(); l != large_proxies.end(); l++)
+	{
+		cProxy &p1 = **l;
+
+		for (std::list<cProxy>::iterator i = proxies.begin(); i != proxies.end(); i++)
+		{
+			cProxy &p2 = *i;
+
+			if (&p1 == &p2)
+				continue;
+
+			if (!p1.movable && !p2.movable)
+				continue;
+
+			// pairs of 2 large objects are found twice
+			if (p2.large && p1.id > p2.id)
+				continue;
+
+			if (	p1.max[0] < p2.min[0] || p2.max[0] < p1.min[0] ||
+					p1.max[1] < p2.min[1] || p2.max[1] < p1.min[1] ||
+					p1.max[2] < p2.min[2] || p2.max[2] < p1.min[2]
+			)
+				continue;
+
+			o_pairs.push_back(cPhysicsBroadphasePair(p1.physics_object, p1.id, p2.physics_object, p2.id));
+		}
+	}
+
+	/*
+	 * sort the pairs to get the same order of collision tests as with testing
+	 * all object pairs in the order in which they were added
+	 */
+	std::sort(o_pairs.begin(), o_pairs.end());
+}
+
+
+/**
+ * the boxes are computed with the current positions, thus all objects are
+ * tested (the application usually queries only a few boxes per timestep)
+ */
+void cPhysicsBroadphaseSpatialHash::query(
+		const CVector<3,float> &p_min,
+		const CVector<3,float> &p_max,
+		std::vector<iPhysicsObject*> &o_physics_objects
+	)
+{
+	for (std::list<cProxy>::iterator i = proxies.begin(); i != proxies.end(); i++)
+	{
+		iPhysicsObject *physics_object = (*i).physics_object;
+
+		CVector<3,float> &position = physics_object->object->position;
+		float radius = physics_object->object->objectFactory->bounding_sphere_radius;
+
+		if (	position[0] + radius < p_min.data[0] || p_max.data[0] < position[0] - radius ||
+				position[1] + radius < p_min.data[1] || p_max.data[1] < position[1] - radius ||
+				position[2] + radius < p_min.data[2] || p_max.data[2] < position[2] - radius
+		)
+			continue;
+
+		o_physics_objects.push_back(physics_object);
+	}
+}
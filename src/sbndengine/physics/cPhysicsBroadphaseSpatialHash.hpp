@@ -0,0 +1,114 @@
+/*
+ * Copyright 2010 Martin Schreiber
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef CPHYSICS_BROADPHASE_SPATIAL_HASH_HPP
+#define CPHYSICS_BROADPHASE_SPATIAL_HASH_HPP
+
+#include <list>
+#include <vector>
+#include "cPhysicsBroadphase.hpp"
+
+
+/**
+ * \brief uniform spatial hash grid broadphase
+ *
+ * the space is subdivided into cubic cells. the cell size is twice the
+ * median bounding sphere radius, thus most objects overlap only a few cells.
+ *
+ * every object is inserted into all cells overlapped by its axis aligned
+ * bounding box. the (cell key, object) entries are sorted to bring objects
+ * sharing a cell together - this avoids any dynamic hash table allocations.
+ *
+ * objects which would overlap too many cells (e. g. the large planes used as
+ * walls) are not inserted into the grid. they are tested against all other
+ * objects instead.
+ */
+class cPhysicsBroadphaseSpatialHash	:	public cPhysicsBroadphase
+{
+	/**
+	 * bounding box of an object
+	 */
+	class cProxy
+	{
+	public:
+		iPhysicsObject *physics_object;
+		unsigned int id;
+		bool movable;
+
+		// true, if the object is not inserted into the grid
+		bool large;
+
+		CVector<3,float> min;
+		CVector<3,float> max;
+	};
+
+	/**
+	 * entry of an object in one cell
+	 */
+	class cCellEntry
+	{
+	public:
+		unsigned long long cell_key;
+		cProxy *proxy;
+
+		inline bool operator<(const cCellEntry &e)	const
+		{
+			return cell_key < e.cell_key || (cell_key == e.cell_key && proxy->id < e.proxy->id);
+		}
+	};
+
+	std::list<cProxy> proxies;
+
+	std::vector<cCellEntry> cell_entries;
+
+	/**
+	 * objects which are too large to be inserted into the grid
+	 */
+	std::vector<cProxy*> large_proxies;
+
+	/**
+	 * temporary storage to compute the median radius
+	 */
+	std::vector<float> radii;
+
+	/**
+	 * edge length of one cell
+	 */
+	float cell_size;
+	float inv_cell_size;
+
+	/**
+	 * sequence number for the next added object
+	 */
+	unsigned int next_id;
+
+	void updateProxies();
+	void updateCellSize();
+
+	inline int getCellCoordinate(float value);
+	inline unsigned long long getCellKey(int x, int y, int z);
+
+public:
+	cPhysicsBroadphaseSpatialHash();
+
+	void addObject(iPhysicsObject *physics_object);
+	void removeObject(iPhysicsObject *physics_object);
+	void clear();
+	void computePairs(std::vector<cPhysicsBroadphasePair> &o_pairs);
+	void query(const CVector<3,float> &p_min, const CVector<3,float> &p_max, std::vector<iPhysicsObject*> &o_physics_objects);
+};
+
+#endif
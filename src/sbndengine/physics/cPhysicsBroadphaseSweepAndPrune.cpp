@@ -0,0 +1,288 @@
+/*
+ * Copyright 2010 Martin Schreiber
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include "cPhysicsBroadphaseSweepAndPrune.hpp"
+#include <algorithm>
+#include "libmath/CMath.hpp"
+
+
+/**
+ * the main axis is only changed if the variance along another axis is larger
+ * by this factor. otherwise the endpoints would be resorted from scratch over
+ * and over for objects which are distributed equally along 2 axes.
+ */
+#define SAP_MAIN_AXIS_HYSTERESIS	1.2f
+
+
+cPhysicsBroadphaseSweepAndPrune::cPhysicsBroadphaseSweepAndPrune()	:
+		main_axis(0),
+		endpoints_unsorted(false),
+		next_id(0)
+{
+}
+
+
+void cPhysicsBroadphaseSweepAndPrune::addObject(iPhysicsObject *physics_object)
+{
+	proxies.push_back(cProxy());
+	cProxy &p = proxies.back();
+	p.physics_object = physics_object;
+	p.id = next_id++;
+
+	cEndpoint e;
+	e.value = 0;
+	e.proxy = &p;
+
+	e.is_max = false;
+	endpoints.push_back(e);
+	e.is_max = true;
+	endpoints.push_back(e);
+
+	endpoints_unsorted = true;
+}
+
+
+void cPhysicsBroadphaseSweepAndPrune::removeObject(iPhysicsObject *physics_object)
+{
+	for (std::list<cProxy>::iterator i = proxies.begin(); i != proxies.end(); i++)
+	{
+		if ((*i).physics_object != physics_object)
+			continue;
+
+		cProxy *p = &*i;
+
+		// remove both endpoints while keeping the order of the remaining ones
+		size_t j = 0;
+		for (size_t k = 0; k < endpoints.size(); k++)
+		{
+			if (endpoints[k].proxy != p)
+				endpoints[j++] = endpoints[k];
+		}
+		endpoints.resize(j);
+
+		proxies.erase(i);
+		return;
+	}
+}
+
+
+void cPhysicsBroadphaseSweepAndPrune::clear()
+{
+	proxies.clear();
+	endpoints.clear();
+	active_proxies.clear();
+	endpoints_unsorted = false;
+	next_id = 0;
+}
+
+
+/**
+ * update the bounding boxes and choose the main axis
+ */
+void cPhysicsBroadphaseSweepAndPrune::updateProxies()
+{
+	CVector<3,float> sum(0,0,0);
+	CVector<3,float> sum2(0,0,0);
+	int n = 0;
+
+	for (std::list<cProxy>::iterator i = proxies.begin(); i != proxies.end(); i++)
+	{
+		cProxy &p = *i;
+
+		CVector<3,float> &position = p.physics_object->object->position;
+		float radius = p.physics_object->object->objectFactory->bounding_sphere_radius;
+
+		for (int a = 0; a < 3; a++)
+		{
+			p.min[a] = position[a] - radius;
+			p.max[a] = position[a] + radius;
+
+			// move invalid boxes to the end to keep the sort order well defined
+			if (CMath<float>::isNan(p.min[a]) || CMath<float>::isNan(p.max[a]))
+			{
+				p.min[a] = CMath<float>::inf();
+				p.max[a] = CMath<float>::inf();
+			}
+
+		}
+
+		// objects without limited extent are not used to find the main axis
+		if (radius == CMath<float>::inf())
+			continue;
+
+		for (int a = 0; a < 3; a++)
+		{
+			sum[a] += position[a];
+			sum2[a] += position[a]*position[a];
+		}
+		n++;
+	}
+
+	if (n == 0)
+		return;
+
+	float inv_n = 1.0f/(float)n;
+	CVector<3,float> variance;
+	for (int a = 0; a < 3; a++)
+		variance[a] = sum2[a]*inv_n - sum[a]*sum[a]*inv_n*inv_n;
+
+	int new_main_axis = main_axis;
+	for (int a = 0; a < 3; a++)
+	{
+		if (variance[a] > variance[new_main_axis]*SAP_MAIN_AXIS_HYSTERESIS)
+			new_main_axis = a;
+	}
+
+	if (new_main_axis != main_axis)
+	{
+		main_axis = new_main_axis;
+		endpoints_unsorted = true;
+	}
+}
+
+
+void cPhysicsBroadphaseSweepAndPrune::updateEndpointValues()
+{
+	for (std::vector<cEndpoint>::iterator i = endpoints.begin(); i != endpoints.end(); i++)
+	{
+		cEndpoint &e = *i;
+		e.value = (e.is_max ? e.proxy->max[main_axis] : e.proxy->min[main_axis]);
+	}
+}
+
+
+/**
+ * the endpoints are almost sorted since the objects moved only a little bit
+ * since the last timestep. thus insertion sort runs in almost linear time.
+ */
+void cPhysicsBroadphaseSweepAndPrune::insertionSortEndpoints()
+{
+	size_t size = endpoints.size();
+
+	for (size_t i = 1; i < size; i++)
+	{
+		cEndpoint e = endpoints[i];
+
+		size_t j = i;
+		while (j > 0 && e < endpoints[j-1])
+		{
+			endpoints[j] = endpoints[j-1];
+			j--;
+		}
+		endpoints[j] = e;
+	}
+}
+
+
+void cPhysicsBroadphaseSweepAndPrune::computePairs(std::vector<cPhysicsBroadphasePair> &o_pairs)
+{
+	o_pairs.clear();
+
+	updateProxies();
+	updateEndpointValues();
+
+	if (endpoints_unsorted)
+	{
+		std::sort(endpoints.begin(), endpoints.end());
+		endpoints_unsorted = false;
+	}
+	else
+	{
+		insertionSortEndpoints();
+	}
+
+	int axis1 = (main_axis+1)%3;
+	int axis2 = (main_axis+2)%3;
+
+	active_proxies.clear();
+
+	for (std::vector<cEndpoint>::iterator i = endpoints.begin(); i != endpoints.end(); i++)
+	{
+		cEndpoint &e = *i;
+		cProxy *p1 = e.proxy;
+
+		if (e.is_max)
+		{
+			// the box was left - remove it from the active list
+			for (std::vector<cProxy*>::iterator a = active_proxies.begin(); a != active_proxies.end(); a++)
+			{
+				if (*a == p1)
+				{
+					*a = active_proxies.back();
+					active_proxies.pop_back();
+					break;
+				}
+			}
+			continue;
+		}
+
+		bool movable1 = p1->physics_object->isMovable();
+
+		// the box overlaps all active boxes along the main axis
+		for (std::vector<cProxy*>::iterator a = active_proxies.begin(); a != active_proxies.end(); a++)
+		{
+			cProxy *p2 = *a;
+
+			if (!movable1 && !p2->physics_object->isMovable())
+				continue;
+
+			if (p1->max[axis1] < p2->min[axis1] || p2->max[axis1] < p1->min[axis1])
+				continue;
+
+			if (p1->max[axis2] < p2->min[axis2] || p2->max[axis2] < p1->min[axis2])
+				continue;
+
+			o_pairs.push_back(cPhysicsBroadphasePair(p1->physics_object, p1->id, p2->physics_object, p2->id));
+		}
+
+		active_proxies.push_back(p1);
+	}
+
+	/*
+	 * sort the pairs to get the same order of collision tests as with testing
+	 * all object pairs in the order in which they were added
+	 */
+	std::sort(o_pairs.begin(), o_pairs.end());
+}
+
+
+/**
+ * the boxes are computed with the current positions, thus all objects are
+ * tested (the application usually queries only a few boxes per timestep)
+ */
+void cPhysicsBroadphaseSweepAndPrune::query(
+		const CVector<3,float> &p_min,
+		const CVector<3,float> &p_max,
+		std::vector<iPhysicsObject*> &o_physics_objects
+	)
+{
+	for (std::list<cProxy>::iterator i = proxies.begin(); i != proxies.end(); i++)
+	{
+		iPhysicsObject *physics_object = (*i).physics_object;
+
+		CVector<3,float> &position = physics_object->object->position;
+		float radius = physics_object->object->objectFactory->bounding_sphere_radius;
+
+		if (	position[0] + radius < p_min.data[0] || p_max.data[0] < position[0] - radius ||
+				position[1] + radius < p_min.data[1] || p_max.data[1] < position[1] - radius ||
+				position[2] + radius < p_min.data[2] || p_max.data[2] < position[2] - radius
+		)
+			continue;
+
+		o_physics_objects.push_back(physics_object);
+	}
+}
@@ -0,0 +1,108 @@
+/*
+ * Copyright 2010 Martin Schreiber
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef CPHYSICS_BROADPHASE_SWEEP_AND_PRUNE_HPP
+#define CPHYSICS_BROADPHASE_SWEEP_AND_PRUNE_HPP
+
+#include <list>
+#include <vector>
+#include "cPhysicsBroadphase.hpp"
+
+
+/**
+ * \brief sweep and prune broadphase
+ *
+ * every object is represented by an axis aligned bounding box which is
+ * computed with the bounding sphere radius of the object factory.
+ *
+ * the start and end points of the boxes are stored in a sorted array along
+ * the main axis (the axis with the largest variance of the object positions).
+ * since the objects move only a little bit during one timestep, the array
+ * is almost sorted and insertion sort is used to update it.
+ *
+ * sweeping over the array gives all pairs of boxes which overlap on the main
+ * axis. for those, the overlap on the remaining 2 axes is tested.
+ */
+class cPhysicsBroadphaseSweepAndPrune	:	public cPhysicsBroadphase
+{
+	/**
+	 * bounding box of an object
+	 */
+	class cProxy
+	{
+	public:
+		iPhysicsObject *physics_object;
+		unsigned int id;
+
+		CVector<3,float> min;
+		CVector<3,float> max;
+	};
+
+	/**
+	 * start or end point of a bounding box along the main axis
+	 */
+	class cEndpoint
+	{
+	public:
+		float value;
+		cProxy *proxy;
+		bool is_max;
+
+		inline bool operator<(const cEndpoint &e)	const
+		{
+			// start points are sorted before end points to handle touching boxes as overlapping
+			return value < e.value || (value == e.value && !is_max && e.is_max);
+		}
+	};
+
+	std::list<cProxy> proxies;
+	std::vector<cEndpoint> endpoints;
+
+	/**
+	 * proxies overlapping the current sweep position
+	 */
+	std::vector<cProxy*> active_proxies;
+
+	/**
+	 * axis along which the endpoints are sorted
+	 */
+	int main_axis;
+
+	/**
+	 * true, if the endpoints have to be sorted from scratch
+	 */
+	bool endpoints_unsorted;
+
+	/**
+	 * sequence number for the next added object
+	 */
+	unsigned int next_id;
+
+	void updateProxies();
+	void updateEndpointValues();
+	void insertionSortEndpoints();
+
+public:
+	cPhysicsBroadphaseSweepAndPrune();
+
+	void addObject(iPhysicsObject *physics_object);
+	void removeObject(iPhysicsObject *physics_object);
+	void clear();
+	void computePairs(std::vector<cPhysicsBroadphasePair> &o_pairs);
+	void query(const CVector<3,float> &p_min, const CVector<3,float> &p_max, std::vector<iPhysicsObject*> &o_physics_objects);
+};
+
+#endif
@@ -17,6 +17,12 @@
 #ifndef CPHYSICS_COLLISION_DATA_HPP
 #define CPHYSICS_COLLISION_DATA_HPP
 
+/**
+ * feature id used for the collision datasets of hard constraints (ropes).
+ * this avoids mixing them up with contacts between the same objects.
+ */
+#define COLLISION_FEATURE_HARD_CONSTRAINT	0xffffffffu
+
 class CPhysicsCollisionData	: public iBase
 {
 public:
@@ -32,7 +38,63 @@ public:
 	// the interpenetration depth
 	float interpenetration_depth;
 
-	CPhysicsCollisionData()
+	/**
+	 * id of the features (e. g. vertex, edge or face) which are in contact.
+	 *
+	 * together with both objects, this identifies the same contact in the
+	 * next timestep to reuse the accumulated impulse.
+	 */
+	unsigned int feature_id;
+
+	/**
+	 * index of this collision point in the contact manifold of both objects
+	 * and the number of points of the manifold.
+	 *
+	 * the points of one manifold share the collision normal (except for the
+	 * contacts with several triangles of a mesh) and are stored
+	 * consecutively, starting with the deepest point.
+	 */
+	int manifold_point;
+	int manifold_points;
+
+	/**
+	 * impulse solver data
+	 */
+	// accumulated impulse along the collision normal (always >= 0)
+	float normal_impulse;
+
+	// relative velocity along the normal which has to be reached by the impulses
+	float target_velocity;
+
+	// 1 / change of the relative velocity for an impulse of 1
+	float normal_mass;
+
+	// accumulated impulse perpendicular to the normal
+	CVector<3,float> friction_impulse;
+
+	// friction coefficients of the object pair, 0 if friction is disabled
+	float friction_static_coefficient;
+	float friction_dynamic_coefficient;
+
+	// lever arms and inverse inertia tensors in world space
+	CVector<3,float> lever1, lever2;
+	CMatrix3<float> world_inverse_inertia1, world_inverse_inertia2;
+
+	/**
+	 * interpenetration solver data
+	 *
+	 * object positions when the collision was detected. the objects are only
+	 * translated while resolving the interpenetrations, thus the remaining
+	 * depth is computed from the translations since then.
+	 */
+	CVector<3,float> detection_position1, detection_position2;
+
+	CPhysicsCollisionData()	:
+		feature_id(0),
+		manifold_point(0),
+		manifold_points(1),
+		normal_impulse(0),
+		friction_impulse(0, 0, 0)
 	{
 	}
 
@@ -72,6 +134,12 @@ public:
 		collision_point2 = p_collision_point2;
 		collision_normal = p_collision_normal;
 		interpenetration_depth = p_interpenetration_depth;
+
+		feature_id = 0;
+		manifold_point = 0;
+		manifold_points = 1;
+		normal_impulse = 0;
+		friction_impulse.setZero();
 	}
 };
 
@@ -20,75 +20,261 @@
 #include "cPhysicsCollisionData.hpp"
 #include "worksheets_precompiler.hpp"
 
+/**
+ * closing velocities below this value are not reflected with the coefficient
+ * of restitution. otherwise resting objects would bounce slightly every
+ * timestep due to the gravitation accelerating them into the ground.
+ */
+#define COLLISION_RESTITUTION_VELOCITY_THRESHOLD	0.5f
+
 /*
  * this class handles the change of object velocity (linear and angular)
  * by applying an impulse
+ *
+ * the impulses of all collisions are accumulated during one timestep and
+ * clamped to be non-negative. thus the collisions may only push the objects
+ * apart and the accumulated impulse of the last timestep can be used as
+ * starting value (warm starting).
  */
 class CPhysicsCollisionImpulse
 {
-public:
-	static inline void applyCollisionImpulse(CPhysicsCollisionData &c, double frame_elapsed_time)
+	/**
+	 * relative velocity of both objects at the collision points along the
+	 * collision normal. positive values mean that the objects approach.
+	 */
+	static inline float getClosingVelocity(CPhysicsCollisionData &c)
+	{
+		CVector<3,float> closing_velocity1 = c.physics_object1->velocity + (c.physics_object1->angular_velocity % c.lever1);
+		CVector<3,float> closing_velocity2 = c.physics_object2->velocity + (c.physics_object2->angular_velocity % c.lever2);
+
+		return c.collision_normal.dotProd(closing_velocity1 - closing_velocity2);
+	}
+
+	/**
+	 * apply the impulse p_impulse*collision_normal to object 2 and the
+	 * opposite one to object 1
+	 */
+	static inline void applyImpulse(CPhysicsCollisionData &c, float p_impulse)
+	{
+		/*
+		 * fixed objects are shared by islands which are solved concurrently.
+		 * thus their velocities are not written.
+		 */
+		if (c.physics_object1->isMovable())
+		{
+			c.physics_object1->velocity -= c.collision_normal*(c.physics_object1->inv_mass*p_impulse);
+#if WORKSHEET_6
+			c.physics_object1->angular_velocity -= c.world_inverse_inertia1 * (c.lever1 % c.collision_normal) * p_impulse;
+#endif
+		}
+
+		if (c.physics_object2->isMovable())
+		{
+			c.physics_object2->velocity += c.collision_normal*(c.physics_object2->inv_mass*p_impulse);
+#if WORKSHEET_6
+			c.physics_object2->angular_velocity += c.world_inverse_inertia2 * (c.lever2 % c.collision_normal) * p_impulse;
+#endif
+		}
+	}
+
+	/**
+	 * apply the impulse p_impulse to object 2 and the opposite one to
+	 * object 1
+	 */
+	static inline void applyImpulse(CPhysicsCollisionData &c, const CVector<3,float> &p_impulse)
 	{
+		if (c.physics_object1->isMovable())
+		{
+			c.physics_object1->velocity -= p_impulse*c.physics_object1->inv_mass;
+#if WORKSHEET_6
+			c.physics_object1->angular_velocity -= c.world_inverse_inertia1 * (c.lever1 % p_impulse);
+#endif
+		}
+
+		if (c.physics_object2->isMovable())
+		{
+			c.physics_object2->velocity += p_impulse*c.physics_object2->inv_mass;
 #if WORKSHEET_6
+			c.physics_object2->angular_velocity += c.world_inverse_inertia2 * (c.lever2 % p_impulse);
+#endif
+		}
+	}
+
+	/**
+	 * 1 / change of the relative velocity along p_direction for an impulse
+	 * of 1 along p_direction
+	 */
+	static inline float getEffectiveMass(CPhysicsCollisionData &c, const CVector<3,float> &p_direction)
+	{
+		CVector<3,float> velocity1 = p_direction*c.physics_object1->inv_mass + ((c.world_inverse_inertia1 * (c.lever1 % p_direction)) % c.lever1);
+		CVector<3,float> velocity2 = p_direction*c.physics_object2->inv_mass + ((c.world_inverse_inertia2 * (c.lever2 % p_direction)) % c.lever2);
+
+		float delta_velocity = p_direction.dotProd(velocity1 + velocity2);
+		return (delta_velocity > 0 ? 1.0f/delta_velocity : 0.0f);
+	}
+
+#if WORKSHEET_7
+	/**
+	 * relative velocity of object 1 at the collision point which is
+	 * perpendicular to the collision normal
+	 */
+	static inline CVector<3,float> getSlidingVelocity(CPhysicsCollisionData &c)
+	{
+		CVector<3,float> closing_velocity1 = c.physics_object1->velocity + (c.physics_object1->angular_velocity % c.lever1);
+		CVector<3,float> closing_velocity2 = c.physics_object2->velocity + (c.physics_object2->angular_velocity % c.lever2);
+		CVector<3,float> relative_velocity = closing_velocity1 - closing_velocity2;
 
+		return relative_velocity - c.collision_normal*c.collision_normal.dotProd(relative_velocity);
+	}
+
+	/**
+	 * coulomb friction: the accumulated friction impulse is limited by the
+	 * static coefficient times the accumulated normal impulse. if this limit
+	 * is exceeded, the objects slide and the dynamic coefficient is used.
+	 */
+	static inline void applyFrictionImpulse(CPhysicsCollisionData &c)
+	{
+		CVector<3,float> sliding_velocity = getSlidingVelocity(c);
+		float sliding_speed = sliding_velocity.getLength();
+
+		if (sliding_speed <= 0)
+			return;
+
+		CVector<3,float> tangent = sliding_velocity*(1.0f/sliding_speed);
+
+		CVector<3,float> old_impulse = c.friction_impulse;
+		c.friction_impulse += tangent*(sliding_speed*getEffectiveMass(c, tangent));
+
+		float impulse_length = c.friction_impulse.getLength();
+		if (impulse_length > c.friction_static_coefficient*c.normal_impulse)
+			c.friction_impulse *= c.friction_dynamic_coefficient*c.normal_impulse/impulse_length;
+
+		applyImpulse(c, c.friction_impulse - old_impulse);
+	}
 #endif
 
+public:
+	/**
+	 * compute the data which stays constant while solving the collision
+	 */
+	static inline void prepareCollisionImpulse(CPhysicsCollisionData &c)
+	{
+		c.lever1 = c.collision_point1 - c.physics_object1->object->position;
+		c.lever2 = c.collision_point2 - c.physics_object2->object->position;
+
 		if ((c.physics_object1->no_rotations_and_frictions && c.physics_object2->no_rotations_and_frictions)
 #if !WORKSHEET_6
 				|| 1
 #endif
 			)
 		{
-#if WORKSHEET_3
-			//no friction or rotations, apply linear impulse
+			// no friction or rotations, apply linear impulse only
+			c.lever1.setZero();
+			c.lever2.setZero();
+			c.world_inverse_inertia1.setZero();
+			c.world_inverse_inertia2.setZero();
+		}
+		else
+		{
+			c.world_inverse_inertia1 =	c.physics_object1->object->inverse_model_matrix.getTranspose3x3()	//M^(-T)
+										* c.physics_object1->rotational_inverse_inertia						//I^(-1)
+										* c.physics_object1->object->model_matrix.getTranspose3x3();		//M^( T)
 
-#ifdef DEBUG
-			float eKin1 = 0;
-			if (c.physics_object1->inv_mass > 0) {
-				eKin1 += 0.5f / c.physics_object1->inv_mass * c.physics_object1->velocity.getLength2();
-			}
-			if (c.physics_object2->inv_mass > 0) {
-				eKin1 += 0.5f / c.physics_object2->inv_mass * c.physics_object2->velocity.getLength2();
-			}
-#endif
+			c.world_inverse_inertia2 =	c.physics_object2->object->inverse_model_matrix.getTranspose3x3()
+										* c.physics_object2->rotational_inverse_inertia
+										* c.physics_object2->object->model_matrix.getTranspose3x3();
+		}
 
+		c.normal_mass = getEffectiveMass(c, c.collision_normal);
 
+		// ropes and objects without friction only get impulses along the normal
+		if (	(c.physics_object1->no_rotations_and_frictions && c.physics_object2->no_rotations_and_frictions) ||
+				(c.physics_object1->friction_disabled && c.physics_object2->friction_disabled) ||
+				c.feature_id == COLLISION_FEATURE_HARD_CONSTRAINT
+#if !WORKSHEET_7
+				|| 1
+#endif
+			)
+		{
+			c.friction_static_coefficient = 0;
+			c.friction_dynamic_coefficient = 0;
+		}
+		else
+		{
+			c.friction_static_coefficient = (c.physics_object1->friction_static_coefficient + c.physics_object2->friction_static_coefficient)*0.5f;
+			c.friction_dynamic_coefficient = (c.physics_object1->friction_dynamic_coefficient + c.physics_object2->friction_dynamic_coefficient)*0.5f;
+		}
 
+		// velocities must fulfil seperating_velocity = -c_r * closing_velocity
+		float closing_velocity = getClosingVelocity(c);
+		float c_r = (c.physics_object1->restitution_coefficient + c.physics_object2->restitution_coefficient)/2.0;
 
-			//velocities in direction of collision normal
-			float collision_velocity1 = (-c.collision_normal).dotProd(c.physics_object1->velocity);
-			float collision_velocity2 = (-c.collision_normal).dotProd(c.physics_object2->velocity);
-			CVector<3,float> closing_velocity = c.collision_normal*(collision_velocity1 - collision_velocity2);
+		if (closing_velocity > COLLISION_RESTITUTION_VELOCITY_THRESHOLD)
+			c.target_velocity = -c_r*closing_velocity;
+		else
+			c.target_velocity = 0;
+	}
 
-			float c_r = (c.physics_object1->restitution_coefficient + c.physics_object2->restitution_coefficient)/2.0;
+	/**
+	 * apply the accumulated impulse loaded from the contact cache
+	 */
+	static inline void warmStartCollisionImpulse(CPhysicsCollisionData &c)
+	{
+		if (c.normal_impulse != 0)
+			applyImpulse(c, c.normal_impulse);
 
-			c.physics_object1->velocity -= closing_velocity*(c.physics_object1->inv_mass/(c.physics_object1->inv_mass + c.physics_object2->inv_mass))*(-(1+c_r));
-			c.physics_object2->velocity += closing_velocity*(c.physics_object2->inv_mass/(c.physics_object1->inv_mass + c.physics_object2->inv_mass))*(-(1+c_r));
+		if (c.friction_static_coefficient != 0)
+			applyImpulse(c, c.friction_impulse);
+	}
 
+	static inline void applyCollisionImpulse(CPhysicsCollisionData &c, double frame_elapsed_time)
+	{
+#if WORKSHEET_3
+#ifdef DEBUG
+		float eKin1 = 0;
+		if (c.physics_object1->inv_mass > 0) {
+			eKin1 += 0.5f / c.physics_object1->inv_mass * c.physics_object1->velocity.getLength2();
+		}
+		if (c.physics_object2->inv_mass > 0) {
+			eKin1 += 0.5f / c.physics_object2->inv_mass * c.physics_object2->velocity.getLength2();
+		}
+
+		float collision_velocity1 = (-c.collision_normal).dotProd(c.physics_object1->velocity);
+		float collision_velocity2 = (-c.collision_normal).dotProd(c.physics_object2->velocity);
+		float closing_velocity = getClosingVelocity(c);
+#endif
 
+		float impulse = (getClosingVelocity(c) - c.target_velocity)*c.normal_mass;
 
+		// the accumulated impulse may only push the objects apart
+		float old_impulse = c.normal_impulse;
+		c.normal_impulse = CMath<float>::max(old_impulse + impulse, 0.0f);
 
+		applyImpulse(c, c.normal_impulse - old_impulse);
 
 #ifdef DEBUG
-			// Check sum of all forces = 0
-			if (c.physics_object1->inv_mass > 0 && c.physics_object2->inv_mass > 0) {
-				float force1 = (-c.collision_normal.dotProd(c.physics_object1->velocity) - collision_velocity1) / (c.physics_object1->inv_mass * frame_elapsed_time);
-				float force2 = (-c.collision_normal.dotProd(c.physics_object2->velocity) - collision_velocity2) / (c.physics_object2->inv_mass * frame_elapsed_time);
-				
-				if (force1 + force2 > EPSILON * CMath<float>::max(1, CMath<float>::max(fabs(force1), fabs(force2)))) {
-					std::cout << "Sum of all forces is not 0 but " << force1 + force2 << "N!" << std::endl;
-				}
+		// Check sum of all forces = 0
+		if (c.physics_object1->isMovable() && c.physics_object2->isMovable()) {
+			float force1 = (-c.collision_normal.dotProd(c.physics_object1->velocity) - collision_velocity1) / (c.physics_object1->inv_mass * frame_elapsed_time);
+			float force2 = (-c.collision_normal.dotProd(c.physics_object2->velocity) - collision_velocity2) / (c.physics_object2->inv_mass * frame_elapsed_time);
+
+			if (force1 + force2 > EPSILON * CMath<float>::max(1, CMath<float>::max(fabs(force1), fabs(force2)))) {
+				std::cout << "Sum of all forces is not 0 but " << force1 + force2 << "N!" << std::endl;
 			}
-			
-			// Check loss in kinetic energy = expected loss due to Cr
-			float energyLoss = 0.5f * (CMath<float>::pow(c_r, 2) - 1) * CMath<float>::pow(collision_velocity1 - collision_velocity2, 2) / (c.physics_object1->inv_mass + c.physics_object2->inv_mass);
+		}
+
+		/*
+		 * Check loss in kinetic energy = work of the impulse. this is only
+		 * valid without rotations and fixed objects since neither the
+		 * rotational energy nor the velocity of fixed objects is tracked.
+		 */
+		if (	c.physics_object1->isMovable() && c.physics_object2->isMovable() &&
+				c.lever1.getLength2() == 0 && c.lever2.getLength2() == 0
+		) {
+			float energyLoss = -(c.normal_impulse - old_impulse) * (closing_velocity + getClosingVelocity(c)) * 0.5f;
 			float eKin2 = 0;
-			if (c.physics_object1->inv_mass > 0) {
-				eKin2 += 0.5f / c.physics_object1->inv_mass * c.physics_object1->velocity.getLength2();
-			}
-			if (c.physics_object2->inv_mass > 0) {
-				eKin2 += 0.5f / c.physics_object2->inv_mass * c.physics_object2->velocity.getLength2();
-			}
+			eKin2 += 0.5f / c.physics_object1->inv_mass * c.physics_object1->velocity.getLength2();
+			eKin2 += 0.5f / c.physics_object2->inv_mass * c.physics_object2->velocity.getLength2();
 
 			// Combination of absolute and relative error check to compensate big and small values of energies
 			if (fabs(eKin2 - eKin1 - energyLoss) > EPSILON * CMath<float>::max(1, CMath<float>::max(fabs(energyLoss), fabs(eKin2 - eKin1)))) {
@@ -96,76 +282,14 @@ public:
 				std::cout << "Lost energy should be " << energyLoss << "J but is " << (eKin2 - eKin1) << "J!" << std::endl;
 				std::cout << "Difference: " << fabs(eKin2 - eKin1) - fabs(energyLoss) << "J" << std::endl;
 			}
-#endif
-#endif
 		}
-		else if ((c.physics_object1->friction_disabled && c.physics_object2->friction_disabled)
-#if !WORKSHEET_7
-|| 1
 #endif
-				)
-		{
-#if WORKSHEET_6
-            CVector<3,float> lever1 = c.collision_point1 - c.physics_object1->object->position;
-            CVector<3,float> lever2 = c.collision_point2 - c.physics_object2->object->position;
-            
-            
-            CMatrix4<float> inertia_to_world1 =   c.physics_object1->object->inverse_model_matrix.getTranspose3x3()    //M^(-T)
-                                                * c.physics_object1->rotational_inverse_inertia                         //I^(-1)
-                                                * c.physics_object1->object->model_matrix.getTranspose3x3();           //M^( T)
-                                                
-            CMatrix4<float> inertia_to_world2 =   c.physics_object2->object->inverse_model_matrix.getTranspose3x3()    //M^(-T)
-                                                * c.physics_object2->rotational_inverse_inertia                         //I^(-1)
-                                                * c.physics_object2->object->model_matrix.getTranspose3x3();           //M^( T)
-                                                
-            float c_r = (c.physics_object1->restitution_coefficient + c.physics_object2->restitution_coefficient)/2.0;
-            
-            
-            
-            
-            //closing velocities
-            CVector<3,float> closing_velocity1 = c.physics_object1->velocity + (c.physics_object1->angular_velocity % lever1);
-            CVector<3,float> closing_velocity2 = c.physics_object2->velocity + (c.physics_object2->angular_velocity % lever2);
-            
-            float closing_velocity = c.collision_normal.dotProd(closing_velocity1 - closing_velocity2);
-            
-    
-            
-            
-            //seperating velocities
-            CVector<3,float> seperating_linear_velocity1 = c.collision_normal*c.physics_object1->inv_mass;
-            CVector<3,float> seperating_angular_velocity1 = inertia_to_world1 * (lever1 % c.collision_normal);
-            CVector<3,float> seperating_velocity1 = seperating_linear_velocity1 + (seperating_angular_velocity1 % lever1);
-            
-            CVector<3,float> seperating_linear_velocity2 = c.collision_normal*c.physics_object2->inv_mass;
-            CVector<3,float> seperating_angular_velocity2 = inertia_to_world2 * (lever2 % c.collision_normal);
-            CVector<3,float> seperating_velocity2 = seperating_linear_velocity2 + (seperating_angular_velocity2 % lever2);
-            
-            float delta_seperating_velocity = c.collision_normal.dotProd(seperating_velocity1 + seperating_velocity2);
-            
-            
-            
-            
-            //velocities must fullfil seperating_velocity = -c_r * closing_velocity = frac * seperating_velocity + closing_velocity
-            float frac = ((1+c_r)*closing_velocity)/delta_seperating_velocity;
-            
-            
-            
-            
-            //apply calculated impulse to objects
-            c.physics_object1->velocity -= seperating_linear_velocity1 * frac;
-            c.physics_object1->angular_velocity -= seperating_angular_velocity1 * frac;
-            
-            c.physics_object2->velocity += seperating_linear_velocity2 * frac;
-            c.physics_object2->angular_velocity += seperating_angular_velocity2 * frac;
 #endif
-		}
-		else
-		{
-#if WORKSHEET_7            
-            
+
+#if WORKSHEET_7
+		if (c.friction_static_coefficient > 0)
+			applyFrictionImpulse(c);
 #endif
-		}
 
 
 // DAMPING TEST
@@ -184,7 +308,5 @@ public:
 		if (c.physics_object2->angular_velocity.getLength() < 0.2)	c.physics_object2->angular_velocity.setZero();
 #endif
 	}
-
-
 };
 #endif
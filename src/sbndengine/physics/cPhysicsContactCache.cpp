@@ -0,0 +1,91 @@
+/*
+ * Copyright 2010 Martin Schreiber
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include "cPhysicsContactCache.hpp"
+#include <algorithm>
+
+
+/**
+ * the cached impulse is only used if the collision normal did not rotate
+ * by more than acos(CONTACT_CACHE_MIN_NORMAL_DOT) since the last timestep
+ */
+#define CONTACT_CACHE_MIN_NORMAL_DOT	0.95f
+
+
+void cPhysicsContactCache::load(std::list<CPhysicsCollisionData> &list_colliding_objects)
+{
+	cEntry key;
+
+	for (std::list<CPhysicsCollisionData>::iterator i = list_colliding_objects.begin(); i != list_colliding_objects.end(); i++)
+	{
+		CPhysicsCollisionData &c = *i;
+		c.normal_impulse = 0;
+		c.friction_impulse.setZero();
+
+		if (entries.empty())
+			continue;
+
+		key.physics_object1 = c.physics_object1;
+		key.physics_object2 = c.physics_object2;
+		key.feature_id = c.feature_id;
+
+		std::vector<cEntry>::iterator e = std::lower_bound(entries.begin(), entries.end(), key);
+
+		if (e == entries.end() || key < *e)
+			continue;
+
+		if (c.collision_normal.dotProd((*e).collision_normal) < CONTACT_CACHE_MIN_NORMAL_DOT)
+			continue;
+
+		c.normal_impulse = (*e).normal_impulse;
+
+		// remove the part of the friction impulse along the new normal
+		c.friction_impulse = (*e).friction_impulse - c.collision_normal*c.collision_normal.dotProd((*e).friction_impulse);
+	}
+}
+
+
+void cPhysicsContactCache::store(std::list<CPhysicsCollisionData> &list_colliding_objects)
+{
+	entries.clear();
+
+	for (std::list<CPhysicsCollisionData>::iterator i = list_colliding_objects.begin(); i != list_colliding_objects.end(); i++)
+	{
+		CPhysicsCollisionData &c = *i;
+
+		if (c.normal_impulse <= 0)
+			continue;
+
+		entries.push_back(cEntry());
+		cEntry &e = entries.back();
+
+		e.physics_object1 = c.physics_object1;
+		e.physics_object2 = c.physics_object2;
+		e.feature_id = c.feature_id;
+		e.collision_normal = c.collision_normal;
+		e.normal_impulse = c.normal_impulse;
+		e.friction_impulse = c.friction_impulse;
+	}
+
+	std::sort(entries.begin(), entries.end());
+}
+
+
+void cPhysicsContactCache::clear()
+{
+	entries.clear();
+}
@@ -0,0 +1,76 @@
+/*
+ * Copyright 2010 Martin Schreiber
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef CPHYSICS_CONTACT_CACHE_HPP
+#define CPHYSICS_CONTACT_CACHE_HPP
+
+#include <list>
+#include <vector>
+#include "sbndengine/physics/iPhysicsObject.hpp"
+#include "cPhysicsCollisionData.hpp"
+
+
+/**
+ * \brief storage for the accumulated impulses of the last timestep
+ *
+ * contacts are identified by both objects and the feature id computed
+ * by the intersection tests. if a contact still exists in the next
+ * timestep, its accumulated impulse is used as the initial impulse
+ * ("warm starting"). thus resting objects start with the impulse which
+ * compensates the gravitation instead of falling into the other object.
+ */
+class cPhysicsContactCache
+{
+	class cEntry
+	{
+	public:
+		iPhysicsObject *physics_object1;
+		iPhysicsObject *physics_object2;
+		unsigned int feature_id;
+
+		CVector<3,float> collision_normal;
+		float normal_impulse;
+		CVector<3,float> friction_impulse;
+
+		inline bool operator<(const cEntry &e)	const
+		{
+			if (physics_object1 != e.physics_object1)	return physics_object1 < e.physics_object1;
+			if (physics_object2 != e.physics_object2)	return physics_object2 < e.physics_object2;
+			return feature_id < e.feature_id;
+		}
+	};
+
+	/**
+	 * entries sorted by objects and feature id
+	 */
+	std::vector<cEntry> entries;
+
+public:
+	/**
+	 * set the accumulated impulse of all contacts to the one stored for
+	 * the same contact during the last call of store()
+	 */
+	void load(std::list<CPhysicsCollisionData> &list_colliding_objects);
+
+	/**
+	 * replace the cached impulses with the ones of the given contacts
+	 */
+	void store(std::list<CPhysicsCollisionData> &list_colliding_objects);
+
+	void clear();
+};
+
+#endif
@@ -16,12 +16,19 @@
 
 
 #include "cPhysicsEngine_Private.hpp"
+#include <algorithm>
 #include "sbndengine/physics/iPhysicsObject.hpp"
+#include "sbndengine/engine/cObjectStore.hpp"
 #include "sbndengine/engine/cObjectFactorySphere.hpp"
 #include "sbndengine/engine/cObjectFactoryPlane.hpp"
 #include "sbndengine/engine/cObjectFactoryBox.hpp"
 #include "libmath/CBinaryCNumbers.hpp"
 #include "cPhysicsCollisionImpulse.hpp"
+#include "cPhysicsIntegrator.hpp"
+#include "cPhysicsBroadphaseSweepAndPrune.hpp"
+#include "cPhysicsBroadphaseSpatialHash.hpp"
+#include "cPhysicsBroadphaseAABBTree.hpp"
+#include "sbndengine/physics/iPhysics.hpp"
 #include "worksheets_precompiler.hpp"
 
 
@@ -62,6 +69,28 @@
 //#define SOLVE_INTERPENETRATION_MULTIPLIER	1.01f
 #define SOLVE_INTERPENETRATION_MULTIPLIER	1.0f
 
+/**
+ * remaining interpenetration depths below this value are not resolved by
+ * further position iterations
+ */
+#define POSITION_SOLVER_TOLERANCE	0.0001f
+
+/**
+ * collision normals of a manifold whose dot product exceeds this value are
+ * resolved by the same displacement
+ */
+#define POSITION_SOLVER_SAME_NORMAL	0.9999f
+
+
+/**
+ * an object takes part in the simulation of the current timestep if it is
+ * movable and not sleeping
+ */
+static inline bool isAwake(iPhysicsObject &o)
+{
+	return o.isMovable() && !o.sleeping;
+}
+
 
 void cPhysicsEngine_Private::reset()
 {
@@ -70,22 +99,91 @@ void cPhysicsEngine_Private::reset()
 
 	// set update interval to 50 times per second
 	setUpdateInterval(1.0f/50.0f);
+	setMaximumSubsteps(5);
 
 	setMaximumIterations(10, 10);
 //	setMaximumIterations(5, 5);
 
+	setSleepingParameters(0.05f, 0.05f, 0.5f);
+
 	soft_constraint_list.clear();
 	hard_constraint_list.clear();
 	object_list.clear();
+	store_handles.clear();
 	list_colliding_objects.clear();
+	contact_cache.clear();
+	gjk_cache.clear();
+
+	broadphase->clear();
+	broadphase_pairs.clear();
+	ccd_handles.clear();
+	ccd_start_positions.clear();
+
+	simulation_thread.clearCommands();
+	object_generation++;
+
+	statistics.clear();
 }
 
 
 cPhysicsEngine_Private::cPhysicsEngine_Private()	:
+		simulation_thread(*this),
+		object_generation(0),
 		angular_damping_threshold(0.0005),
 		angular_damping_factor(0.9)
 {
+	broadphase = new cPhysicsBroadphaseAABBTree;
 	setUpdateInterval(1.0f/50.0f);
+	setMaximumSubsteps(5);
+	setSleepingParameters(0.05f, 0.05f, 0.5f);
+	next_sleeping_island_id = 0;
+}
+
+
+cPhysicsEngine_Private::~cPhysicsEngine_Private()
+{
+	simulation_thread.stop();
+	delete broadphase;
+}
+
+
+void cPhysicsEngine_Private::addObject(const iRef<iPhysicsObject> &physics_object)
+{
+	object_list.push_back(physics_object);
+	broadphase->addObject(physics_object.ref_class);
+
+	int handle = physics_object->object->store_handle;
+	store_handles.insert(std::lower_bound(store_handles.begin(), store_handles.end(), handle), handle);
+
+	// the object is drawn at its current state until the next timestep
+	cObjectStore::cChunk &c = cObjectStore::getInstance().getChunk(handle);
+	int i = cObjectStore::getIndex(handle);
+	c.previous_position[i] = c.position[i];
+	c.previous_rotation[i] = c.rotation[i];
+
+	object_generation++;
+}
+
+
+void cPhysicsEngine_Private::removeObject(const iRef<iPhysicsObject> &physics_object)
+{
+	broadphase->removeObject(physics_object.ref_class);
+	object_list.remove(physics_object);
+	physics_object->island = -1;
+
+	std::vector<int>::iterator h = std::lower_bound(store_handles.begin(), store_handles.end(), physics_object->object->store_handle);
+	if (h != store_handles.end() && *h == physics_object->object->store_handle)
+		store_handles.erase(h);
+
+	// the caches must not refer to the removed object
+	contact_cache.clear();
+	gjk_cache.clear();
+
+	// objects lying on the removed object have to fall down
+	wakeUpAll();
+
+	simulation_thread.removeCommands(physics_object.ref_class);
+	object_generation++;
 }
 
 
@@ -99,50 +197,208 @@ void cPhysicsEngine_Private::updateSoftConstraints()
 }
 
 
-void cPhysicsEngine_Private::emptyAndGetCollisions()
-{
-	list_colliding_objects.clear();
+/**
+ * number of consecutive broadphase pairs which are tested by the same thread
+ */
+#define NARROWPHASE_CHUNK_SIZE	32
 
-	/**
-	 * first of all, we search for all collisions and store them into an array
-	 */
-	list_colliding_objects.push_front(CPhysicsCollisionData());
-	CPhysicsCollisionData *cData = &list_colliding_objects.front();
+/**
+ * narrowphase job: each thread tests the chunks of pairs with the index
+ * thread_id, thread_id+number_of_threads, ... and stores the collisions to
+ * its own buffer.
+ */
+class cNarrowphaseJob	:	public cPhysicsThreadPool::cJob
+{
+	std::vector<cPhysicsBroadphasePair> &pairs;
+	std::vector<cPhysicsEngine_Private::cContactBuffer> &buffers;
+	const cPhysicsGJK::cCache &gjk_cache;
+
+public:
+	cNarrowphaseJob(
+			std::vector<cPhysicsBroadphasePair> &p_pairs,
+			std::vector<cPhysicsEngine_Private::cContactBuffer> &p_buffers,
+			const cPhysicsGJK::cCache &p_gjk_cache
+	)	:
+		pairs(p_pairs),
+		buffers(p_buffers),
+		gjk_cache(p_gjk_cache)
+	{
+	}
 
-	for (std::list<iRef<iPhysicsObject> >::iterator i1 = object_list.begin(); i1 != object_list.end(); i1++)
+	void execute(int p_thread_id, int p_number_of_threads)
 	{
-		iPhysicsObject &o1 = **i1;
+		cPhysicsEngine_Private::cContactBuffer &buffer = buffers[p_thread_id];
+		buffer.contacts.clear();
+		buffer.pair_ids.clear();
+		buffer.gjk_cache_entries.clear();
+
+		cPhysicsGJK::cContext gjk_context;
+		gjk_context.cache = &gjk_cache;
+		gjk_context.new_entries = &buffer.gjk_cache_entries;
+
+		CPhysicsCollisionData manifold[COLLISION_MAX_MANIFOLD_POINTS];
 
-		std::list<iRef<iPhysicsObject> >::iterator i2 = i1;
+		// pairs of the current chunk which passed the bounding sphere test
+		int candidates[NARROWPHASE_CHUNK_SIZE];
 
-		for (i2++; i2 != object_list.end(); i2++)
+		// index of the separating axis test of each candidate (-1 if it is no box pair)
+		int sat_index[NARROWPHASE_CHUNK_SIZE];
+
+		cPhysicsBoxBoxSAT::cBox boxes[2*NARROWPHASE_CHUNK_SIZE];
+		const cPhysicsBoxBoxSAT::cBox *boxes1[NARROWPHASE_CHUNK_SIZE];
+		const cPhysicsBoxBoxSAT::cBox *boxes2[NARROWPHASE_CHUNK_SIZE];
+		cPhysicsBoxBoxSAT::cResult sat_results[NARROWPHASE_CHUNK_SIZE];
+
+		int pairs_count = pairs.size();
+		for (int chunk_start = p_thread_id*NARROWPHASE_CHUNK_SIZE; chunk_start < pairs_count; chunk_start += p_number_of_threads*NARROWPHASE_CHUNK_SIZE)
 		{
-			iPhysicsObject &o2 = **i2;
+			int chunk_end = CMath<int>::min(chunk_start + NARROWPHASE_CHUNK_SIZE, pairs_count);
 
-			/**
-			 * first of all we check if the objects bounding spheres touch
-			 */
-			float quad_rad = o1.object->objectFactory->bounding_sphere_radius + o2.object->objectFactory->bounding_sphere_radius;
-			quad_rad *= quad_rad;
-			if ((o1.object->position - o2.object->position).getLength2() >= quad_rad)
-				continue;
+			int candidates_count = 0;
+			int box_pairs_count = 0;
+
+			for (int i = chunk_start; i < chunk_end; i++)
+			{
+				iPhysicsObject &o1 = *pairs[i].physics_object1;
+				iPhysicsObject &o2 = *pairs[i].physics_object2;
+
+				/**
+				 * sleeping objects do not move. thus there are no new collisions
+				 * with other sleeping or fixed objects.
+				 */
+				if (!isAwake(o1) && !isAwake(o2))
+					continue;
+
+				/**
+				 * first of all we check if the objects bounding spheres touch
+				 */
+				float quad_rad = o1.object->objectFactory->bounding_sphere_radius + o2.object->objectFactory->bounding_sphere_radius;
+				quad_rad *= quad_rad;
+				if ((o1.object->position - o2.object->position).getLength2() >= quad_rad)
+					continue;
+
+				sat_index[candidates_count] = -1;
+
+				if (	o1.object->objectFactory->type == iObjectFactory::TYPE_BOX &&
+						o2.object->objectFactory->type == iObjectFactory::TYPE_BOX
+				)
+				{
+					cPhysicsBoxBoxSAT::cBox *b = &boxes[box_pairs_count*2];
+					CPhysicsIntersections::getBox(o1, b[0]);
+					CPhysicsIntersections::getBox(o2, b[1]);
+					boxes1[box_pairs_count] = &b[0];
+					boxes2[box_pairs_count] = &b[1];
+
+					sat_index[candidates_count] = box_pairs_count;
+					box_pairs_count++;
+				}
+
+				candidates[candidates_count] = i;
+				candidates_count++;
+			}
 
 			/**
-			 * next we compute any intersections based on the different kinds of objects
+			 * the separating axis tests of all box pairs of the chunk are done at once
 			 */
+			cPhysicsBoxBoxSAT::test(boxes1, boxes2, box_pairs_count, sat_results);
 
-			if (!o1.isMovable() && !o2.isMovable())
-				continue;
-
-			if (CPhysicsIntersections::multiplexer(o1, o2, *cData))
+			for (int k = 0; k < candidates_count; k++)
 			{
-				list_colliding_objects.push_front(CPhysicsCollisionData());
-				cData = &list_colliding_objects.front();
+				int i = candidates[k];
+				iPhysicsObject &o1 = *pairs[i].physics_object1;
+				iPhysicsObject &o2 = *pairs[i].physics_object2;
+
+				/**
+				 * next we compute any intersections based on the different kinds of objects
+				 */
+				int manifold_points;
+				if (sat_index[k] >= 0)
+					manifold_points = CPhysicsIntersections::boxBox(o1, o2, sat_results[sat_index[k]], manifold);
+				else
+					manifold_points = CPhysicsIntersections::multiplexer(o1, o2, manifold, &gjk_context);
+
+				for (int m = 0; m < manifold_points; m++)
+				{
+					manifold[m].manifold_point = m;
+					manifold[m].manifold_points = manifold_points;
+					buffer.contacts.push_back(manifold[m]);
+					buffer.pair_ids.push_back(i);
+				}
 			}
 		}
 	}
+};
 
-	list_colliding_objects.pop_front();
+
+void cPhysicsEngine_Private::emptyAndGetCollisions()
+{
+	/**
+	 * the broadphase returns only those pairs whose bounding boxes overlap
+	 * and which contain at least one movable object
+	 */
+	broadphase->computePairs(broadphase_pairs);
+
+	getNarrowphaseCollisions();
+}
+
+
+void cPhysicsEngine_Private::getNarrowphaseCollisions()
+{
+	list_colliding_objects.clear();
+
+	/**
+	 * the pairs are tested by all threads, each one storing the collisions to
+	 * its own buffer
+	 */
+	contact_buffers.resize(thread_pool.getNumberOfThreads());
+
+	cNarrowphaseJob job(broadphase_pairs, contact_buffers, gjk_cache);
+	thread_pool.run(job);
+
+	/**
+	 * the simplices of this timestep are the start simplices of the next one
+	 */
+	gjk_cache.clear();
+	for (size_t b = 0; b < contact_buffers.size(); b++)
+		gjk_cache.insert(contact_buffers[b].gjk_cache_entries);
+	gjk_cache.sort();
+
+	/**
+	 * merge the buffers sorted by the pair index. thus the order of the
+	 * collisions does not depend on the number of threads.
+	 */
+	int buffers_count = contact_buffers.size();
+	merge_positions.assign(buffers_count, 0);
+
+	while (true)
+	{
+		int next_buffer = -1;
+		unsigned int next_pair_id = 0;
+
+		for (int b = 0; b < buffers_count; b++)
+		{
+			cContactBuffer &buffer = contact_buffers[b];
+			size_t p = merge_positions[b];
+
+			if (p < buffer.pair_ids.size() && (next_buffer < 0 || buffer.pair_ids[p] < next_pair_id))
+			{
+				next_buffer = b;
+				next_pair_id = buffer.pair_ids[p];
+			}
+		}
+
+		if (next_buffer < 0)
+			break;
+
+		// all points of the manifold of this pair
+		cContactBuffer &buffer = contact_buffers[next_buffer];
+		size_t &p = merge_positions[next_buffer];
+		while (p < buffer.pair_ids.size() && buffer.pair_ids[p] == next_pair_id)
+		{
+			list_colliding_objects.push_back(buffer.contacts[p]);
+			p++;
+		}
+	}
 }
 
 void cPhysicsEngine_Private::getHardConstraintCollisions()
@@ -154,6 +410,11 @@ void cPhysicsEngine_Private::getHardConstraintCollisions()
 	{
 		iPhysicsHardConstraint &c = **i;
 
+		iPhysicsObject *o1, *o2;
+		c.getPhysicsObjects(o1, o2);
+		if (!isAwake(*o1) && !isAwake(*o2))
+			continue;
+
 		CPhysicsCollisionData cData;
 
 		if (c.updateHardConstraintsCollisions(cData))
@@ -166,66 +427,241 @@ void cPhysicsEngine_Private::getHardConstraintCollisions()
  *
  * Resolve Interpenetrations
  */
-void resolveInterpenetration_displace(CPhysicsCollisionData &c)
+void resolveInterpenetration_displace(CPhysicsCollisionData &c, float p_interpenetration_depth)
 {
 #if WORKSHEET_2
 	float d2 = c.physics_object2->inv_mass / (c.physics_object2->inv_mass + c.physics_object1->inv_mass);
-	c.physics_object1->object->translate(c.collision_normal * (d2 - 1) * c.interpenetration_depth);
-	c.physics_object2->object->translate(c.collision_normal * d2 * c.interpenetration_depth);
-	c.physics_object1->object->updateModelMatrix();
-	c.physics_object2->object->updateModelMatrix();
+
+	/*
+	 * fixed objects are shared by islands which are solved concurrently.
+	 * they are not moved anyway, thus they are not written at all.
+	 */
+	if (c.physics_object1->isMovable())
+	{
+		iObject &o = *c.physics_object1->object;
+		o.translate(c.collision_normal * (d2 - 1) * p_interpenetration_depth);
+		iObject::updateModelMatrix(o.position, o.rotation, o.model_matrix, o.inverse_model_matrix);
+	}
+
+	if (c.physics_object2->isMovable())
+	{
+		iObject &o = *c.physics_object2->object;
+		o.translate(c.collision_normal * d2 * p_interpenetration_depth);
+		iObject::updateModelMatrix(o.position, o.rotation, o.model_matrix, o.inverse_model_matrix);
+	}
 #endif
 }
 
+
+/**
+ * interpenetration depth which is left after translating the objects
+ * since the collision was detected
+ */
+static inline float getRemainingInterpenetrationDepth(CPhysicsCollisionData &c)
+{
+	CVector<3,float> translation1 = c.physics_object1->object->position - c.detection_position1;
+	CVector<3,float> translation2 = c.physics_object2->object->position - c.detection_position2;
+
+	return c.interpenetration_depth - c.collision_normal.dotProd(translation2 - translation1);
+}
+
+
+void cPhysicsEngine_Private::resolveIslandInterpenetrations(int p_island)
+{
+	int start = island_collisions_start[p_island];
+	int end = island_collisions_start[p_island+1];
+
+	for (int i = start; i < end; i++)
+	{
+		CPhysicsCollisionData &c = *island_collisions[i];
+		c.detection_position1 = c.physics_object1->object->position;
+		c.detection_position2 = c.physics_object2->object->position;
+	}
+
+	int iteration;
+	for (iteration = 0; iteration < max_position_iterations; iteration++)
+	{
+		float max_depth = 0;
+
+		// loop over all colliding objects computed during collision pass
+		int i = start;
+		while (i < end)
+		{
+			// WORKSHEET IMPLEMENTATION STARTS HERE
+			CPhysicsCollisionData &c = *island_collisions[i];
+
+			/*
+			 * the points of a manifold usually share the collision normal,
+			 * but the points of a mesh manifold (e. g. in a corner) have the
+			 * normals of their triangles. the objects are displaced once for
+			 * each distinct normal by the largest remaining depth of the
+			 * points with this normal.
+			 */
+			for (int m = 0; m < c.manifold_points; m++)
+			{
+				CPhysicsCollisionData &cm = *island_collisions[i+m];
+
+				int k;
+				for (k = 0; k < m; k++)
+					if (island_collisions[i+k]->collision_normal.dotProd(cm.collision_normal) > POSITION_SOLVER_SAME_NORMAL)
+						break;
+				if (k < m)
+					continue;
+
+				float depth = getRemainingInterpenetrationDepth(cm);
+				for (k = m+1; k < c.manifold_points; k++)
+				{
+					CPhysicsCollisionData &ck = *island_collisions[i+k];
+					if (ck.collision_normal.dotProd(cm.collision_normal) > POSITION_SOLVER_SAME_NORMAL)
+						depth = CMath<float>::max(depth, getRemainingInterpenetrationDepth(ck));
+				}
+
+				if (depth <= POSITION_SOLVER_TOLERANCE)
+					continue;
+
+				resolveInterpenetration_displace(cm, depth);
+				max_depth = CMath<float>::max(max_depth, depth);
+			}
+			i += c.manifold_points;
+		}
+
+		if (max_depth <= POSITION_SOLVER_TOLERANCE)
+			break;
+	}
+
+	island_position_iterations[p_island] = CMath<int>::min(iteration+1, max_position_iterations);
+
+#if 1
+#ifdef DEBUG
+	if (iteration == max_position_iterations)
+	{
+		std::cout << "max position iterations (" << max_position_iterations << ") reached!" << std::endl;
+	}
+#endif
+#endif
+}
+
+
+/**
+ * solve the islands distributed round robin to the threads. the islands are
+ * sorted by their size to balance the work.
+ */
+class cIslandInterpenetrationJob	:	public cPhysicsThreadPool::cJob
+{
+	cPhysicsEngine_Private &engine;
+	std::vector<int> &island_order;
+
+public:
+	cIslandInterpenetrationJob(
+			cPhysicsEngine_Private &p_engine,
+			std::vector<int> &p_island_order
+	)	:
+		engine(p_engine),
+		island_order(p_island_order)
+	{
+	}
+
+	void execute(int p_thread_id, int p_number_of_threads)
+	{
+		for (size_t i = p_thread_id; i < island_order.size(); i += p_number_of_threads)
+			engine.resolveIslandInterpenetrations(island_order[i]);
+	}
+};
+
+
 /**
  * WORKSHEET 2, ASSIGNMENT 3
  *
  * Resolve Interpenetrations
+ *
+ * the collisions are not detected again. instead the remaining depths of the
+ * detected collisions are resolved iteratively since displacing one object
+ * may push it into another one.
+ *
+ * the islands do not share any movable object. thus they are solved
+ * concurrently without locks and the result does not depend on the number
+ * of threads.
  */
 void cPhysicsEngine_Private::resolveInterpenetrations()
 {
-	CPhysicsCollisionData iter_cdata;
+	island_position_iterations.resize(island_collisions_start.size());
 
-	// loop over all colliding objects computed during collision pass
+	cIslandInterpenetrationJob job(*this, island_order);
+	thread_pool.run(job);
 
-	for (	std::list<CPhysicsCollisionData>::iterator i = list_colliding_objects.begin();
-			i != list_colliding_objects.end();
-			i++)
+#if WORKSHEET_2
+#ifdef DEBUG
+	for (std::list<CPhysicsCollisionData>::iterator i = list_colliding_objects.begin(); i != list_colliding_objects.end(); i++)
 	{
-		// WORKSHEET IMPLEMENTATION STARTS HERE
 		CPhysicsCollisionData &c = *i;
 
-		resolveInterpenetration_displace(c);
+		if (c.manifold_point != 0 || c.feature_id == COLLISION_FEATURE_HARD_CONSTRAINT)
+			continue;
 
-#if WORKSHEET_2
-#ifdef DEBUG
 		// Check if collision was really solved
 		float quad_rad = c.physics_object1->object->objectFactory->bounding_sphere_radius + c.physics_object2->object->objectFactory->bounding_sphere_radius;
 		quad_rad *= quad_rad;
 
 		if ((c.physics_object1->object->position - c.physics_object2->object->position).getLength2() < quad_rad) {
-			if (CPhysicsIntersections::multiplexer(*c.physics_object1, *c.physics_object2, c)) {
-				if (fabs(c.interpenetration_depth) > EPSILON) {
-					std::cout << "Collision not resolved: " << c.physics_object1->object->identifier_string << " - " << c.physics_object2->object->identifier_string << " -> " << c.interpenetration_depth << std::endl;
+			CPhysicsCollisionData manifold[COLLISION_MAX_MANIFOLD_POINTS];
+			if (CPhysicsIntersections::multiplexer(*c.physics_object1, *c.physics_object2, manifold)) {
+				if (fabs(manifold[0].interpenetration_depth) > EPSILON) {
+					std::cout << "Collision not resolved: " << c.physics_object1->object->identifier_string << " - " << c.physics_object2->object->identifier_string << " -> " << manifold[0].interpenetration_depth << std::endl;
 				}
 			}
 		}
+	}
 #endif
 #endif
+}
+
+void cPhysicsEngine_Private::buildChunkMask(size_t &io_handle, bool p_awake_only, int &o_first, int &o_last)
+{
+	cObjectStore &store = cObjectStore::getInstance();
+	cObjectStore::cChunk &c = store.getChunk(store_handles[io_handle]);
+	int chunk = store_handles[io_handle] >> OBJECT_STORE_CHUNK_SHIFT;
+
+	chunk_mask.assign(OBJECT_STORE_CHUNK_SIZE*3, 0);
+	o_first = OBJECT_STORE_CHUNK_SIZE;
+	o_last = -1;
+
+	for (; io_handle < store_handles.size() && (store_handles[io_handle] >> OBJECT_STORE_CHUNK_SHIFT) == chunk; io_handle++)
+	{
+		int i = cObjectStore::getIndex(store_handles[io_handle]);
+
+		// see isAwake()
+		if (p_awake_only && (c.inv_mass[i] == 0.0f || c.sleeping[i]))
+			continue;
+
+		chunk_mask[i*3+0] = ~0u;
+		chunk_mask[i*3+1] = ~0u;
+		chunk_mask[i*3+2] = ~0u;
+
+		o_first = CMath<int>::min(o_first, i);
+		o_last = i;
 	}
 }
 
+
 void cPhysicsEngine_Private::updateConstantAcceleration()
 {
+	cObjectStore &store = cObjectStore::getInstance();
+
 	/**
 	 * first of all, we apply the gravitational force to the objects
 	 * this also initializes the acceleration for this simulation step
 	 */
-	for (std::list<iRef<iPhysicsObject> >::iterator i = object_list.begin(); i != object_list.end(); i++)
+	CVector<3,float> zero;
+
+	size_t h = 0;
+	while (h < store_handles.size())
 	{
-		iPhysicsObject &o = **i;
-		o.linear_acceleration_accumulator = gravitation_vector;
-		o.torque_accumulator.setZero();
+		int first, last;
+		cObjectStore::cChunk &c = store.getChunk(store_handles[h]);
+		buildChunkMask(h, false, first, last);
+
+		cPhysicsIntegrator::fill(c.linear_acceleration_accumulator[first].data, gravitation_vector, &chunk_mask[first*3], (last + 1 - first)*3);
+		cPhysicsIntegrator::fill(c.torque_accumulator[first].data, zero, &chunk_mask[first*3], (last + 1 - first)*3);
 	}
 }
 
@@ -237,55 +673,106 @@ void cPhysicsEngine_Private::setUpdateInterval(double p_update_time_interval, do
 	update_time_interval = p_update_time_interval;
 	timestamp_for_next_update = elapsed_time + update_time_interval;
 	simulation_timestep_size = update_time_interval;
+	interpolation_alpha = 1;
 }
 
+
+void cPhysicsEngine_Private::setMaximumSubsteps(int p_max_substeps)
+{
+	max_substeps = (p_max_substeps < 1 ? 1 : p_max_substeps);
+}
+
+
 /*
- * the seconds which elapsed during the last rendered frame are now stored to 'frame_elapsed_time'!
+ * the state of the simulation is ahead of the elapsed time: the last timestep
+ * ended at timestamp_for_next_update. the next one is due as soon as the
+ * elapsed time reaches this timestamp.
  */
-bool cPhysicsEngine_Private::updateElapsedTime(double p_elapsed_time)
+int cPhysicsEngine_Private::updateElapsedTime(double p_elapsed_time)
 {
 	if (elapsed_time < 0)
 	{
 		elapsed_time = p_elapsed_time;
 		timestamp_for_next_update = elapsed_time;
-		simulation_timestep_size = update_time_interval;
+	}
+
+	// update depending on the fps: one timestep with the seconds since the last call
+	if (update_time_interval <= 0.0)
+	{
+		simulation_timestep_size = p_elapsed_time - elapsed_time;
+		elapsed_time = p_elapsed_time;
+		return 1;
 	}
 
 	elapsed_time = p_elapsed_time;
+	simulation_timestep_size = update_time_interval;
 
-	if (update_time_interval >= 0.0)
+	if (timestamp_for_next_update > elapsed_time)
+		return 0;
+
+	int steps = (int)((elapsed_time - timestamp_for_next_update) / update_time_interval) + 1;
+
+	if (steps > max_substeps)
 	{
-		if (timestamp_for_next_update > elapsed_time)
-			return false;
+		/*
+		 * the program runs too slow to catch up: the simulation slows down
+		 * instead of spending even more time for the timesteps of the next
+		 * frame
+		 */
+		timestamp_for_next_update = elapsed_time;
+		return max_substeps;
+	}
 
-		// set next time update for every second
-		timestamp_for_next_update += update_time_interval;
+	timestamp_for_next_update += update_time_interval*steps;
+	return steps;
+}
 
-		// if the additional second of the last step is already behind (in this case the program runs really slow), use current time `value+update_time_interval`
-		if (timestamp_for_next_update < elapsed_time)
-		{
-/*
-#ifndef NDEBUG
-			std::cerr << "!!! Physic Engine time lack !!!" << std::endl;
-#endif
-*/
-			timestamp_for_next_update = elapsed_time+update_time_interval;
-		}
 
-		simulation_timestep_size = update_time_interval;
+int cPhysicsEngine_Private::updateSimulation(double p_elapsed_time)
+{
+	// check how many physics update time-steps are necessary
+	int steps = updateElapsedTime(p_elapsed_time);
+
+	for (int i = 0; i < steps; i++)
+	{
+		storePreviousState();
+		timestep();
+	}
+
+	if (update_time_interval <= 0.0)
+	{
+		interpolation_alpha = 1;
 	}
 	else
 	{
-		simulation_timestep_size = p_elapsed_time - elapsed_time;
+		interpolation_alpha = 1.0 - (timestamp_for_next_update - elapsed_time) / update_time_interval;
+		interpolation_alpha = CMath<double>::max(0.0, CMath<double>::min(1.0, interpolation_alpha));
 	}
-	return true;
+
+	return steps;
 }
 
+
 bool cPhysicsEngine_Private::simulationTimestep(double p_elapsed_time)
 {
-	// check if a physics update time-step is necessary
-	if (!updateElapsedTime(p_elapsed_time))
-		return false;
+	int steps = updateSimulation(p_elapsed_time);
+
+	updateRenderModelMatrices();
+
+	return steps > 0;
+}
+
+
+/*
+ * the runtime of the stages is accumulated in the statistics. the
+ * continuous collision detection and the update of the sleeping objects are
+ * only contained in the total time.
+ */
+void cPhysicsEngine_Private::timestep()
+{
+	double start_time = cPhysicsSimulationThread::getTime();
+	double t0 = start_time;
+	double t1;
 
 #if WORKSHEET_1
 	updateConstantAcceleration();
@@ -299,86 +786,558 @@ bool cPhysicsEngine_Private::simulationTimestep(double p_elapsed_time)
 	integrator();
 #endif
 
+	t1 = cPhysicsSimulationThread::getTime();
+	statistics.integrate_seconds += t1-t0;
+
 #if WORKSHEET_2
-	emptyAndGetCollisions();
+	continuousCollisionDetection();
+
+	t0 = cPhysicsSimulationThread::getTime();
+	broadphase->computePairs(broadphase_pairs);
+	t1 = cPhysicsSimulationThread::getTime();
+	statistics.broadphase_seconds += t1-t0;
+
+	t0 = t1;
+	getNarrowphaseCollisions();
 #endif
 
 #if WORKSHEET_3
 	getHardConstraintCollisions();
 #endif
 
+	t1 = cPhysicsSimulationThread::getTime();
+	statistics.narrowphase_seconds += t1-t0;
+
+	t0 = t1;
+	updateIslands();
+	t1 = cPhysicsSimulationThread::getTime();
+	statistics.islands_seconds += t1-t0;
+
 #if WORKSHEET_3
+	t0 = t1;
 	applyCollisionImpulse();
+	t1 = cPhysicsSimulationThread::getTime();
+	statistics.impulse_seconds += t1-t0;
 #endif
 
-	int i = 1;
 #if WORKSHEET_2
+	t0 = t1;
 	resolveInterpenetrations();
-	while (!list_colliding_objects.empty() && i < max_global_collision_solving_iterations) {
-		emptyAndGetCollisions();
-#if WORKSHEET_3
-		getHardConstraintCollisions();
+	t1 = cPhysicsSimulationThread::getTime();
+	statistics.interpenetration_seconds += t1-t0;
 #endif
-		resolveInterpenetrations();
-		i++;
-	}
+
+	updateSleeping();
+
+	statistics.total_seconds += cPhysicsSimulationThread::getTime()-start_time;
+
+	/*
+	 * workload
+	 */
+	statistics.timesteps++;
+	statistics.broadphase_pairs += broadphase_pairs.size();
+	statistics.contacts += list_colliding_objects.size();
+	statistics.islands += island_order.size();
+
+	if (!island_order.empty())
+		statistics.velocity_iterations += velocity_iterations;
+
+#if WORKSHEET_2
+	int position_iterations = 0;
+	for (std::vector<int>::iterator i = island_order.begin(); i != island_order.end(); i++)
+		position_iterations = CMath<int>::max(position_iterations, island_position_iterations[*i]);
+	statistics.position_iterations += position_iterations;
 #endif
+}
 
-#if 1
-#ifdef DEBUG
-	if (i == max_global_collision_solving_iterations-1)
+
+void cPhysicsEngine_Private::storePreviousState()
+{
+	cObjectStore &store = cObjectStore::getInstance();
+
+	for (std::vector<int>::iterator h = store_handles.begin(); h != store_handles.end(); h++)
 	{
-		std::cout << "max global collision iterations (" << max_global_collision_solving_iterations << ") reached!" << std::endl;
+		cObjectStore::cChunk &c = store.getChunk(*h);
+		int i = cObjectStore::getIndex(*h);
+
+		c.previous_position[i] = c.position[i];
+		c.previous_rotation[i] = c.rotation[i];
 	}
-#endif
-#endif
+}
+
 
-	return true;
+/**
+ * the positions are interpolated linearly, the rotations with the normalized
+ * linear interpolation of the quaternions (the rotation during one timestep
+ * is small)
+ */
+void cPhysicsEngine_Private::interpolateModelMatrix(
+		const CVector<3,float> &p_previous_position,
+		const CQuaternion<float> &p_previous_rotation,
+		const CVector<3,float> &p_position,
+		const CQuaternion<float> &p_rotation,
+		float p_alpha,
+		CMatrix4<float> &o_model_matrix
+	)
+{
+	CVector<3,float> position = p_previous_position*(1.0f-p_alpha) + p_position*p_alpha;
+
+	const CQuaternion<float> &q0 = p_previous_rotation;
+	const CQuaternion<float> &q1 = p_rotation;
+
+	// q and -q are the same rotation: interpolate along the shorter arc
+	float b = (q0.i*q1.i + q0.j*q1.j + q0.k*q1.k + q0.w*q1.w < 0 ? -p_alpha : p_alpha);
+
+	CQuaternion<float> rotation(
+			q0.i*(1.0f-p_alpha) + q1.i*b,
+			q0.j*(1.0f-p_alpha) + q1.j*b,
+			q0.k*(1.0f-p_alpha) + q1.k*b,
+			q0.w*(1.0f-p_alpha) + q1.w*b
+		);
+	rotation.normalize();
+
+	iObject::updateModelMatrix(position, rotation, o_model_matrix);
 }
 
 
+/**
+ * the rendered frame lies between the states before and after the last
+ * timestep
+ */
+void cPhysicsEngine_Private::updateRenderModelMatrices()
+{
+	cObjectStore &store = cObjectStore::getInstance();
+
+	float a = (float)interpolation_alpha;
+
+	for (std::vector<int>::iterator h = store_handles.begin(); h != store_handles.end(); h++)
+	{
+		cObjectStore::cChunk &c = store.getChunk(*h);
+		int i = cObjectStore::getIndex(*h);
+
+		if (a >= 1.0f || c.inv_mass[i] == 0.0f)
+		{
+			c.render_model_matrix[i] = c.model_matrix[i];
+			continue;
+		}
+
+		interpolateModelMatrix(c.previous_position[i], c.previous_rotation[i], c.position[i], c.rotation[i], a, c.render_model_matrix[i]);
+	}
+}
+
 
 void cPhysicsEngine_Private::integrator()
 {
-	for (std::list<iRef<iPhysicsObject> >::iterator i = object_list.begin(); i != object_list.end(); i++)
+	cObjectStore &store = cObjectStore::getInstance();
+
+	/*
+	 * positions at the beginning of the timestep for the continuous
+	 * collision detection
+	 */
+	ccd_handles.clear();
+	ccd_start_positions.clear();
+
+	for (std::vector<int>::iterator h = store_handles.begin(); h != store_handles.end(); h++)
 	{
-		iPhysicsObject &o = **i;
+		cObjectStore::cChunk &c = store.getChunk(*h);
+		int i = cObjectStore::getIndex(*h);
+
+		if (c.continuous_collision_detection[i] && c.inv_mass[i] != 0.0f && !c.sleeping[i])
+		{
+			ccd_handles.push_back(*h);
+			ccd_start_positions.push_back(c.position[i]);
+		}
+	}
 
+#if WORKSHEET_1
+	/*
+	 * linear movement of the awake objects of each chunk at once
+	 */
+	size_t h = 0;
+	while (h < store_handles.size())
+	{
+		int first, last;
+		cObjectStore::cChunk &c = store.getChunk(store_handles[h]);
+		buildChunkMask(h, true, first, last);
 
-		if (!o.isMovable())
+		if (first > last)
 			continue;
 
-#if WORKSHEET_1
-	o.velocity += o.linear_acceleration_accumulator * simulation_timestep_size;
-	o.object->position += (o.velocity + o.linear_acceleration_accumulator * simulation_timestep_size) * simulation_timestep_size;
+		cPhysicsIntegrator::integrateLinear(
+				c.velocity[first].data,
+				c.position[first].data,
+				c.linear_acceleration_accumulator[first].data,
+				&chunk_mask[first*3],
+				(last + 1 - first)*3,
+				simulation_timestep_size
+			);
+	}
 #endif
 
+	for (std::vector<int>::iterator h = store_handles.begin(); h != store_handles.end(); h++)
+	{
+		cObjectStore::cChunk &c = store.getChunk(*h);
+		int i = cObjectStore::getIndex(*h);
+
+		// see isAwake()
+		if (c.inv_mass[i] == 0.0f || c.sleeping[i])
+			continue;
+
 #if WORKSHEET_6
-		CVector<3, float> angular_acceleration = o.object->inverse_model_matrix.getTranspose() * o.rotational_inverse_inertia * o.object->model_matrix.getTranspose() * o.torque_accumulator;
-		o.angular_velocity += angular_acceleration * simulation_timestep_size;
+		CVector<3, float> angular_acceleration = c.inverse_model_matrix[i].getTranspose() * c.rotational_inverse_inertia[i] * c.model_matrix[i].getTranspose() * c.torque_accumulator[i];
+		c.angular_velocity[i] += angular_acceleration * simulation_timestep_size;
 
-		float theta = (o.angular_velocity + angular_acceleration * simulation_timestep_size).getLength() * simulation_timestep_size;
+		float theta = (c.angular_velocity[i] + angular_acceleration * simulation_timestep_size).getLength() * simulation_timestep_size;
 
 		if (theta != 0) {
-			CVector<3, float> axis = o.angular_velocity.getNormalized();
+			CVector<3, float> axis = c.angular_velocity[i].getNormalized();
 
-			o.object->rotate(axis, -theta);
+			c.rotation[i].rotatePost(axis, -theta);
 		}
 #endif
 
-		o.object->updateModelMatrix();
+		iObject::updateModelMatrix(c.position[i], c.rotation[i], c.model_matrix[i], c.inverse_model_matrix[i]);
+	}
+}
+
+
+/**
+ * the spheres with continuous collision detection are swept from their start
+ * positions to their new positions. a sphere which hits a plane or a box on
+ * its way is moved back to the time of impact, thus the contact is found by
+ * the discrete collision detection and the impulses let the sphere bounce
+ * instead of tunneling through thin objects.
+ *
+ * the remaining movement of the timestep is dropped. the other objects are
+ * tested at their new positions.
+ */
+void cPhysicsEngine_Private::continuousCollisionDetection()
+{
+	cObjectStore &store = cObjectStore::getInstance();
+
+	for (size_t k = 0; k < ccd_handles.size(); k++)
+	{
+		iObject &object = *store.getChunk(ccd_handles[k]).objects[cObjectStore::getIndex(ccd_handles[k])];
+		iPhysicsObject &physics_object = *static_cast<iPhysicsObject*>(object.physics_engine_ptr);
+
+		if (object.objectFactory->type != iObjectFactory::TYPE_SPHERE)
+			continue;
+
+		CVector<3,float> &start_position = ccd_start_positions[k];
+		CVector<3,float> motion = object.position - start_position;
+
+		/*
+		 * the discrete tests find all contacts of spheres which moved less
+		 * than their radius
+		 */
+		float radius = static_cast<cObjectFactorySphere *>(&object.objectFactory.getClass())->radius;
+		if (motion.getLength2() <= radius*radius)
+			continue;
+
+		CVector<3,float> min, max;
+		for (int a = 0; a < 3; a++)
+		{
+			min[a] = CMath<float>::min(start_position[a], object.position[a]) - radius;
+			max[a] = CMath<float>::max(start_position[a], object.position[a]) + radius;
+		}
+
+		ccd_candidates.clear();
+		broadphase->query(min, max, ccd_candidates);
+
+		float time_of_impact = 1.0f;
+		for (std::vector<iPhysicsObject*>::iterator i = ccd_candidates.begin(); i != ccd_candidates.end(); i++)
+		{
+			if (*i == &physics_object)
+				continue;
+
+			float t = CPhysicsIntersections::sphereTimeOfImpact(physics_object, start_position, **i);
+			if (t < time_of_impact)
+				time_of_impact = t;
+		}
+
+		if (time_of_impact < 1.0f)
+		{
+			object.position = start_position + motion*time_of_impact;
+			iObject::updateModelMatrix(object.position, object.rotation, object.model_matrix, object.inverse_model_matrix);
+		}
 	}
 }
 
 
+void cPhysicsEngine_Private::applyIslandCollisionImpulse(int p_island)
+{
+	int start = island_collisions_start[p_island];
+	int end = island_collisions_start[p_island+1];
+
+	/*
+	 * the points of a contact manifold are stored consecutively. thus each
+	 * manifold is solved as one unit before continuing with the next pair.
+	 *
+	 * the closing velocities have to be computed before any impulse is applied
+	 */
+	for (int i = start; i < end; i++)
+		CPhysicsCollisionImpulse::prepareCollisionImpulse(*island_collisions[i]);
+
+	for (int i = start; i < end; i++)
+		CPhysicsCollisionImpulse::warmStartCollisionImpulse(*island_collisions[i]);
+
+	for (int iteration = 0; iteration < velocity_iterations; iteration++)
+		for (int i = start; i < end; i++)
+			CPhysicsCollisionImpulse::applyCollisionImpulse(*island_collisions[i], simulation_timestep_size);
+}
+
+
+class cIslandImpulseJob	:	public cPhysicsThreadPool::cJob
+{
+	cPhysicsEngine_Private &engine;
+	std::vector<int> &island_order;
+
+public:
+	cIslandImpulseJob(
+			cPhysicsEngine_Private &p_engine,
+			std::vector<int> &p_island_order
+	)	:
+		engine(p_engine),
+		island_order(p_island_order)
+	{
+	}
+
+	void execute(int p_thread_id, int p_number_of_threads)
+	{
+		for (size_t i = p_thread_id; i < island_order.size(); i += p_number_of_threads)
+			engine.applyIslandCollisionImpulse(island_order[i]);
+	}
+};
+
+
+/**
+ * the impulses of the islands are computed concurrently. the collisions of
+ * one island are always solved in the same order by one thread.
+ */
 void cPhysicsEngine_Private::applyCollisionImpulse()
 {
-	for (std::list<CPhysicsCollisionData>::iterator i = list_colliding_objects.begin(); i != list_colliding_objects.end(); i++)
+	contact_cache.load(list_colliding_objects);
+
+	cIslandImpulseJob job(*this, island_order);
+	thread_pool.run(job);
+
+	contact_cache.store(list_colliding_objects);
+}
+
+
+void cPhysicsEngine_Private::updateIslands()
+{
+	int count = islands.build(object_list, list_colliding_objects, soft_constraint_list, hard_constraint_list);
+
+	island_awake.assign(count, false);
+
+	partitionCollisions();
+
+	bool sleeping_objects = false;
+	for (std::list<iRef<iPhysicsObject> >::iterator i = object_list.begin(); i != object_list.end(); i++)
 	{
-		CPhysicsCollisionData &c = *i;
+		iPhysicsObject &o = **i;
+		if (o.island < 0)
+			continue;
 
-		CPhysicsCollisionImpulse::applyCollisionImpulse(c, simulation_timestep_size);
+		if (o.sleeping)
+			sleeping_objects = true;
+		else
+			island_awake[o.island] = true;
 	}
+
+	if (!sleeping_objects)
+		return;
+
+	/*
+	 * a sleeping object in an island with an object which is awake was touched
+	 * by this object. the whole island with which the object was sent to sleep
+	 * is woken up.
+	 */
+	std::vector<unsigned int> wake_up_ids;
+	for (std::list<iRef<iPhysicsObject> >::iterator i = object_list.begin(); i != object_list.end(); i++)
+	{
+		iPhysicsObject &o = **i;
+		if (o.island >= 0 && o.sleeping && island_awake[o.island])
+			wake_up_ids.push_back(o.sleeping_island_id);
+	}
+
+	if (wake_up_ids.empty())
+		return;
+
+	std::sort(wake_up_ids.begin(), wake_up_ids.end());
+
+	for (std::list<iRef<iPhysicsObject> >::iterator i = object_list.begin(); i != object_list.end(); i++)
+	{
+		iPhysicsObject &o = **i;
+		if (o.sleeping && std::binary_search(wake_up_ids.begin(), wake_up_ids.end(), o.sleeping_island_id))
+		{
+			o.wakeUp();
+
+			// the woken up objects are added to the island which woke them up
+			if (o.island >= 0)
+				island_awake[o.island] = true;
+		}
+	}
+}
+
+
+/**
+ * island of a collision. the movable objects of a collision are always in
+ * the same island.
+ */
+static inline int getCollisionIsland(CPhysicsCollisionData &c)
+{
+	return (c.physics_object1->island >= 0 ? c.physics_object1->island : c.physics_object2->island);
+}
+
+
+static inline bool islandLarger(const std::pair<int,int> &a, const std::pair<int,int> &b)
+{
+	return a.first > b.first;
+}
+
+
+void cPhysicsEngine_Private::partitionCollisions()
+{
+	island_index.assign(island_awake.size(), -1);
+	island_collisions_start.clear();
+
+	/*
+	 * number the islands with collisions in the order of their first collision
+	 * and count the collisions of each island
+	 */
+	std::list<CPhysicsCollisionData>::iterator i;
+	for (i = list_colliding_objects.begin(); i != list_colliding_objects.end(); i++)
+	{
+		int island = getCollisionIsland(*i);
+
+		// collisions between fixed objects can not be resolved
+		if (island < 0)
+			continue;
+
+		if (island_index[island] < 0)
+		{
+			island_index[island] = island_collisions_start.size();
+			island_collisions_start.push_back(0);
+		}
+		island_collisions_start[island_index[island]]++;
+	}
+
+	int islands_count = island_collisions_start.size();
+
+	island_sizes.resize(islands_count);
+	for (int k = 0; k < islands_count; k++)
+		island_sizes[k] = std::pair<int,int>(island_collisions_start[k], k);
+
+	// end of the range of each island
+	for (int k = 1; k < islands_count; k++)
+		island_collisions_start[k] += island_collisions_start[k-1];
+
+	int collisions_count = (islands_count > 0 ? island_collisions_start.back() : 0);
+	island_collisions.resize(collisions_count);
+
+	/*
+	 * fill the ranges backwards to keep the order of the collisions. afterwards
+	 * island_collisions_start stores the start of each range.
+	 */
+	std::list<CPhysicsCollisionData>::reverse_iterator r;
+	for (r = list_colliding_objects.rbegin(); r != list_colliding_objects.rend(); r++)
+	{
+		int island = getCollisionIsland(*r);
+		if (island < 0)
+			continue;
+
+		int &position = island_collisions_start[island_index[island]];
+		position--;
+		island_collisions[position] = &*r;
+	}
+	island_collisions_start.push_back(collisions_count);
+
+	// the largest islands are distributed to the threads first
+	std::stable_sort(island_sizes.begin(), island_sizes.end(), islandLarger);
+
+	island_order.resize(islands_count);
+	for (int k = 0; k < islands_count; k++)
+		island_order[k] = island_sizes[k].second;
+}
+
+
+void cPhysicsEngine_Private::updateSleeping()
+{
+	if (sleep_time_threshold <= 0)
+		return;
+
+	island_sleep_time.assign(island_awake.size(), CMath<float>::max());
+
+	float linear_threshold2 = sleep_linear_velocity_threshold*sleep_linear_velocity_threshold;
+	float angular_threshold2 = sleep_angular_velocity_threshold*sleep_angular_velocity_threshold;
+
+	std::list<iRef<iPhysicsObject> >::iterator i;
+
+	for (i = object_list.begin(); i != object_list.end(); i++)
+	{
+		iPhysicsObject &o = **i;
+		if (o.island < 0 || o.sleeping)
+			continue;
+
+		if (	!o.sleeping_allowed ||
+				o.velocity.getLength2() > linear_threshold2 ||
+				o.angular_velocity.getLength2() > angular_threshold2
+		)
+			o.sleep_time = 0;
+		else
+			o.sleep_time += simulation_timestep_size;
+
+		island_sleep_time[o.island] = CMath<float>::min(island_sleep_time[o.island], o.sleep_time);
+	}
+
+	/*
+	 * all objects of an island get the same sleeping island id
+	 */
+	sleeping_island_ids.assign(island_awake.size(), 0);
+
+	for (i = object_list.begin(); i != object_list.end(); i++)
+	{
+		iPhysicsObject &o = **i;
+		if (o.island < 0 || o.sleeping || island_sleep_time[o.island] < sleep_time_threshold)
+			continue;
+
+		if (sleeping_island_ids[o.island] == 0)
+		{
+			next_sleeping_island_id++;
+			if (next_sleeping_island_id == 0)
+				next_sleeping_island_id++;
+			sleeping_island_ids[o.island] = next_sleeping_island_id;
+		}
+
+		o.sleeping = true;
+		o.sleeping_island_id = sleeping_island_ids[o.island];
+		o.velocity.setZero();
+		o.angular_velocity.setZero();
+	}
+}
+
+
+void cPhysicsEngine_Private::wakeUpAll()
+{
+	for (std::list<iRef<iPhysicsObject> >::iterator i = object_list.begin(); i != object_list.end(); i++)
+		(*i)->wakeUp();
+}
+
+
+void cPhysicsEngine_Private::setSleepingParameters(
+		float p_linear_velocity_threshold,
+		float p_angular_velocity_threshold,
+		float p_time_threshold
+		)
+{
+	sleep_linear_velocity_threshold = p_linear_velocity_threshold;
+	sleep_angular_velocity_threshold = p_angular_velocity_threshold;
+	sleep_time_threshold = p_time_threshold;
+
+	if (sleep_time_threshold <= 0)
+		wakeUpAll();
 }
 
 
@@ -388,6 +1347,9 @@ void cPhysicsEngine_Private::addImpulseToObjectAtPoint(
 		const CVector<3,float> &world_impulse			///< directed impulse
 		)
 {
+	// the island of the object is woken up with it during the next timestep
+	physicsObject.wakeUp();
+
 	CVector<3,float> world_lever_arm = world_impulse_point - physicsObject.object->position;
 	CVector<3,float> world_lever_arm_normalized = world_lever_arm.getNormalized();
 
@@ -408,10 +1370,48 @@ void cPhysicsEngine_Private::addImpulseToObjectAtPoint(
 }
 
 
-void cPhysicsEngine_Private::setMaximumIterations(int p_max_global_iterations, int p_max_local_iterations)
+void cPhysicsEngine_Private::setMaximumIterations(int p_max_position_iterations, int p_velocity_iterations)
+{
+	max_position_iterations = p_max_position_iterations;
+	velocity_iterations = p_velocity_iterations;
+}
+
+
+void cPhysicsEngine_Private::setNumberOfThreads(int p_number_of_threads)
 {
-	max_global_collision_solving_iterations = p_max_global_iterations;
-	max_local_collision_solving_iterations = p_max_local_iterations;
+	thread_pool.setNumberOfThreads(p_number_of_threads);
+}
+
+
+void cPhysicsEngine_Private::setBroadphase(int p_broadphase_type)
+{
+	cPhysicsBroadphase *new_broadphase;
+
+	switch(p_broadphase_type)
+	{
+		case iPhysics::BROADPHASE_SWEEP_AND_PRUNE:
+			new_broadphase = new cPhysicsBroadphaseSweepAndPrune;
+			break;
+
+		case iPhysics::BROADPHASE_SPATIAL_HASH:
+			new_broadphase = new cPhysicsBroadphaseSpatialHash;
+			break;
+
+		case iPhysics::BROADPHASE_AABB_TREE:
+			new_broadphase = new cPhysicsBroadphaseAABBTree;
+			break;
+
+		default:
+			std::cerr << "unknown broadphase type " << p_broadphase_type << std::endl;
+			return;
+	}
+
+	delete broadphase;
+	broadphase = new_broadphase;
+
+	// insert the objects in the same order to keep the order of the collision tests
+	for (std::list<iRef<iPhysicsObject> >::iterator i = object_list.begin(); i != object_list.end(); i++)
+		broadphase->addObject((*i).ref_class);
 }
 
 
@@ -431,5 +1431,6 @@ iRef<iPhysicsObject> cPhysicsEngine_Private::findPhysicsObjectByIdentifierString
 void cPhysicsEngine_Private::detectAndResolveInterpenetrations()
 {
 	emptyAndGetCollisions();
+	updateIslands();
 	resolveInterpenetrations();
 }
@@ -19,9 +19,16 @@
 
 #include <list>
 #include "cPhysicsIntersections.hpp"
+#include "cPhysicsBroadphase.hpp"
+#include "cPhysicsContactCache.hpp"
+#include "cPhysicsGJK.hpp"
+#include "cPhysicsIslands.hpp"
+#include "cPhysicsThreadPool.hpp"
+#include "cPhysicsSimulationThread.hpp"
 #include "sbndengine/physics/iPhysicsHardConstraint.hpp"
 #include "sbndengine/physics/iPhysicsObject.hpp"
 #include "sbndengine/physics/iPhysicsSoftConstraint.hpp"
+#include "sbndengine/physics/iPhysicsStatistics.hpp"
 #include "libmath/CVector.hpp"
 #include "libmath/CMath.hpp"
 #include <assert.h>
@@ -32,6 +39,7 @@ class cPhysicsEngine_Private
 {
 	friend class iPhysics;
 	friend class iPhysicsDebug;
+	friend class cPhysicsSimulationThread;
 
 	/// the time interval when the next simulation step is done
 	double update_time_interval;
@@ -43,29 +51,132 @@ class cPhysicsEngine_Private
 	double elapsed_time;
 
 	/**
-	 * maximum number of global iterations to solve the collisions
+	 * maximum number of fixed timesteps done by one call of
+	 * simulationTimestep(). if the simulation falls further behind, the
+	 * remaining time is dropped.
+	 */
+	int max_substeps;
+
+	/**
+	 * position of the rendered frame between the states before (0) and after
+	 * (1) the last timestep
+	 */
+	double interpolation_alpha;
+
+	/**
+	 * maximum number of iterations over all collisions to resolve the
+	 * interpenetrations
 	 *
-	 * this are the collisions after each round of interpenetration solving
-	 * if all local iterations between objects have been solved
+	 * the collisions are detected only once per timestep. each iteration
+	 * displaces the objects by the interpenetration depths which are left
+	 * after the previous iteration.
 	 */
-	int max_global_collision_solving_iterations;
+	int max_position_iterations;
 
 	/**
-	 * maximum number of local iterations to solve the collisions
+	 * number of iterations over all collisions to compute the impulses
 	 *
-	 * this are the maximum number of iterations to solve local
-	 * collisions
+	 * the impulses of all collisions are applied sequentially. thus the
+	 * impulse of one collision changes the velocities of other collisions
+	 * which are solved again in the next iteration.
 	 */
-	int max_local_collision_solving_iterations;
+	int velocity_iterations;
 
 	std::list<CPhysicsCollisionData> list_colliding_objects;
 
+	/**
+	 * accumulated collision impulses of the last timestep
+	 */
+	cPhysicsContactCache contact_cache;
+
+	/**
+	 * GJK simplices of the last timestep
+	 */
+	cPhysicsGJK::cCache gjk_cache;
+
 
 	/**
 	 * list with objects which are simulated with the physics engine
 	 */
 	std::list<iRef<iPhysicsObject> > object_list;
 
+	/**
+	 * handles of the objects in cObjectStore (sorted). the integrator iterates
+	 * over the handles to access the object states in the order of the memory.
+	 */
+	std::vector<int> store_handles;
+
+	/**
+	 * temporary storage for the integrator: ~0 for each float of the vectors
+	 * of the objects in one chunk of cObjectStore which are updated
+	 */
+	std::vector<unsigned int> chunk_mask;
+
+	/**
+	 * broadphase to find the pairs of objects which may collide
+	 */
+	cPhysicsBroadphase *broadphase;
+
+	/**
+	 * pairs found by the broadphase during the last collision detection
+	 */
+	std::vector<cPhysicsBroadphasePair> broadphase_pairs;
+
+	/**
+	 * handles and positions at the beginning of the timestep of the awake
+	 * objects with continuous collision detection
+	 */
+	std::vector<int> ccd_handles;
+	std::vector<CVector<3,float> > ccd_start_positions;
+
+	/**
+	 * temporary storage for the objects along the path of one fast object
+	 */
+	std::vector<iPhysicsObject*> ccd_candidates;
+
+public:
+	/**
+	 * collisions found by one thread of the narrowphase
+	 */
+	class cContactBuffer
+	{
+	public:
+		std::vector<CPhysicsCollisionData> contacts;
+
+		// index of the broadphase pair for each collision (ascending)
+		std::vector<unsigned int> pair_ids;
+
+		// simplices of the pairs tested with GJK
+		std::vector<cPhysicsGJK::cCacheEntry> gjk_cache_entries;
+	};
+
+private:
+	/**
+	 * threads used for the collision detection and the collision solver
+	 */
+	cPhysicsThreadPool thread_pool;
+
+	/**
+	 * optional thread which does the timesteps independent of the rendering
+	 */
+	cPhysicsSimulationThread simulation_thread;
+
+	/**
+	 * incremented whenever objects are added or removed. the frames
+	 * published by the simulation thread are only used for the same objects.
+	 */
+	unsigned int object_generation;
+
+	/**
+	 * one buffer for each thread
+	 */
+	std::vector<cContactBuffer> contact_buffers;
+
+	/**
+	 * temporary storage for the merge of the contact buffers
+	 */
+	std::vector<size_t> merge_positions;
+
 	/**
 	 * list with soft contact constraints
 	 */
@@ -78,6 +189,76 @@ class cPhysicsEngine_Private
 
 	CVector<3,float> gravitation_vector;
 
+	/**
+	 * simulation islands of the current timestep
+	 */
+	cPhysicsIslands islands;
+
+	/**
+	 * temporary storage for each island: true, if one object is awake
+	 */
+	std::vector<bool> island_awake;
+
+	/**
+	 * temporary storage for each island: minimum sleep time of all objects
+	 */
+	std::vector<float> island_sleep_time;
+
+	/**
+	 * temporary storage for each island: id for the objects sent to sleep
+	 */
+	std::vector<unsigned int> sleeping_island_ids;
+
+	/**
+	 * collisions sorted by islands to solve the islands concurrently.
+	 *
+	 * the collisions of island i are stored in the range
+	 * [island_collisions_start[i], island_collisions_start[i+1]) in the same
+	 * order as in list_colliding_objects.
+	 */
+	std::vector<CPhysicsCollisionData*> island_collisions;
+	std::vector<int> island_collisions_start;
+
+	/**
+	 * islands with collisions sorted by decreasing number of collisions
+	 */
+	std::vector<int> island_order;
+
+	/**
+	 * temporary storage for each island with collisions: number of collisions
+	 * and island
+	 */
+	std::vector<std::pair<int,int> > island_sizes;
+
+	/**
+	 * temporary storage for each island with collisions: iterations done to
+	 * resolve the interpenetrations
+	 */
+	std::vector<int> island_position_iterations;
+
+	/**
+	 * accumulated runtime and workload of the timesteps
+	 */
+	iPhysicsStatistics statistics;
+
+	/**
+	 * temporary storage for each object index: island with collisions or -1
+	 */
+	std::vector<int> island_index;
+
+	/**
+	 * sleeping parameters: islands whose objects move slower than the
+	 * velocity thresholds for sleep_time_threshold seconds are sent to sleep
+	 */
+	float sleep_linear_velocity_threshold;
+	float sleep_angular_velocity_threshold;
+	float sleep_time_threshold;
+
+	/**
+	 * id for the next island which is sent to sleep
+	 */
+	unsigned int next_sleeping_island_id;
+
 	/**
 	 * dampings
 	 */
@@ -89,6 +270,17 @@ public:
 	double simulation_timestep_size;
 
 	cPhysicsEngine_Private();
+	~cPhysicsEngine_Private();
+
+	/**
+	 * add an object to the simulation
+	 */
+	void addObject(const iRef<iPhysicsObject> &physics_object);
+
+	/**
+	 * remove an object from the simulation
+	 */
+	void removeObject(const iRef<iPhysicsObject> &physics_object);
 
 	bool getCollisions_objectMultiplexer(iPhysicsObject &physics_object1, iPhysicsObject &physics_object2, CPhysicsCollisionData &collisionData);
 
@@ -108,17 +300,60 @@ public:
 	 */
 	void emptyAndGetCollisions();
 
+	/**
+	 * get the collisions of the pairs found by the broadphase
+	 */
+	void getNarrowphaseCollisions();
+
 
 	/**
 	 * updates the acceleration data of all physical objects
 	 */
 	void updateConstantAcceleration();
 
+	/**
+	 * set chunk_mask for the objects of the chunk of store_handles[io_handle]
+	 *
+	 * io_handle is advanced to the first handle of the next chunk. o_first and
+	 * o_last are set to the first and the last index which is masked.
+	 */
+	void buildChunkMask(size_t &io_handle, bool p_awake_only, int &o_first, int &o_last);
+
 	/**
 	 * update the object position and rotations
 	 */
 	void integrator();
 
+	/**
+	 * store the positions and rotations at the beginning of a timestep
+	 */
+	void storePreviousState();
+
+	/**
+	 * interpolate the render model matrices of the objects with
+	 * interpolation_alpha
+	 */
+	void updateRenderModelMatrices();
+
+	/**
+	 * compute the model matrix of the state at p_alpha between the states
+	 * before and after a timestep
+	 */
+	static void interpolateModelMatrix(
+			const CVector<3,float> &p_previous_position,
+			const CQuaternion<float> &p_previous_rotation,
+			const CVector<3,float> &p_position,
+			const CQuaternion<float> &p_rotation,
+			float p_alpha,
+			CMatrix4<float> &o_model_matrix
+		);
+
+	/**
+	 * move the spheres with continuous collision detection back to the time
+	 * of their first impact during the integration
+	 */
+	void continuousCollisionDetection();
+
 	/**
 	 * apply the collision impulses
 	 */
@@ -129,6 +364,46 @@ public:
 	 */
 	void resolveInterpenetrations();
 
+	/**
+	 * apply the collision impulses of one island
+	 */
+	void applyIslandCollisionImpulse(int p_island);
+
+	/**
+	 * resolve the interpenetrations of one island
+	 */
+	void resolveIslandInterpenetrations(int p_island);
+
+	/**
+	 * compute the simulation islands and wake up all islands which contain
+	 * an object which is awake
+	 */
+	void updateIslands();
+
+	/**
+	 * sort the collisions by the islands computed by updateIslands()
+	 */
+	void partitionCollisions();
+
+	/**
+	 * send the islands to sleep which were at rest for long enough
+	 */
+	void updateSleeping();
+
+	/**
+	 * wake up all sleeping objects
+	 */
+	void wakeUpAll();
+
+	/**
+	 * setup the thresholds to send objects to sleep
+	 */
+	void setSleepingParameters(
+			float p_linear_velocity_threshold,	///< maximum linear velocity of sleeping objects
+			float p_angular_velocity_threshold,	///< maximum angular velocity of sleeping objects
+			float p_time_threshold				///< seconds to wait until objects are sent to sleep (<= 0 disables sleeping)
+			);
+
 	void clear();
 
 	/**
@@ -146,18 +421,53 @@ public:
 			double p_elapsed_seconds = -1		///< the elapsed seconds so far
 			);
 
-	bool updateElapsedTime(double p_elapsed_time);
+	/**
+	 * setup the maximum number of fixed timesteps per call of
+	 * simulationTimestep()
+	 */
+	void setMaximumSubsteps(int p_max_substeps);
+
+	/**
+	 * advance the elapsed time
+	 *
+	 * \return	number of timesteps which are due
+	 */
+	int updateElapsedTime(double p_elapsed_time);
 
 	/**
-	 * do one timestep
+	 * do one timestep of simulation_timestep_size seconds
+	 */
+	void timestep();
+
+	/**
+	 * do all timesteps which are due and update interpolation_alpha
+	 *
+	 * \return	number of timesteps
+	 */
+	int updateSimulation(double p_elapsed_time);
+
+	/**
+	 * do all timesteps which are due and interpolate the render model
+	 * matrices
 	 *
 	 * \param p_elapsed_seconds	elapsed seconds since start of simulation
 	 *
-	 * \return	true, if a simulation step was done
+	 * \return	true, if at least one simulation step was done
 	 */
 	bool simulationTimestep(double p_elapsed_seconds);
 
-	void setMaximumIterations(int p_max_global_iterations, int p_max_local_iterations);
+	void setMaximumIterations(int p_max_position_iterations, int p_velocity_iterations);
+
+	/**
+	 * set the number of threads used for the collision detection and the
+	 * collision solver (0 = one thread for each processor)
+	 */
+	void setNumberOfThreads(int p_number_of_threads);
+
+	/**
+	 * replace the broadphase and insert all objects into the new one
+	 */
+	void setBroadphase(int p_broadphase_type);
 
 	void addImpulseToObjectAtPoint(
 			iPhysicsObject &physicsObject,					///< the object itself
@@ -0,0 +1,496 @@
+/*
+ * Copyright 2010 Martin Schreiber
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "cPhysicsGJK.hpp"
+#include "sbndengine/engine/iObjectFactory.hpp"
+#include <algorithm>
+
+
+/**
+ * GJK stops if the search direction gets shorter than this (the origin is
+ * on the boundary of the simplex, thus the objects only touch)
+ */
+#define GJK_MIN_DIRECTION_LENGTH2	1e-12f
+
+/**
+ * EPA polytope sizes. the polytope is convex, thus there are at most
+ * 2*vertices-4 faces.
+ */
+#define EPA_MAX_VERTICES			(4+EPA_MAX_ITERATIONS)
+#define EPA_MAX_FACES				(2*EPA_MAX_VERTICES)
+
+/**
+ * minimum length of the cross product of 2 face edges
+ */
+#define EPA_MIN_FACE_NORMAL_LENGTH	1e-10f
+
+
+typedef CVector<3,float> Vector;
+
+
+void cPhysicsGJK::support(iPhysicsObject &o1, iPhysicsObject &o2, const Vector &p_direction, cVertex &o_vertex)
+{
+	Vector direction = rotateToWorld(o1, p_direction);
+
+	o_vertex.point1 = o1.object->position + rotateToWorld(o1, o1.object->objectFactory->getSupportPoint(p_direction));
+	o_vertex.point2 = o2.object->position + rotateToWorld(o2, o2.object->objectFactory->getSupportPoint(rotateToObject(o2, -direction)));
+	o_vertex.point = o_vertex.point1 - o_vertex.point2;
+	o_vertex.direction = p_direction;
+}
+
+
+/**
+ * reduce the triangle s (newest vertex stored last) to the feature which is
+ * closest to the origin and compute the new search direction
+ */
+bool cPhysicsGJK::updateSimplexTriangle(cSimplex &s, Vector &o_direction)
+{
+	cVertex a = s.vertices[2];
+	cVertex b = s.vertices[1];
+	cVertex c = s.vertices[0];
+
+	Vector ab = b.point - a.point;
+	Vector ac = c.point - a.point;
+	Vector ao = -a.point;
+	Vector abc = ab % ac;
+
+	if ((abc % ac).dotProd(ao) > 0)
+	{
+		if (ac.dotProd(ao) > 0)
+		{
+			// edge ac
+			s.vertices[0] = c;
+			s.vertices[1] = a;
+			s.count = 2;
+			o_direction = (ac % ao) % ac;
+			return false;
+		}
+	}
+	else if ((ab % abc).dotProd(ao) <= 0)
+	{
+		// inside of the triangle: search above or below
+		if (abc.dotProd(ao) > 0)
+		{
+			s.vertices[0] = c;
+			s.vertices[1] = b;
+			o_direction = abc;
+		}
+		else
+		{
+			s.vertices[0] = b;
+			s.vertices[1] = c;
+			o_direction = -abc;
+		}
+		s.vertices[2] = a;
+		return false;
+	}
+
+	if (ab.dotProd(ao) > 0)
+	{
+		// edge ab
+		s.vertices[0] = b;
+		s.vertices[1] = a;
+		s.count = 2;
+		o_direction = (ab % ao) % ab;
+	}
+	else
+	{
+		s.vertices[0] = a;
+		s.count = 1;
+		o_direction = ao;
+	}
+	return false;
+}
+
+
+/**
+ * reduce the simplex s (newest vertex stored last) to the feature which is
+ * closest to the origin and compute the new search direction
+ *
+ * \return	true, if the simplex is a tetrahedron containing the origin
+ */
+bool cPhysicsGJK::updateSimplex(cSimplex &s, Vector &o_direction)
+{
+	switch (s.count)
+	{
+		case 1:
+			o_direction = -s.vertices[0].point;
+			return false;
+
+		case 2:
+		{
+			cVertex &a = s.vertices[1];
+			Vector ab = s.vertices[0].point - a.point;
+			Vector ao = -a.point;
+
+			if (ab.dotProd(ao) > 0)
+			{
+				o_direction = (ab % ao) % ab;
+			}
+			else
+			{
+				s.vertices[0] = a;
+				s.count = 1;
+				o_direction = ao;
+			}
+			return false;
+		}
+
+		case 3:
+			return updateSimplexTriangle(s, o_direction);
+	}
+
+	/*
+	 * tetrahedron: the origin is not beyond the face opposite to the newest
+	 * vertex a since a was found in the direction of the origin. thus only
+	 * the 3 faces containing a are tested.
+	 */
+	static const int faces[3][3] = {{2, 1, 0}, {1, 0, 2}, {0, 2, 1}};
+
+	const Vector &a = s.vertices[3].point;
+	Vector ao = -a;
+
+	for (int f = 0; f < 3; f++)
+	{
+		const cVertex &p = s.vertices[faces[f][0]];
+		const cVertex &q = s.vertices[faces[f][1]];
+		const Vector &r = s.vertices[faces[f][2]].point;
+
+		Vector normal = (p.point - a) % (q.point - a);
+		if (normal.dotProd(r - a) > 0)
+			normal = -normal;
+
+		if (normal.dotProd(ao) > 0)
+		{
+			cVertex new_a = s.vertices[3];
+			cVertex new_b = p;
+			cVertex new_c = q;
+
+			s.vertices[0] = new_c;
+			s.vertices[1] = new_b;
+			s.vertices[2] = new_a;
+			s.count = 3;
+			return updateSimplexTriangle(s, o_direction);
+		}
+	}
+
+	return true;
+}
+
+
+/**
+ * \return	true, if the tetrahedron s is not flat and the origin is inside of
+ *			it or on its boundary. EPA expands faces through the origin like
+ *			all other faces.
+ */
+bool cPhysicsGJK::containsOrigin(const cSimplex &s)
+{
+	static const int faces[4][4] = {{0, 1, 2, 3}, {0, 3, 1, 2}, {0, 2, 3, 1}, {1, 3, 2, 0}};
+
+	for (int f = 0; f < 4; f++)
+	{
+		const Vector &a = s.vertices[faces[f][0]].point;
+		Vector normal = (s.vertices[faces[f][1]].point - a) % (s.vertices[faces[f][2]].point - a);
+
+		float opposite = normal.dotProd(s.vertices[faces[f][3]].point - a);
+		float origin = -normal.dotProd(a);
+
+		if (opposite == 0 || opposite*origin < 0)
+			return false;
+	}
+	return true;
+}
+
+
+bool cPhysicsGJK::intersect(iPhysicsObject &o1, iPhysicsObject &o2, cCacheEntry &io_entry, cSimplex &o_simplex)
+{
+	cSimplex &s = o_simplex;
+
+	/*
+	 * resting contact: the tetrahedron of the support points of the cached
+	 * directions still contains the origin
+	 */
+	if (io_entry.count == 4)
+	{
+		for (int i = 0; i < 4; i++)
+			support(o1, o2, io_entry.directions[i], s.vertices[i]);
+		s.count = 4;
+
+		if (containsOrigin(s))
+			return true;
+	}
+
+	Vector direction;
+	if (io_entry.count > 0)
+		direction = rotateToWorld(o1, io_entry.directions[io_entry.count-1]);
+	else
+		direction = o1.object->position - o2.object->position;
+
+	if (direction.getLength2() < GJK_MIN_DIRECTION_LENGTH2)
+		direction = Vector(1, 0, 0);
+
+	s.count = 0;
+	io_entry.count = 0;
+
+	for (int i = 0; i < GJK_MAX_ITERATIONS; i++)
+	{
+		cVertex &v = s.vertices[s.count];
+		support(o1, o2, rotateToObject(o1, direction), v);
+
+		if (v.point.dotProd(direction) <= 0)
+		{
+			// the direction separates the objects
+			io_entry.directions[0] = v.direction;
+			io_entry.count = 1;
+			return false;
+		}
+
+		s.count++;
+		if (updateSimplex(s, direction))
+		{
+			for (int k = 0; k < 4; k++)
+				io_entry.directions[k] = s.vertices[k].direction;
+			io_entry.count = 4;
+			return true;
+		}
+
+		float length2 = direction.getLength2();
+		if (length2 < GJK_MIN_DIRECTION_LENGTH2)
+			return false;
+
+		direction *= 1.0f/CMath<float>::sqrt(length2);
+	}
+
+	return false;
+}
+
+
+/**
+ * face of the EPA polytope. the vertices are ordered counter clockwise seen
+ * from outside.
+ */
+class cEPAFace
+{
+public:
+	int vertices[3];
+	Vector normal;
+	float distance;
+
+	inline bool setup(const cPhysicsGJK::cVertex *p_vertices, int a, int b, int c)
+	{
+		vertices[0] = a;
+		vertices[1] = b;
+		vertices[2] = c;
+
+		normal = (p_vertices[b].point - p_vertices[a].point) % (p_vertices[c].point - p_vertices[a].point);
+		float length = normal.getLength();
+		if (length < EPA_MIN_FACE_NORMAL_LENGTH)
+			return false;
+
+		normal *= 1.0f/length;
+		distance = normal.dotProd(p_vertices[a].point);
+		return true;
+	}
+};
+
+
+/**
+ * add an edge of a face which is removed from the polytope. edges shared
+ * by 2 removed faces are removed again, thus only the horizon is left.
+ */
+static inline void addHorizonEdge(int (*io_edges)[2], int &io_edges_count, int a, int b)
+{
+	for (int i = 0; i < io_edges_count; i++)
+	{
+		if (io_edges[i][0] == b && io_edges[i][1] == a)
+		{
+			io_edges_count--;
+			io_edges[i][0] = io_edges[io_edges_count][0];
+			io_edges[i][1] = io_edges[io_edges_count][1];
+			return;
+		}
+	}
+
+	io_edges[io_edges_count][0] = a;
+	io_edges[io_edges_count][1] = b;
+	io_edges_count++;
+}
+
+
+bool cPhysicsGJK::penetration(iPhysicsObject &o1, iPhysicsObject &o2, const cSimplex &p_simplex, CPhysicsCollisionData &c)
+{
+	if (p_simplex.count != 4 || !containsOrigin(p_simplex))
+		return false;
+
+	cVertex vertices[EPA_MAX_VERTICES];
+	cEPAFace faces[EPA_MAX_FACES];
+	int edges[3*EPA_MAX_FACES][2];
+
+	for (int i = 0; i < 4; i++)
+		vertices[i] = p_simplex.vertices[i];
+	int vertices_count = 4;
+
+	static const int tetrahedron[4][4] = {{0, 1, 2, 3}, {0, 3, 1, 2}, {0, 2, 3, 1}, {1, 3, 2, 0}};
+
+	int faces_count = 0;
+	for (int f = 0; f < 4; f++)
+	{
+		const int *t = tetrahedron[f];
+		if (!faces[f].setup(vertices, t[0], t[1], t[2]))
+			return false;
+
+		// turn the normal away from the opposite vertex
+		if (faces[f].normal.dotProd(vertices[t[3]].point - vertices[t[0]].point) > 0)
+			faces[f].setup(vertices, t[0], t[2], t[1]);
+
+		faces_count++;
+	}
+
+	cEPAFace closest;
+
+	for (int iteration = 0; ; iteration++)
+	{
+		int closest_id = 0;
+		for (int f = 1; f < faces_count; f++)
+			if (faces[f].distance < faces[closest_id].distance)
+				closest_id = f;
+
+		closest = faces[closest_id];
+
+		if (iteration == EPA_MAX_ITERATIONS)
+			break;
+
+		cVertex &v = vertices[vertices_count];
+		support(o1, o2, rotateToObject(o1, closest.normal), v);
+
+		if (v.point.dotProd(closest.normal) - closest.distance < EPA_TOLERANCE)
+			break;
+
+		/*
+		 * remove all faces seen from the new vertex and connect their
+		 * horizon with the new vertex
+		 */
+		int edges_count = 0;
+		for (int f = faces_count-1; f >= 0; f--)
+		{
+			cEPAFace &face = faces[f];
+			if (face.normal.dotProd(v.point - vertices[face.vertices[0]].point) <= 0)
+				continue;
+
+			for (int e = 0; e < 3; e++)
+				addHorizonEdge(edges, edges_count, face.vertices[e], face.vertices[(e+1)%3]);
+
+			faces_count--;
+			faces[f] = faces[faces_count];
+		}
+
+		if (faces_count + edges_count > EPA_MAX_FACES)
+			break;
+
+		bool degenerated = false;
+		for (int e = 0; e < edges_count; e++)
+		{
+			if (!faces[faces_count].setup(vertices, edges[e][0], edges[e][1], vertices_count))
+			{
+				degenerated = true;
+				break;
+			}
+			faces_count++;
+		}
+
+		if (degenerated)
+			break;
+
+		vertices_count++;
+	}
+
+	if (closest.distance <= 0)
+		return false;
+
+	/*
+	 * barycentric coordinates of the point of the closest face which is
+	 * closest to the origin. they are used to interpolate the support points
+	 * of both objects.
+	 */
+	const cVertex &a = vertices[closest.vertices[0]];
+	const cVertex &b = vertices[closest.vertices[1]];
+	const cVertex &d = vertices[closest.vertices[2]];
+
+	Vector v0 = b.point - a.point;
+	Vector v1 = d.point - a.point;
+	Vector v2 = closest.normal*closest.distance - a.point;
+
+	float d00 = v0.dotProd(v0);
+	float d01 = v0.dotProd(v1);
+	float d11 = v1.dotProd(v1);
+	float d20 = v2.dotProd(v0);
+	float d21 = v2.dotProd(v1);
+	float denominator = d00*d11 - d01*d01;
+
+	float u = 1, w1 = 0, w2 = 0;
+	if (denominator > 0)
+	{
+		w1 = (d11*d20 - d01*d21)/denominator;
+		w2 = (d00*d21 - d01*d20)/denominator;
+		u = 1 - w1 - w2;
+	}
+
+	c.physics_object1 = &o1;
+	c.physics_object2 = &o2;
+	c.collision_point1 = a.point1*u + b.point1*w1 + d.point1*w2;
+	c.collision_point2 = a.point2*u + b.point2*w1 + d.point2*w2;
+	c.collision_normal = closest.normal;
+	c.interpenetration_depth = closest.distance;
+	c.feature_id = 0;
+
+	return true;
+}
+
+
+const cPhysicsGJK::cCacheEntry *cPhysicsGJK::cCache::find(iPhysicsObject *p_physics_object1, iPhysicsObject *p_physics_object2) const
+{
+	if (entries.empty())
+		return NULL;
+
+	cCacheEntry key;
+	key.physics_object1 = p_physics_object1;
+	key.physics_object2 = p_physics_object2;
+
+	std::vector<cCacheEntry>::const_iterator e = std::lower_bound(entries.begin(), entries.end(), key);
+
+	if (e == entries.end() || key < *e)
+		return NULL;
+
+	return &*e;
+}
+
+
+void cPhysicsGJK::cCache::insert(const std::vector<cCacheEntry> &p_entries)
+{
+	entries.insert(entries.end(), p_entries.begin(), p_entries.end());
+}
+
+
+void cPhysicsGJK::cCache::sort()
+{
+	std::sort(entries.begin(), entries.end());
+}
+
+
+void cPhysicsGJK::cCache::clear()
+{
+	entries.clear();
+}
@@ -0,0 +1,192 @@
+/*
+ * Copyright 2010 Martin Schreiber
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef CPHYSICS_GJK_HPP
+#define CPHYSICS_GJK_HPP
+
+#include <vector>
+#include "sbndengine/physics/iPhysicsObject.hpp"
+#include "libmath/CVector.hpp"
+#include "cPhysicsCollisionData.hpp"
+
+
+/**
+ * maximum number of support points searched by GJK and EPA
+ */
+#define GJK_MAX_ITERATIONS		32
+#define EPA_MAX_ITERATIONS		64
+
+/**
+ * EPA stops if the next support point is less than EPA_TOLERANCE farther
+ * away than the closest face of the polytope
+ */
+#define EPA_TOLERANCE			0.0001f
+
+
+/**
+ * \brief collision detection for any pair of convex shapes
+ *
+ * the shapes are only described by the support points of their factories
+ * (iObjectFactory::getSupportPoint()). GJK searches a tetrahedron of the
+ * Minkowski difference o1-o2 which contains the origin. if there is one, the
+ * objects intersect and EPA expands the tetrahedron to find the face of the
+ * Minkowski difference closest to the origin: its normal is the collision
+ * normal and its distance the interpenetration depth.
+ *
+ * each support point is identified by the search direction in the object
+ * space of o1. the directions of the last simplex are cached for each pair of
+ * objects. as long as the objects only move a little, the cached simplex still
+ * contains the origin (resting contacts) or the cached direction is still a
+ * separating axis, thus GJK stops after the first iteration.
+ */
+class cPhysicsGJK
+{
+public:
+	/**
+	 * point of the Minkowski difference and the support points of both
+	 * objects in world space
+	 */
+	class cVertex
+	{
+	public:
+		CVector<3,float> point;
+		CVector<3,float> point1;
+		CVector<3,float> point2;
+
+		// search direction in the object space of o1
+		CVector<3,float> direction;
+	};
+
+	class cSimplex
+	{
+	public:
+		cVertex vertices[4];
+		int count;
+	};
+
+	class cCacheEntry
+	{
+	public:
+		iPhysicsObject *physics_object1;
+		iPhysicsObject *physics_object2;
+
+		/**
+		 * directions of the tetrahedron which contained the origin (4) or
+		 * the separating direction (1)
+		 */
+		CVector<3,float> directions[4];
+		int count;
+
+		inline bool operator<(const cCacheEntry &e)	const
+		{
+			if (physics_object1 != e.physics_object1)	return physics_object1 < e.physics_object1;
+			return physics_object2 < e.physics_object2;
+		}
+	};
+
+	/**
+	 * simplices of the last timestep sorted by the objects
+	 */
+	class cCache
+	{
+		std::vector<cCacheEntry> entries;
+
+	public:
+		/**
+		 * \return	cached simplex or NULL
+		 */
+		const cCacheEntry *find(iPhysicsObject *p_physics_object1, iPhysicsObject *p_physics_object2) const;
+
+		/**
+		 * add the simplices of the current timestep. sort() has to be called
+		 * after all simplices were inserted.
+		 */
+		void insert(const std::vector<cCacheEntry> &p_entries);
+
+		void sort();
+
+		void clear();
+	};
+
+	/**
+	 * cache of the last timestep (read only) and the buffer for the new
+	 * entries of one thread
+	 */
+	class cContext
+	{
+	public:
+		const cCache *cache;
+		std::vector<cCacheEntry> *new_entries;
+	};
+
+	/**
+	 * rotate a direction from world space to the object space of o
+	 */
+	static inline CVector<3,float> rotateToObject(iPhysicsObject &o, const CVector<3,float> &d)
+	{
+		CMatrix4<float> &m = o.object->model_matrix;
+
+		return CVector<3,float>(
+				m[0][0]*d.data[0] + m[1][0]*d.data[1] + m[2][0]*d.data[2],
+				m[0][1]*d.data[0] + m[1][1]*d.data[1] + m[2][1]*d.data[2],
+				m[0][2]*d.data[0] + m[1][2]*d.data[1] + m[2][2]*d.data[2]
+			);
+	}
+
+	/**
+	 * rotate a direction from the object space of o to world space
+	 */
+	static inline CVector<3,float> rotateToWorld(iPhysicsObject &o, const CVector<3,float> &d)
+	{
+		CMatrix4<float> &m = o.object->model_matrix;
+
+		return CVector<3,float>(
+				m[0][0]*d.data[0] + m[0][1]*d.data[1] + m[0][2]*d.data[2],
+				m[1][0]*d.data[0] + m[1][1]*d.data[1] + m[1][2]*d.data[2],
+				m[2][0]*d.data[0] + m[2][1]*d.data[1] + m[2][2]*d.data[2]
+			);
+	}
+
+	/**
+	 * compute the support point of the Minkowski difference o1-o2 for the
+	 * direction given in the object space of o1
+	 */
+	static void support(iPhysicsObject &o1, iPhysicsObject &o2, const CVector<3,float> &p_direction, cVertex &o_vertex);
+
+	/**
+	 * GJK intersection test
+	 *
+	 * \param io_entry	cached simplex (count = 0 if there is none). it is
+	 *					replaced with the simplex of this test.
+	 * \return	true, if the objects intersect. the simplex is a tetrahedron
+	 *			containing the origin in this case.
+	 */
+	static bool intersect(iPhysicsObject &o1, iPhysicsObject &o2, cCacheEntry &io_entry, cSimplex &o_simplex);
+
+	/**
+	 * EPA: compute the collision data for the simplex found by intersect()
+	 *
+	 * \return	false, if the objects only touch
+	 */
+	static bool penetration(iPhysicsObject &o1, iPhysicsObject &o2, const cSimplex &p_simplex, CPhysicsCollisionData &c);
+
+private:
+	static bool updateSimplex(cSimplex &s, CVector<3,float> &o_direction);
+	static bool updateSimplexTriangle(cSimplex &s, CVector<3,float> &o_direction);
+	static bool containsOrigin(const cSimplex &s);
+};
+
+#endif
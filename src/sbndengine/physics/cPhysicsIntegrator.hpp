@@ -0,0 +1,168 @@
+/*
+ * Copyright 2010 Martin Schreiber
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef CPHYSICS_INTEGRATOR_HPP
+#define CPHYSICS_INTEGRATOR_HPP
+
+#include "libmath/CVector.hpp"
+
+/*
+ * the vector instructions are selected by the compiler flags (e. g. -mavx).
+ * without any of them, the scalar code is used.
+ */
+#if defined(__AVX__)
+	#include <immintrin.h>
+	#define PHYSICS_INTEGRATOR_AVX	1
+#elif defined(__SSE2__)
+	#include <emmintrin.h>
+	#define PHYSICS_INTEGRATOR_SSE	1
+#endif
+
+
+/**
+ * \brief kernels to integrate the linear movement of many objects at once
+ *
+ * the kernels work on the arrays of cObjectStore. the 3 components of the
+ * vectors of consecutive objects are stored consecutively, thus the arrays
+ * are processed as plain float arrays without any shuffles. only the floats
+ * with a mask of ~0 are updated.
+ *
+ * the vectorized and the scalar code use the same operations in the same
+ * order, thus the results are identical.
+ */
+class cPhysicsIntegrator
+{
+public:
+	/**
+	 * velocity += acceleration*dt
+	 * position += (velocity + acceleration*dt)*dt
+	 */
+	static inline void integrateLinear(
+			float *io_velocity,
+			float *io_position,
+			const float *i_acceleration,
+			const unsigned int *i_mask,
+			int p_count,				///< number of floats
+			float p_timestep_size
+	)
+	{
+		int k = 0;
+
+#if PHYSICS_INTEGRATOR_AVX
+		__m256 dt = _mm256_set1_ps(p_timestep_size);
+
+		for (; k+8 <= p_count; k += 8)
+		{
+			__m256 mask = _mm256_castsi256_ps(_mm256_loadu_si256((const __m256i*)(i_mask+k)));
+			__m256 velocity = _mm256_loadu_ps(io_velocity+k);
+			__m256 position = _mm256_loadu_ps(io_position+k);
+			__m256 acceleration_dt = _mm256_mul_ps(_mm256_loadu_ps(i_acceleration+k), dt);
+
+			__m256 new_velocity = _mm256_add_ps(velocity, acceleration_dt);
+			__m256 new_position = _mm256_add_ps(position, _mm256_mul_ps(_mm256_add_ps(new_velocity, acceleration_dt), dt));
+
+			_mm256_storeu_ps(io_velocity+k, _mm256_blendv_ps(velocity, new_velocity, mask));
+			_mm256_storeu_ps(io_position+k, _mm256_blendv_ps(position, new_position, mask));
+		}
+#elif PHYSICS_INTEGRATOR_SSE
+		__m128 dt = _mm_set1_ps(p_timestep_size);
+
+		for (; k+4 <= p_count; k += 4)
+		{
+			__m128 mask = _mm_castsi128_ps(_mm_loadu_si128((const __m128i*)(i_mask+k)));
+			__m128 velocity = _mm_loadu_ps(io_velocity+k);
+			__m128 position = _mm_loadu_ps(io_position+k);
+			__m128 acceleration_dt = _mm_mul_ps(_mm_loadu_ps(i_acceleration+k), dt);
+
+			__m128 new_velocity = _mm_add_ps(velocity, acceleration_dt);
+			__m128 new_position = _mm_add_ps(position, _mm_mul_ps(_mm_add_ps(new_velocity, acceleration_dt), dt));
+
+			_mm_storeu_ps(io_velocity+k, _mm_or_ps(_mm_and_ps(mask, new_velocity), _mm_andnot_ps(mask, velocity)));
+			_mm_storeu_ps(io_position+k, _mm_or_ps(_mm_and_ps(mask, new_position), _mm_andnot_ps(mask, position)));
+		}
+#endif
+
+		for (; k < p_count; k++)
+		{
+			if (!i_mask[k])
+				continue;
+
+			float acceleration_dt = i_acceleration[k]*p_timestep_size;
+			io_velocity[k] += acceleration_dt;
+			io_position[k] += (io_velocity[k] + acceleration_dt)*p_timestep_size;
+		}
+	}
+
+
+	/**
+	 * set the vectors starting at o_dst to p_value
+	 */
+	static inline void fill(
+			float *o_dst,
+			const CVector<3,float> &p_value,
+			const unsigned int *i_mask,
+			int p_count				///< number of floats (multiple of 3)
+	)
+	{
+		int k = 0;
+
+#if PHYSICS_INTEGRATOR_AVX
+		// 24 floats are 8 vectors in 3 registers
+		float pattern[24];
+		for (int i = 0; i < 24; i++)
+			pattern[i] = p_value.data[i%3];
+
+		__m256 value[3];
+		for (int r = 0; r < 3; r++)
+			value[r] = _mm256_loadu_ps(pattern+r*8);
+
+		for (; k+24 <= p_count; k += 24)
+		{
+			for (int r = 0; r < 3; r++)
+			{
+				__m256 mask = _mm256_castsi256_ps(_mm256_loadu_si256((const __m256i*)(i_mask+k+r*8)));
+				__m256 dst = _mm256_loadu_ps(o_dst+k+r*8);
+				_mm256_storeu_ps(o_dst+k+r*8, _mm256_blendv_ps(dst, value[r], mask));
+			}
+		}
+#elif PHYSICS_INTEGRATOR_SSE
+		// 12 floats are 4 vectors in 3 registers
+		float pattern[12];
+		for (int i = 0; i < 12; i++)
+			pattern[i] = p_value.data[i%3];
+
+		__m128 value[3];
+		for (int r = 0; r < 3; r++)
+			value[r] = _mm_loadu_ps(pattern+r*4);
+
+		for (; k+12 <= p_count; k += 12)
+		{
+			for (int r = 0; r < 3; r++)
+			{
+				__m128 mask = _mm_castsi128_ps(_mm_loadu_si128((const __m128i*)(i_mask+k+r*4)));
+				__m128 dst = _mm_loadu_ps(o_dst+k+r*4);
+				_mm_storeu_ps(o_dst+k+r*4, _mm_or_ps(_mm_and_ps(mask, value[r]), _mm_andnot_ps(mask, dst)));
+			}
+		}
+#endif
+
+		for (; k < p_count; k++)
+			if (i_mask[k])
+				o_dst[k] = p_value.data[k%3];
+	}
+};
+
+#endif
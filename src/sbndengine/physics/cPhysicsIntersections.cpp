@@ -19,10 +19,60 @@
 #include "sbndengine/engine/cObjectFactoryBox.hpp"
 #include "sbndengine/engine/cObjectFactoryPlane.hpp"
 #include "sbndengine/engine/cObjectFactorySphere.hpp"
+#include "sbndengine/engine/cObjectFactoryTriangleMesh.hpp"
 #include "gamemath.hpp"
 #include "worksheets_precompiler.hpp"
+#include <algorithm>
 
 
+/**
+ * offset of the feature ids of clipped face contacts to avoid a mix up with
+ * the ids of edge contacts
+ */
+#define BOX_FACE_FEATURE_ID_OFFSET		128
+
+/**
+ * convex objects touch with faces if the normal of one of the faces deviates
+ * from the collision normal by less than acos(CONVEX_FACE_CONTACT_MIN_DOT)
+ */
+#define CONVEX_FACE_CONTACT_MIN_DOT		0.999f
+
+/**
+ * offset of the feature ids of clipped face contacts of convex objects (the
+ * point computed by EPA uses 0)
+ */
+#define CONVEX_FACE_FEATURE_ID_OFFSET	4096
+
+/**
+ * maximum number of collision points with a mesh before the manifold is
+ * reduced. if there are more points, the deepest ones are kept.
+ */
+#define MESH_MAX_CONTACT_CANDIDATES		64
+
+/**
+ * number of feature ids reserved for the collision points with one triangle
+ */
+#define MESH_TRIANGLE_FEATURE_IDS		256
+
+/**
+ * collision points of a sphere with adjacent triangles which are closer
+ * than sqrt(MESH_CONTACT_MERGE_DISTANCE2) are merged (shared edges and vertices)
+ */
+#define MESH_CONTACT_MERGE_DISTANCE2	0.00000001f
+
+/**
+ * a sphere with continuous collision detection penetrates the other object
+ * by this fraction of its radius at the time of impact. thus the contact is
+ * found by the discrete tests afterwards.
+ */
+#define CCD_RELATIVE_PENETRATION		0.02f
+
+/**
+ * maximum number of conservative advancement steps of the time of impact
+ * computation for boxes
+ */
+#define CCD_MAX_ITERATIONS				16
+
 
 /**
  * LAB WORKSHEET 2, ASSIGNMENT 1
@@ -44,6 +94,7 @@ bool CPhysicsIntersections::sphereSphere(iPhysicsObject &physics_object1, iPhysi
 	c.collision_point1 = physics_object1.object->position + c.collision_normal * radius1;
 	c.collision_point2 = physics_object2.object->position - c.collision_normal * radius2;
 	c.interpenetration_depth = (c.collision_point2 - c.collision_point1).getLength();
+	c.feature_id = 0;
 
 	return true;
 #else
@@ -84,6 +135,7 @@ bool CPhysicsIntersections::spherePlane(iPhysicsObject &physics_object_sphere, i
 	c.collision_point1 = planeMatrix * Vector(spherePos[0], 0, spherePos[2]);
 	c.collision_point2 = physics_object_sphere.object->position - (c.collision_normal * sphereRadius);
 	c.interpenetration_depth = (c.collision_point2 - c.collision_point1).getLength();
+	c.feature_id = 0;
 	
 	return true;
 #else
@@ -96,6 +148,8 @@ bool CPhysicsIntersections::spherePlane(iPhysicsObject &physics_object_sphere, i
  * LAB WORKSHEET 4, ASSIGNMENT 1
  *
  * compute the intersection between a sphere and a box
+ *
+ * feature ids: 0-5 faces, 6-17 edges, 18-25 corners of the box
  */
 bool CPhysicsIntersections::sphereBox(iPhysicsObject &physics_object_sphere, iPhysicsObject &physics_object_box, CPhysicsCollisionData &c)
 {
@@ -116,6 +170,7 @@ bool CPhysicsIntersections::sphereBox(iPhysicsObject &physics_object_sphere, iPh
 		c.collision_point1 = physics_object_box.object->model_matrix * Vector(sgn*boxHalfSize[0], spherePos[1], spherePos[2]);
 		c.collision_point2 = physics_object_sphere.object->position - (c.collision_normal * sphereRadius);
 		c.interpenetration_depth = (c.collision_point2 - c.collision_point1).getLength();
+		c.feature_id = 0 + (sgn > 0);
 		
 		return true;
 	}
@@ -129,6 +184,7 @@ bool CPhysicsIntersections::sphereBox(iPhysicsObject &physics_object_sphere, iPh
 		c.collision_point1 = physics_object_box.object->model_matrix * Vector(spherePos[0], sgn*boxHalfSize[1], spherePos[2]);
 		c.collision_point2 = physics_object_sphere.object->position - (c.collision_normal * sphereRadius);
 		c.interpenetration_depth = (c.collision_point2 - c.collision_point1).getLength();
+		c.feature_id = 2 + (sgn > 0);
 		
 		return true;
 	}
@@ -142,6 +198,7 @@ bool CPhysicsIntersections::sphereBox(iPhysicsObject &physics_object_sphere, iPh
 		c.collision_point1 = physics_object_box.object->model_matrix * Vector(spherePos[0], spherePos[1], sgn*boxHalfSize[2]);
 		c.collision_point2 = physics_object_sphere.object->position - (c.collision_normal * sphereRadius);
 		c.interpenetration_depth = (c.collision_point2 - c.collision_point1).getLength();
+		c.feature_id = 4 + (sgn > 0);
 		
 		return true;
 	}
@@ -158,6 +215,7 @@ bool CPhysicsIntersections::sphereBox(iPhysicsObject &physics_object_sphere, iPh
 		c.collision_point1 = physics_object_box.object->model_matrix * Vector(spherePos[0], ySgn*boxHalfSize[1], zSgn*boxHalfSize[2]);
 		c.collision_point2 = physics_object_sphere.object->position - (c.collision_normal * sphereRadius);
 		c.interpenetration_depth = (c.collision_point2 - c.collision_point1).getLength();
+		c.feature_id = 6 + (ySgn > 0)*2 + (zSgn > 0);
 		
 		return true;
 	}
@@ -172,6 +230,7 @@ bool CPhysicsIntersections::sphereBox(iPhysicsObject &physics_object_sphere, iPh
 		c.collision_point1 = physics_object_box.object->model_matrix * Vector(xSgn*boxHalfSize[0], spherePos[1], zSgn*boxHalfSize[2]);
 		c.collision_point2 = physics_object_sphere.object->position - (c.collision_normal * sphereRadius);
 		c.interpenetration_depth = (c.collision_point2 - c.collision_point1).getLength();
+		c.feature_id = 10 + (xSgn > 0)*2 + (zSgn > 0);
 		
 		return true;
 	}
@@ -186,6 +245,7 @@ bool CPhysicsIntersections::sphereBox(iPhysicsObject &physics_object_sphere, iPh
 		c.collision_point1 = physics_object_box.object->model_matrix * Vector(xSgn*boxHalfSize[0], ySgn*boxHalfSize[1], spherePos[2]);
 		c.collision_point2 = physics_object_sphere.object->position - (c.collision_normal *sphereRadius);
 		c.interpenetration_depth = (c.collision_point2 - c.collision_point1).getLength();
+		c.feature_id = 14 + (xSgn > 0)*2 + (ySgn > 0);
 		
 		return true;
 	}
@@ -202,6 +262,7 @@ bool CPhysicsIntersections::sphereBox(iPhysicsObject &physics_object_sphere, iPh
 		c.collision_point1 = physics_object_box.object->model_matrix * Vector(xSgn*boxHalfSize[0], ySgn*boxHalfSize[1], zSgn*boxHalfSize[2]);
 		c.collision_point2 = physics_object_sphere.object->position - (c.collision_normal * sphereRadius);
 		c.interpenetration_depth = (c.collision_point2 - c.collision_point1).getLength();
+		c.feature_id = 18 + (xSgn > 0)*4 + (ySgn > 0)*2 + (zSgn > 0);
 		
 		return true;
 	}
@@ -228,14 +289,23 @@ bool CPhysicsIntersections::planePlane(iPhysicsObject &physics_object_plane1, iP
  * LAB WORKSHEET 4, ASSIGNMENT 2
  *
  * compute the intersection between a plane and a box
+ *
+ * if the box is completely above the plane area, all vertices penetrating the
+ * plane are collision points (reduced to COLLISION_MAX_MANIFOLD_POINTS). thus
+ * a box lying on a plane is supported at its corners instead of rocking
+ * around a single point.
+ *
+ * feature ids: 0-7 box vertices, 8-9 edge contacts at the plane border
  */
-bool CPhysicsIntersections::planeBox(iPhysicsObject &physics_object_plane, iPhysicsObject &physics_object_box, CPhysicsCollisionData &c)
+int CPhysicsIntersections::planeBox(iPhysicsObject &physics_object_plane, iPhysicsObject &physics_object_box, CPhysicsCollisionData *manifold)
 {
 #if WORKSHEET_4
-	iRef<iObject> box = physics_object_box.object;
+	CPhysicsCollisionData &c = manifold[0];
+
+	iObject *box = &physics_object_box.object.getClass();
 	Vector boxHalfSize = static_cast<cObjectFactoryBox *>(&box->objectFactory.getClass())->half_size;
 	
-	iRef<iObject> plane = physics_object_plane.object;
+	iObject *plane = &physics_object_plane.object.getClass();
 	cObjectFactoryPlane &planeFactory = *static_cast<cObjectFactoryPlane *>(&physics_object_plane.object->objectFactory.getClass());
 	
 	int sideOfPlane = 0;
@@ -249,8 +319,12 @@ bool CPhysicsIntersections::planeBox(iPhysicsObject &physics_object_plane, iPhys
 							Vector(boxHalfSize[0], -boxHalfSize[1], -boxHalfSize[2]), Vector(boxHalfSize[0], -boxHalfSize[1], boxHalfSize[2]), 
 							Vector(boxHalfSize[0], boxHalfSize[1], -boxHalfSize[2]), Vector(boxHalfSize[0], boxHalfSize[1], boxHalfSize[2])};
 	
+	// box vertices in the plane space
+	Vector planeVertexList[8];
+	
 	for (Vector* arr = vertexList; arr != vertexList + 8; arr++) {
 		Vector current = plane->inverse_model_matrix * box->model_matrix * *arr;
+		planeVertexList[arr - vertexList] = current;
 		
 		//vertex is outside of plane
 		if (fabs(current[0]) > planeFactory.size_x / 2 || fabs(current[2]) > planeFactory.size_z / 2) {
@@ -285,7 +359,7 @@ bool CPhysicsIntersections::planeBox(iPhysicsObject &physics_object_plane, iPhys
 
 	//no collision when all points are on one side of plane or outside of plane
 	if (abs(sideOfPlane) == 8 || vertecesOutsidePlane.size() == 8) {
-		return false;
+		return 0;
 	}
 
 
@@ -357,7 +431,8 @@ bool CPhysicsIntersections::planeBox(iPhysicsObject &physics_object_plane, iPhys
 			c.collision_point1 = plane->model_matrix * planeClosestVertex;
 			c.collision_point2 = plane->model_matrix * boxClosestVertex;
 			c.interpenetration_depth = (c.collision_point1 - c.collision_point2).getLength();
-			return true;
+			c.feature_id = 8;
+			return 1;
 		}
 		
  
@@ -374,80 +449,116 @@ bool CPhysicsIntersections::planeBox(iPhysicsObject &physics_object_plane, iPhys
 			c.collision_point1 = plane->model_matrix * planeClosestVertex;
 			c.collision_point2 = plane->model_matrix * boxClosestVertex;
 			c.interpenetration_depth = (c.collision_point1 - c.collision_point2).getLength();
-			return true;
+			c.feature_id = 9;
+			return 1;
 		}
 		
-		return false;
+		return 0;
 	}
 	
 	
 	
-	if (sideOfPlane < 0) {
-		c.collision_normal = plane->inverse_model_matrix.getTranspose() * Vector(0, -1, 0);
-		c.collision_point1 = plane->model_matrix * Vector(maxAbovePlane[0], 0, maxAbovePlane[2]);
-		c.collision_point2 = plane->model_matrix * maxAbovePlane;
-		c.interpenetration_depth = (c.collision_point2 - c.collision_point1).getLength();
+	/*
+	 * all vertices on the penetrating side of the plane are collision points
+	 */
+	Vector normal = plane->inverse_model_matrix.getTranspose() * Vector(0, (sideOfPlane < 0 ? -1 : 1), 0);
+	
+	Vector points[8];
+	float depths[8];
+	int ids[8];
+	int count = 0;
+	
+	for (int i = 0; i < 8; i++) {
+		Vector &current = planeVertexList[i];
+		
+		if (sideOfPlane < 0 ? current[1] <= 0 : current[1] > 0)
+			continue;
+		
+		points[count] = plane->model_matrix * current;
+		depths[count] = fabs(current[1]);
+		ids[count] = i;
+		count++;
 	}
-	else {
-		c.collision_normal = plane->inverse_model_matrix.getTranspose() * Vector(0, 1, 0);
-		c.collision_point1 = plane->model_matrix * Vector(maxBelowPlane[0], 0, maxBelowPlane[2]);
-		c.collision_point2 = plane->model_matrix * maxBelowPlane;
-		c.interpenetration_depth = (c.collision_point2 - c.collision_point1).getLength();
+	
+	int selected[COLLISION_MAX_MANIFOLD_POINTS];
+	count = reduceManifold(points, depths, count, normal, selected);
+	
+	for (int i = 0; i < count; i++) {
+		CPhysicsCollisionData &m = manifold[i];
+		Vector &current = planeVertexList[ids[selected[i]]];
+		
+		m.physics_object1 = &physics_object_plane;
+		m.physics_object2 = &physics_object_box;
+		m.collision_normal = normal;
+		m.collision_point1 = plane->model_matrix * Vector(current[0], 0, current[2]);
+		m.collision_point2 = points[selected[i]];
+		m.interpenetration_depth = (m.collision_point2 - m.collision_point1).getLength();
+		m.feature_id = ids[selected[i]];
 	}
 	
-	return true;
+	return count;
 	
 #else
-	return false;
+	return 0;
 #endif
 }
 
+void CPhysicsIntersections::getBox(iPhysicsObject &physics_object_box, cPhysicsBoxBoxSAT::cBox &box)
+{
+	iObject &object = physics_object_box.object.getClass();
+	CMatrix4<float> &m = object.model_matrix;
+
+	box.position = object.position;
+	for (int i = 0; i < 3; i++)
+		box.axes[i] = Vector(m[0][i], m[1][i], m[2][i]);
+	box.half_size = static_cast<cObjectFactoryBox *>(&object.objectFactory.getClass())->half_size;
+}
+
+
 /**
  * LAB WORKSHEET 5, ASSIGNMENT 1
  *
  * compute the intersection between a box and a box
  */
-vec2d CPhysicsIntersections::getProjection(iPhysicsObject const &boxObject, Vector const &axis)
+int CPhysicsIntersections::boxBox(iPhysicsObject &physics_object_box1, iPhysicsObject &physics_object_box2, CPhysicsCollisionData *manifold)
 {
-	Vector boxHalfSize = static_cast<cObjectFactoryBox *>(&boxObject.object->objectFactory.getClass())->half_size;
-	
-	Vector vertexList[8] = {
-		Vector(-boxHalfSize[0], -boxHalfSize[1], -boxHalfSize[2]),
-		Vector(-boxHalfSize[0], -boxHalfSize[1], boxHalfSize[2]),
-		Vector(-boxHalfSize[0], boxHalfSize[1], -boxHalfSize[2]),
-		Vector(-boxHalfSize[0], boxHalfSize[1], boxHalfSize[2]),
-		Vector(boxHalfSize[0], -boxHalfSize[1], -boxHalfSize[2]),
-		Vector(boxHalfSize[0], -boxHalfSize[1], boxHalfSize[2]),
-		Vector(boxHalfSize[0], boxHalfSize[1], -boxHalfSize[2]),
-		Vector(boxHalfSize[0], boxHalfSize[1], boxHalfSize[2])
-	};
-	
-	float min = axis.dotProd(boxObject.object->model_matrix * vertexList[0]);
-	float max = min;
-	for (int i = 1; i < 8; ++i) {
-		// Vertices are in model space. We need to transform them to world space.
-		Vector vertexPos = boxObject.object->model_matrix * vertexList[i];
-		float projLength = axis.dotProd(vertexPos);
-		if (projLength > max) max = projLength;
-		else if (projLength < min) min = projLength;
-	}
+#if WORKSHEET_5
+	cPhysicsBoxBoxSAT::cBox box1, box2;
+	getBox(physics_object_box1, box1);
+	getBox(physics_object_box2, box2);
+
+	cPhysicsBoxBoxSAT::cResult sat;
+	cPhysicsBoxBoxSAT::test(box1, box2, sat);
 
-	return vec2d(min, max);
+	return boxBox(physics_object_box1, physics_object_box2, sat, manifold);
+#else
+	return 0;
+#endif
 }
 
-bool CPhysicsIntersections::boxBox(iPhysicsObject &physics_object_box1, iPhysicsObject &physics_object_box2, CPhysicsCollisionData &c)
+
+/**
+ * compute the collision points for the result of the separating axis test
+ *
+ * feature ids: separating axis index * 8 + the signs of the contact vertex,
+ * see boxBoxFaceManifold() for face contacts
+ */
+int CPhysicsIntersections::boxBox(iPhysicsObject &physics_object_box1, iPhysicsObject &physics_object_box2, const cPhysicsBoxBoxSAT::cResult &sat, CPhysicsCollisionData *manifold)
 {
 #if WORKSHEET_5
-	// Determine axis that need to be checked for overlapping of object projections (separating axis theorem)
-	CMatrix4<float> modelMatrix1 = physics_object_box1.object->model_matrix;
-	CMatrix4<float> modelMatrix2 = physics_object_box2.object->model_matrix;
-	
+	if (sat.axis < 0)
+		return 0; // Separating axis found -> no collision
+
+	CPhysicsCollisionData &c = manifold[0];
+
+	CMatrix4<float> &modelMatrix1 = physics_object_box1.object->model_matrix;
+	CMatrix4<float> &modelMatrix2 = physics_object_box2.object->model_matrix;
+
 	Vector boxHalfSize1 = static_cast<cObjectFactoryBox *>(&physics_object_box1.object->objectFactory.getClass())->half_size;
 	Vector boxHalfSize2 = static_cast<cObjectFactoryBox *>(&physics_object_box2.object->objectFactory.getClass())->half_size;
 
-	Vector seperatingAxes[15] = {
+	Vector seperatingAxes[6] = {
 		// Normals of object1's surfaces
-
 		Vector(modelMatrix1[0][0], modelMatrix1[1][0], modelMatrix1[2][0]),
 		Vector(modelMatrix1[0][1], modelMatrix1[1][1], modelMatrix1[2][1]),
 		Vector(modelMatrix1[0][2], modelMatrix1[1][2], modelMatrix1[2][2]),
@@ -458,132 +569,1072 @@ bool CPhysicsIntersections::boxBox(iPhysicsObject &physics_object_box1, iPhysics
 		Vector(modelMatrix2[0][2], modelMatrix2[1][2], modelMatrix2[2][2])
 	};
 
-	int x = 6;
+	int bestAxis = sat.axis;
+
+	c.interpenetration_depth = sat.depth;
+	if (bestAxis < 6)
+		c.collision_normal = seperatingAxes[bestAxis];
+	else
+		c.collision_normal = (seperatingAxes[(bestAxis - 6)/3] % seperatingAxes[3 + bestAxis%3]).getNormalized();
+
+	Vector dist = (physics_object_box2.object->position - physics_object_box1.object->position);
+	if (dist.dotProd(c.collision_normal) < 0) c.collision_normal = -c.collision_normal;
+	Vector sgn = Vector();
+
+	if (bestAxis < 3) {
+		//used principal axis of box1
+		sgn[0] = seperatingAxes[3].dotProd(dist);
+		sgn[1] = seperatingAxes[4].dotProd(dist);
+		sgn[2] = seperatingAxes[5].dotProd(dist);
+
+		sgn[0] = (sgn[0] >= 0) - (sgn[0] < 0);
+		sgn[1] = (sgn[1] >= 0) - (sgn[1] < 0);
+		sgn[2] = (sgn[2] >= 0) - (sgn[2] < 0);
+
+		boxHalfSize2 = boxHalfSize2 * sgn;
+
+		c.collision_point2 = physics_object_box2.object->position + seperatingAxes[3]*boxHalfSize2[0] + seperatingAxes[4]*boxHalfSize2[1] + seperatingAxes[5]*boxHalfSize2[2];
+		c.collision_point1 = c.collision_point2 + c.collision_normal * c.interpenetration_depth;
+		c.feature_id = bestAxis*8 + (sgn[0] > 0)*4 + (sgn[1] > 0)*2 + (sgn[2] > 0);
+	}
+	else if (bestAxis < 6) {
+		//used principal axis of box2
+		sgn[0] = seperatingAxes[0].dotProd(dist);
+		sgn[1] = seperatingAxes[1].dotProd(dist);
+		sgn[2] = seperatingAxes[2].dotProd(dist);
+
+		sgn[0] = (sgn[0] >= 0) - (sgn[0] < 0);
+		sgn[1] = (sgn[1] >= 0) - (sgn[1] < 0);
+		sgn[2] = (sgn[2] >= 0) - (sgn[2] < 0);
+
+		boxHalfSize1 = boxHalfSize1 * sgn;
+
+		c.collision_point1 = physics_object_box1.object->position + seperatingAxes[0]*boxHalfSize1[0] + seperatingAxes[1]*boxHalfSize1[1] + seperatingAxes[2]*boxHalfSize1[2];
+		c.collision_point2 = c.collision_point1 + c.collision_normal * c.interpenetration_depth;
+		c.feature_id = bestAxis*8 + (sgn[0] > 0)*4 + (sgn[1] > 0)*2 + (sgn[2] > 0);
+	}
+	else {
+		//used axis created by cross-product
+
+		//calculate which principle axis of box1 was used for creation of the cross-product, this is the direction of the edge
+		int i = (bestAxis - 6)/3;
+
+		sgn[0] = seperatingAxes[0].dotProd(dist);
+		sgn[1] = seperatingAxes[1].dotProd(dist);
+		sgn[2] = seperatingAxes[2].dotProd(dist);
+
+		sgn[0] = (sgn[0] >= 0) - (sgn[0] < 0);
+		sgn[1] = (sgn[1] >= 0) - (sgn[1] < 0);
+		sgn[2] = (sgn[2] >= 0) - (sgn[2] < 0);
+
+		//calculate a point on this edge using the other two principle axis
+		Vector point1 = physics_object_box1.object->position
+			+ seperatingAxes[(i+1)%3] * boxHalfSize1[(i+1)%3] * sgn[(i+1)%3]
+			+ seperatingAxes[(i+2)%3] * boxHalfSize1[(i+2)%3] * sgn[(i+2)%3];
+		LinePP edge1 = LinePP(point1, point1 + seperatingAxes[i]);
+
+		//calculate which principle axis of box2 was used for creation of the cross-product, this is the direction of the edge
+		int j = bestAxis%3;
+
+		sgn[0] = seperatingAxes[3].dotProd(dist);
+		sgn[1] = seperatingAxes[4].dotProd(dist);
+		sgn[2] = seperatingAxes[5].dotProd(dist);
+
+		sgn[0] = (sgn[0] >= 0) - (sgn[0] < 0);
+		sgn[1] = (sgn[1] >= 0) - (sgn[1] < 0);
+		sgn[2] = (sgn[2] >= 0) - (sgn[2] < 0);
+
+		//calculate a point on this edge using the other two principle axis
+		Vector point2 = physics_object_box2.object->position
+			+ seperatingAxes[(j+1)%3 + 3] * boxHalfSize2[(j+1)%3] * -sgn[(j+1)%3]
+			+ seperatingAxes[(j+2)%3 + 3] * boxHalfSize2[(j+2)%3] * -sgn[(j+2)%3];
+
+		LinePP edge2 = LinePP(point2, point2 + seperatingAxes[j + 3]);
+
+		//find the two closest points on the lines
+		IntLinePPLinePP::closestPoints(edge1, edge2, c.collision_point1, c.collision_point2);
+		c.feature_id = bestAxis*8;
+	}
+
+	c.physics_object1 = &physics_object_box1;
+	c.physics_object2 = &physics_object_box2;
+
+	if (bestAxis < 6) {
+		int count = boxBoxFaceManifold(physics_object_box1, physics_object_box2, seperatingAxes, bestAxis, c.collision_normal, manifold);
+		if (count > 0)
+			return count;
+	}
+
+	return 1;
+#else
+	return 0;
+#endif
+}
+
+
+
+/**
+ * select up to COLLISION_MAX_MANIFOLD_POINTS points which span the largest
+ * area of the contact region.
+ *
+ * the deepest point is selected first, then the point farthest away from it
+ * and finally the points which enlarge the area of the quadrilateral on both
+ * sides of the line through the first two points.
+ *
+ * \param selected	indices of the selected points, deepest point first
+ * \return	number of selected points
+ */
+int CPhysicsIntersections::reduceManifold(const Vector *points, const float *depths, int count, const Vector &normal, int *selected)
+{
+	if (count <= 0)
+		return 0;
+
+	int deepest = 0;
+	for (int i = 1; i < count; i++)
+		if (depths[i] > depths[deepest])
+			deepest = i;
+
+	if (count <= COLLISION_MAX_MANIFOLD_POINTS) {
+		selected[0] = deepest;
+		int n = 1;
+		for (int i = 0; i < count; i++)
+			if (i != deepest)
+				selected[n++] = i;
+		return count;
+	}
+
+	// point farthest away from the deepest point within the contact plane
+	int farthest = -1;
+	float maxDistance = -1;
+	for (int i = 0; i < count; i++) {
+		Vector d = points[i] - points[deepest];
+		d = d - normal*normal.dotProd(d);
+
+		float distance = d.getLength2();
+		if (distance > maxDistance) {
+			maxDistance = distance;
+			farthest = i;
+		}
+	}
+
+	selected[0] = deepest;
+	selected[1] = farthest;
+	int n = 2;
+
+	// points with the largest triangle area on both sides of the first edge
+	Vector edge = points[farthest] - points[deepest];
+	int positive = -1, negative = -1;
+	float maxArea = 0, minArea = 0;
+	for (int i = 0; i < count; i++) {
+		float area = (edge % (points[i] - points[deepest])).dotProd(normal);
+
+		if (area > maxArea) {
+			maxArea = area;
+			positive = i;
+		}
+		else if (area < minArea) {
+			minArea = area;
+			negative = i;
+		}
+	}
+
+	if (positive >= 0)
+		selected[n++] = positive;
+	if (negative >= 0)
+		selected[n++] = negative;
+
+	return n;
+}
+
+
+/**
+ * compute the contact manifold of two boxes for a face separating axis.
+ *
+ * the face of the reference box (the box whose face normal is the separating
+ * axis) is used to clip the most anti-parallel face of the other (incident)
+ * box. the clipped points which are below the reference face are the
+ * collision points.
+ *
+ * feature ids: BOX_FACE_FEATURE_ID_OFFSET + (reference axis * 6 + incident face) * 64 + point id
+ * with the point ids 0-3 for vertices of the incident face and 8-39 for
+ * points clipped at the sides of the reference face.
+ *
+ * \param normal	the collision normal aiming from box 1 to box 2
+ * \return	the number of collision points or 0 if clipping failed
+ */
+int CPhysicsIntersections::boxBoxFaceManifold(
+		iPhysicsObject &physics_object_box1, iPhysicsObject &physics_object_box2,
+		const Vector *axes, int axis_index, const Vector &normal,
+		CPhysicsCollisionData *manifold)
+{
+	bool box1IsReference = (axis_index < 3);
+
+	iPhysicsObject &refObject = (box1IsReference ? physics_object_box1 : physics_object_box2);
+	iPhysicsObject &incObject = (box1IsReference ? physics_object_box2 : physics_object_box1);
+
+	const Vector *refAxes = (box1IsReference ? axes : axes + 3);
+	const Vector *incAxes = (box1IsReference ? axes + 3 : axes);
+
+	Vector refHalfSize = static_cast<cObjectFactoryBox *>(&refObject.object->objectFactory.getClass())->half_size;
+	Vector incHalfSize = static_cast<cObjectFactoryBox *>(&incObject.object->objectFactory.getClass())->half_size;
+
+	// normal of the reference face aiming to the incident box
+	Vector refNormal = (box1IsReference ? normal : -normal);
+
+	int a = axis_index % 3;
+	Vector refCenter = refObject.object->position + refNormal*refHalfSize[a];
+
+	/*
+	 * the incident face is the face whose normal is the most anti-parallel one
+	 */
+	int incAxis = 0;
+	float maxDot = -1;
 	for (int i = 0; i < 3; i++) {
-		for (int j = 3; j < 6; j++) {
-			seperatingAxes[x] = seperatingAxes[i] % seperatingAxes[j];
-			x++;
+		float d = fabs(incAxes[i].dotProd(refNormal));
+		if (d > maxDot) {
+			maxDot = d;
+			incAxis = i;
 		}
 	}
 
-	// Separating axis algorithm
-	c.interpenetration_depth = CMath<float>::max();
-	for (Vector* axis = seperatingAxes; axis != seperatingAxes + 15; axis++) {
-		*axis = (*axis).getNormalized();
+	float incSign = (incAxes[incAxis].dotProd(refNormal) > 0 ? -1.0f : 1.0f);
+	Vector incCenter = incObject.object->position + incAxes[incAxis]*(incHalfSize[incAxis]*incSign);
 
-		vec2d proj1 = getProjection(physics_object_box1, *axis);
-		vec2d proj2 = getProjection(physics_object_box2, *axis);
-		
-		if (proj1[1] <= proj2[0] || proj2[1] <= proj1[0]) {
-			return false; // Separating axis found -> no collision
+	Vector u = incAxes[(incAxis+1)%3]*incHalfSize[(incAxis+1)%3];
+	Vector v = incAxes[(incAxis+2)%3]*incHalfSize[(incAxis+2)%3];
+
+	/*
+	 * clip the incident face at the 4 side planes of the reference face.
+	 *
+	 * the edge from the vertex i to the next vertex is labeled with edges[i]
+	 * to create stable ids for the clipped points: the original edges are
+	 * labeled with 0-3, edges created by clipping plane p with 4+p.
+	 */
+	Vector polygon[2][8];
+	int ids[2][8];
+	int edges[2][8];
+	int count = 4;
+
+	polygon[0][0] = incCenter + u + v;
+	polygon[0][1] = incCenter - u + v;
+	polygon[0][2] = incCenter - u - v;
+	polygon[0][3] = incCenter + u - v;
+	for (int i = 0; i < 4; i++) {
+		ids[0][i] = i;
+		edges[0][i] = i;
+	}
+
+	int src = 0;
+	for (int p = 0; p < 4; p++) {
+		int side = (a + 1 + (p >> 1)) % 3;
+		Vector planeNormal = refAxes[side]*((p & 1) ? -1.0f : 1.0f);
+		float planeOffset = planeNormal.dotProd(refObject.object->position) + refHalfSize[side];
+
+		int dst = src ^ 1;
+		int n = 0;
+
+		for (int i = 0; i < count; i++) {
+			int j = (i+1) % count;
+			float di = planeNormal.dotProd(polygon[src][i]) - planeOffset;
+			float dj = planeNormal.dotProd(polygon[src][j]) - planeOffset;
+
+			if (di <= 0) {
+				polygon[dst][n] = polygon[src][i];
+				ids[dst][n] = ids[src][i];
+				edges[dst][n] = edges[src][i];
+				n++;
+			}
+
+			if ((di <= 0) != (dj <= 0)) {
+				polygon[dst][n] = polygon[src][i] + (polygon[src][j] - polygon[src][i])*(di / (di - dj));
+				ids[dst][n] = 8 + edges[src][i]*4 + p;
+				edges[dst][n] = (di <= 0 ? 4 + p : edges[src][i]);
+				n++;
+			}
 		}
 
-		// Current axis is not separating objects -> calculate overlap
-		float overlap = CMath<float>::min(proj1[1], proj2[1]) - CMath<float>::max(proj1[0], proj2[0]);
-		if (overlap < c.interpenetration_depth) {
-			c.interpenetration_depth = overlap;
-			c.collision_normal = *axis;
+		count = n;
+		src = dst;
 
-			Vector dist = (physics_object_box2.object->position - physics_object_box1.object->position);
-			if (dist.dotProd(c.collision_normal) < 0) c.collision_normal = -c.collision_normal;
-			Vector sgn = Vector();
-			
-			if (axis - seperatingAxes < 3) {
-				//used principal axis of box1
-				sgn[0] = seperatingAxes[3].dotProd(dist);
-				sgn[1] = seperatingAxes[4].dotProd(dist);
-				sgn[2] = seperatingAxes[5].dotProd(dist);
-					
-				sgn[0] = (sgn[0] >= 0) - (sgn[0] < 0);
-				sgn[1] = (sgn[1] >= 0) - (sgn[1] < 0);
-				sgn[2] = (sgn[2] >= 0) - (sgn[2] < 0);
-			
-				boxHalfSize2 = boxHalfSize2 * sgn;
-				
-				c.collision_point2 = physics_object_box2.object->position + seperatingAxes[3]*boxHalfSize2[0] + seperatingAxes[4]*boxHalfSize2[1] + seperatingAxes[5]*boxHalfSize2[2];
-				c.collision_point1 = c.collision_point2 + c.collision_normal * c.interpenetration_depth;
+		if (count == 0)
+			return 0;
+	}
+
+	/*
+	 * keep the points below the reference face
+	 */
+	Vector points[8];
+	float depths[8];
+	int pointIds[8];
+	int n = 0;
+
+	for (int i = 0; i < count; i++) {
+		float separation = refNormal.dotProd(polygon[src][i] - refCenter);
+		if (separation > 0)
+			continue;
+
+		points[n] = polygon[src][i];
+		depths[n] = -separation;
+		pointIds[n] = ids[src][i];
+		n++;
+	}
+
+	int selected[COLLISION_MAX_MANIFOLD_POINTS];
+	n = reduceManifold(points, depths, n, refNormal, selected);
+
+	int incFace = incAxis*2 + (incSign > 0);
+
+	for (int i = 0; i < n; i++) {
+		CPhysicsCollisionData &c = manifold[i];
+		int k = selected[i];
+
+		// point projected to the reference face
+		Vector refPoint = points[k] + refNormal*depths[k];
+
+		c.physics_object1 = &physics_object_box1;
+		c.physics_object2 = &physics_object_box2;
+		c.collision_normal = normal;
+		c.interpenetration_depth = depths[k];
+		c.feature_id = BOX_FACE_FEATURE_ID_OFFSET + (axis_index*6 + incFace)*64 + pointIds[k];
+
+		if (box1IsReference) {
+			c.collision_point1 = refPoint;
+			c.collision_point2 = points[k];
+		}
+		else {
+			c.collision_point1 = points[k];
+			c.collision_point2 = refPoint;
+		}
+	}
+
+	return n;
+}
+
+
+
+/**
+ * compute the contact manifold of 2 convex objects touching with flat faces
+ *
+ * the face of the object whose normal is the closest one to the collision
+ * normal is the reference face. the other face is clipped at the side planes
+ * of the reference face like in boxBoxFaceManifold().
+ *
+ * \return	0, if the objects do not touch with faces (e. g. edge contacts)
+ */
+int CPhysicsIntersections::convexFaceManifold(
+		iPhysicsObject &physics_object1, iPhysicsObject &physics_object2,
+		const Vector &normal,
+		CPhysicsCollisionData *manifold)
+{
+	iPhysicsObject *objects[2] = {&physics_object1, &physics_object2};
+
+	Vector faces[2][OBJECT_FACTORY_MAX_FACE_VERTICES];
+	Vector faceNormals[2];
+	int faceCounts[2];
+	float faceDots[2];
+
+	for (int k = 0; k < 2; k++) {
+		iPhysicsObject &o = *objects[k];
+		Vector direction = (k == 0 ? normal : -normal);
+
+		faceCounts[k] = o.object->objectFactory->getSupportFace(cPhysicsGJK::rotateToObject(o, direction), faces[k], faceNormals[k]);
+
+		for (int i = 0; i < faceCounts[k]; i++)
+			faces[k][i] = o.object->position + cPhysicsGJK::rotateToWorld(o, faces[k][i]);
+		faceNormals[k] = cPhysicsGJK::rotateToWorld(o, faceNormals[k]);
+
+		faceDots[k] = (faceCounts[k] >= 3 ? faceNormals[k].dotProd(direction) : -1.0f);
+	}
+
+	if (faceDots[0] < CONVEX_FACE_CONTACT_MIN_DOT && faceDots[1] < CONVEX_FACE_CONTACT_MIN_DOT)
+		return 0;
+
+	int ref = (faceDots[0] >= faceDots[1] ? 0 : 1);
+	int inc = ref ^ 1;
+
+	const Vector *refFace = faces[ref];
+	int refCount = faceCounts[ref];
+
+	// normal of the reference face aiming to the incident object
+	Vector refNormal = faceNormals[ref];
+
+	/*
+	 * clip the incident face at the side planes of the reference face.
+	 * the ids of the points are created like in boxBoxFaceManifold().
+	 */
+	Vector polygon[2][2*OBJECT_FACTORY_MAX_FACE_VERTICES];
+	int ids[2][2*OBJECT_FACTORY_MAX_FACE_VERTICES];
+	int edges[2][2*OBJECT_FACTORY_MAX_FACE_VERTICES];
+	int count = faceCounts[inc];
+
+	for (int i = 0; i < count; i++) {
+		polygon[0][i] = faces[inc][i];
+		ids[0][i] = i;
+		edges[0][i] = i;
+	}
+
+	int src = 0;
+	for (int p = 0; p < refCount; p++) {
+		Vector planeNormal = (refFace[(p+1)%refCount] - refFace[p]) % refNormal;
+		float planeOffset = planeNormal.dotProd(refFace[p]);
+
+		int dst = src ^ 1;
+		int n = 0;
+
+		for (int i = 0; i < count; i++) {
+			int j = (i+1) % count;
+			float di = planeNormal.dotProd(polygon[src][i]) - planeOffset;
+			float dj = planeNormal.dotProd(polygon[src][j]) - planeOffset;
+
+			if (di <= 0) {
+				polygon[dst][n] = polygon[src][i];
+				ids[dst][n] = ids[src][i];
+				edges[dst][n] = edges[src][i];
+				n++;
 			}
-			else if (axis - seperatingAxes < 6) {
-				//used principal axis of box2
-				sgn[0] = seperatingAxes[0].dotProd(dist);
-				sgn[1] = seperatingAxes[1].dotProd(dist);
-				sgn[2] = seperatingAxes[2].dotProd(dist);
-					
-				sgn[0] = (sgn[0] >= 0) - (sgn[0] < 0);
-				sgn[1] = (sgn[1] >= 0) - (sgn[1] < 0);
-				sgn[2] = (sgn[2] >= 0) - (sgn[2] < 0);
-				
-				boxHalfSize1 = boxHalfSize1 * sgn;
-
-				c.collision_point1 = physics_object_box1.object->position + seperatingAxes[0]*boxHalfSize1[0] + seperatingAxes[1]*boxHalfSize1[1] + seperatingAxes[2]*boxHalfSize1[2];
-				c.collision_point2 = c.collision_point1 + c.collision_normal * c.interpenetration_depth;
+
+			if ((di <= 0) != (dj <= 0)) {
+				polygon[dst][n] = polygon[src][i] + (polygon[src][j] - polygon[src][i])*(di / (di - dj));
+				ids[dst][n] = OBJECT_FACTORY_MAX_FACE_VERTICES + (edges[src][i]*OBJECT_FACTORY_MAX_FACE_VERTICES + p);
+				edges[dst][n] = (di <= 0 ? OBJECT_FACTORY_MAX_FACE_VERTICES + p : edges[src][i]);
+				n++;
 			}
-			else {
-				//used axis created by cross-product
-				Vector boxHalfSize1 = static_cast<cObjectFactoryBox *>(&physics_object_box1.object->objectFactory.getClass())->half_size;
-
-				//calculate which principle axis of box1 was used for creation of the cross-product, this is the direction of the edge
-				int i = (axis - seperatingAxes - 6)/3;
-				
-				sgn[0] = seperatingAxes[0].dotProd(dist);
-				sgn[1] = seperatingAxes[1].dotProd(dist);
-				sgn[2] = seperatingAxes[2].dotProd(dist);
-					
-				sgn[0] = (sgn[0] >= 0) - (sgn[0] < 0);
-				sgn[1] = (sgn[1] >= 0) - (sgn[1] < 0);
-				sgn[2] = (sgn[2] >= 0) - (sgn[2] < 0);
+		}
+
+		count = n;
+		src = dst;
+
+		if (count == 0)
+			return 0;
+	}
 
-				//calculate a point on this edge using the other two principle axis
-				Vector point1 = physics_object_box1.object->position 
-					+ seperatingAxes[(i+1)%3] * boxHalfSize1[(i+1)%3] * sgn[(i+1)%3]
-					+ seperatingAxes[(i+2)%3] * boxHalfSize1[(i+2)%3] * sgn[(i+2)%3];
-				LinePP edge1 = LinePP(point1, point1 + seperatingAxes[i]);
+	/*
+	 * keep the points below the reference face
+	 */
+	Vector points[2*OBJECT_FACTORY_MAX_FACE_VERTICES];
+	float depths[2*OBJECT_FACTORY_MAX_FACE_VERTICES];
+	int pointIds[2*OBJECT_FACTORY_MAX_FACE_VERTICES];
+	int n = 0;
 
+	for (int i = 0; i < count; i++) {
+		float separation = refNormal.dotProd(polygon[src][i] - refFace[0]);
+		if (separation > 0)
+			continue;
 
-				Vector boxHalfSize2 = static_cast<cObjectFactoryBox *>(&physics_object_box2.object->objectFactory.getClass())->half_size;
+		points[n] = polygon[src][i];
+		depths[n] = -separation;
+		pointIds[n] = ids[src][i];
+		n++;
+	}
 
-				//calculate which principle axis of box2 was used for creation of the cross-product, this is the direction of the edge
-				int j = (axis - seperatingAxes)%3;
-				
-				sgn[0] = seperatingAxes[3].dotProd(dist);
-				sgn[1] = seperatingAxes[4].dotProd(dist);
-				sgn[2] = seperatingAxes[5].dotProd(dist);
-					
-				sgn[0] = (sgn[0] >= 0) - (sgn[0] < 0);
-				sgn[1] = (sgn[1] >= 0) - (sgn[1] < 0);
-				sgn[2] = (sgn[2] >= 0) - (sgn[2] < 0);
-				
-				//calculate a point on this edge using the other two principle axis
-				Vector point2 = physics_object_box2.object->position 
-					+ seperatingAxes[(j+1)%3 + 3] * boxHalfSize2[(j+1)%3] * -sgn[(j+1)%3]
-					+ seperatingAxes[(j+2)%3 + 3] * boxHalfSize2[(j+2)%3] * -sgn[(j+2)%3];
-
-				LinePP edge2 = LinePP(point2, point2 + seperatingAxes[j + 3]);
-
-				//find the two closest points on the lines
-				IntLinePPLinePP::closestPoints(edge1, edge2, c.collision_point1, c.collision_point2);
+	int selected[COLLISION_MAX_MANIFOLD_POINTS];
+	n = reduceManifold(points, depths, n, refNormal, selected);
+
+	for (int i = 0; i < n; i++) {
+		CPhysicsCollisionData &c = manifold[i];
+		int k = selected[i];
+
+		// point projected to the reference face
+		Vector refPoint = points[k] + refNormal*depths[k];
+
+		c.physics_object1 = &physics_object1;
+		c.physics_object2 = &physics_object2;
+		c.collision_normal = (ref == 0 ? refNormal : -refNormal);
+		c.interpenetration_depth = depths[k];
+		c.feature_id = CONVEX_FACE_FEATURE_ID_OFFSET + ref*CONVEX_FACE_FEATURE_ID_OFFSET + pointIds[k];
+
+		if (ref == 0) {
+			c.collision_point1 = refPoint;
+			c.collision_point2 = points[k];
+		}
+		else {
+			c.collision_point1 = points[k];
+			c.collision_point2 = refPoint;
+		}
+	}
+
+	return n;
+}
+
+
+/**
+ * compute the intersection of 2 convex objects with GJK and EPA.
+ *
+ * the simplex of the last timestep is used as start simplex if there is
+ * one in the cache, the new simplex is stored to the buffer of the context.
+ *
+ * EPA computes only the deepest point. if the objects touch with flat faces,
+ * the manifold is computed by clipping the faces instead.
+ */
+int CPhysicsIntersections::convexConvex(iPhysicsObject &physics_object1, iPhysicsObject &physics_object2, CPhysicsCollisionData *manifold, cPhysicsGJK::cContext *gjk_context)
+{
+	cPhysicsGJK::cCacheEntry entry;
+	entry.physics_object1 = &physics_object1;
+	entry.physics_object2 = &physics_object2;
+	entry.count = 0;
+
+	if (gjk_context != NULL)
+	{
+		const cPhysicsGJK::cCacheEntry *cached_entry = gjk_context->cache->find(&physics_object1, &physics_object2);
+		if (cached_entry != NULL)
+			entry = *cached_entry;
+	}
+
+	cPhysicsGJK::cSimplex simplex;
+	bool intersection = cPhysicsGJK::intersect(physics_object1, physics_object2, entry, simplex);
+
+	if (gjk_context != NULL && entry.count > 0)
+		gjk_context->new_entries->push_back(entry);
+
+	if (!intersection)
+		return 0;
+
+	if (!cPhysicsGJK::penetration(physics_object1, physics_object2, simplex, manifold[0]))
+		return 0;
+
+	Vector normal = manifold[0].collision_normal;
+	int n = convexFaceManifold(physics_object1, physics_object2, normal, manifold);
+	if (n > 0)
+		return n;
+
+	return 1;
+}
+
+
+/**
+ * return the point of the triangle (a, b, c) closest to p
+ *
+ * the voronoi regions of the vertices and edges are tested first, otherwise
+ * p is projected to the face.
+ */
+static Vector closestPointTriangle(const Vector &p, const Vector &a, const Vector &b, const Vector &c)
+{
+	Vector ab = b - a;
+	Vector ac = c - a;
+
+	Vector ap = p - a;
+	float d1 = ab.dotProd(ap);
+	float d2 = ac.dotProd(ap);
+	if (d1 <= 0 && d2 <= 0)
+		return a;
+
+	Vector bp = p - b;
+	float d3 = ab.dotProd(bp);
+	float d4 = ac.dotProd(bp);
+	if (d3 >= 0 && d4 <= d3)
+		return b;
+
+	float vc = d1*d4 - d3*d2;
+	if (vc <= 0 && d1 >= 0 && d3 <= 0)
+		return a + ab*(d1 / (d1 - d3));
+
+	Vector cp = p - c;
+	float d5 = ab.dotProd(cp);
+	float d6 = ac.dotProd(cp);
+	if (d6 >= 0 && d5 <= d6)
+		return c;
+
+	float vb = d5*d2 - d1*d6;
+	if (vb <= 0 && d2 >= 0 && d6 <= 0)
+		return a + ac*(d2 / (d2 - d6));
+
+	float va = d3*d6 - d5*d4;
+	if (va <= 0 && (d4 - d3) >= 0 && (d5 - d6) >= 0)
+		return b + (c - b)*((d4 - d3) / ((d4 - d3) + (d5 - d6)));
+
+	float denom = 1.0f / (va + vb + vc);
+	return a + ab*(vb*denom) + ac*(vc*denom);
+}
+
+
+/**
+ * collision points with the triangles of a mesh (object space of the mesh)
+ */
+class cMeshContactCandidates
+{
+public:
+	Vector points[MESH_MAX_CONTACT_CANDIDATES];
+	Vector normals[MESH_MAX_CONTACT_CANDIDATES];
+	float depths[MESH_MAX_CONTACT_CANDIDATES];
+	int featureIds[MESH_MAX_CONTACT_CANDIDATES];
+	int count;
+
+	cMeshContactCandidates()	:
+		count(0)
+	{
+	}
+
+	/**
+	 * add a collision point. if all MESH_MAX_CONTACT_CANDIDATES points are
+	 * used, the shallowest point is replaced if the new one is deeper.
+	 */
+	void add(const Vector &p_point, const Vector &p_normal, float p_depth, int p_feature_id)
+	{
+		int i = count;
+
+		if (count == MESH_MAX_CONTACT_CANDIDATES) {
+			i = 0;
+			for (int k = 1; k < count; k++)
+				if (depths[k] < depths[i])
+					i = k;
+
+			if (depths[i] >= p_depth)
+				return;
+		}
+		else {
+			count++;
+		}
+
+		points[i] = p_point;
+		normals[i] = p_normal;
+		depths[i] = p_depth;
+		featureIds[i] = p_feature_id;
+	}
+};
+
+
+/**
+ * tests a sphere against the triangles visited in the hierarchy of a mesh
+ *
+ * the sphere center has to be in front of a triangle to collide with it.
+ * the collision normal aims from the closest point of the triangle to the
+ * sphere center, thus the sphere also rolls smoothly over edges.
+ */
+class cSphereMeshVisitor
+{
+	const cObjectFactoryTriangleMesh &meshFactory;
+
+	// sphere center in the object space of the mesh
+	Vector center;
+	float sphereRadius;
+
+public:
+	cMeshContactCandidates candidates;
+
+	cSphereMeshVisitor(const cObjectFactoryTriangleMesh &p_meshFactory, const Vector &p_center, float p_sphereRadius)	:
+		meshFactory(p_meshFactory),
+		center(p_center),
+		sphereRadius(p_sphereRadius)
+	{
+	}
+
+	void operator()(int t)
+	{
+		const Vector &triangleNormal = meshFactory.getTriangleNormal(t);
+		if (triangleNormal.getLength2() == 0)
+			return;
+
+		Vector a = meshFactory.getTriangleVertex(t, 0);
+		Vector b = meshFactory.getTriangleVertex(t, 1);
+		Vector c = meshFactory.getTriangleVertex(t, 2);
+
+		float distance = triangleNormal.dotProd(center - a);
+		if (distance < 0 || distance > sphereRadius)
+			return;
+
+		Vector closest = closestPointTriangle(center, a, b, c);
+		Vector d = center - closest;
+		float length2 = d.getLength2();
+		if (length2 > sphereRadius*sphereRadius)
+			return;
+
+		for (int k = 0; k < candidates.count; k++)
+			if ((candidates.points[k] - closest).getLength2() < MESH_CONTACT_MERGE_DISTANCE2)
+				return;
+
+		float length = CMath<float>::sqrt(length2);
+
+		candidates.add(
+				closest,
+				(length > MIN_COLLISION_DISTANCE ? d*(1.0f/length) : triangleNormal),
+				sphereRadius - length,
+				t
+			);
+	}
+};
+
+
+/**
+ * compute the intersection of a sphere with the triangles of a static mesh
+ *
+ * feature ids: index of the triangle
+ */
+int CPhysicsIntersections::sphereMesh(iPhysicsObject &physics_object_sphere, iPhysicsObject &physics_object_mesh, CPhysicsCollisionData *manifold)
+{
+	const cObjectFactoryTriangleMesh &meshFactory = *static_cast<cObjectFactoryTriangleMesh *>(&physics_object_mesh.object->objectFactory.getClass());
+	float sphereRadius = static_cast<cObjectFactorySphere *>(&physics_object_sphere.object->objectFactory.getClass())->radius;
+
+	// sphere center in the object space of the mesh
+	Vector center = cPhysicsGJK::rotateToObject(physics_object_mesh, physics_object_sphere.object->position - physics_object_mesh.object->position);
+	Vector extent(sphereRadius, sphereRadius, sphereRadius);
+
+	cSphereMeshVisitor visitor(meshFactory, center, sphereRadius);
+	meshFactory.visitTriangles(center - extent, center + extent, visitor);
+
+	cMeshContactCandidates &candidates = visitor.candidates;
+
+	/*
+	 * keep the deepest points
+	 */
+	int n = CMath<int>::min(candidates.count, COLLISION_MAX_MANIFOLD_POINTS);
+
+	for (int i = 0; i < n; i++) {
+		int deepest = i;
+		for (int k = i+1; k < candidates.count; k++)
+			if (candidates.depths[k] > candidates.depths[deepest])
+				deepest = k;
+
+		std::swap(candidates.points[i], candidates.points[deepest]);
+		std::swap(candidates.normals[i], candidates.normals[deepest]);
+		std::swap(candidates.depths[i], candidates.depths[deepest]);
+		std::swap(candidates.featureIds[i], candidates.featureIds[deepest]);
+
+		// direction from the mesh to the sphere center in world space
+		Vector direction = cPhysicsGJK::rotateToWorld(physics_object_mesh, candidates.normals[i]);
+
+		CPhysicsCollisionData &c = manifold[i];
+		c.physics_object1 = &physics_object_sphere;
+		c.physics_object2 = &physics_object_mesh;
+		c.collision_normal = -direction;
+		c.collision_point1 = physics_object_sphere.object->position - direction*sphereRadius;
+		c.collision_point2 = physics_object_mesh.object->position + cPhysicsGJK::rotateToWorld(physics_object_mesh, candidates.points[i]);
+		c.interpenetration_depth = candidates.depths[i];
+		c.feature_id = candidates.featureIds[i];
+	}
+
+	return n;
+}
+
+
+/**
+ * tests a convex object against the triangles visited in the hierarchy of a
+ * mesh
+ *
+ * the face of the object which is the most anti-parallel one to the normal of
+ * a triangle is clipped at the side planes of the triangle like in
+ * convexFaceManifold(). the clipped points behind the triangle are the
+ * collision points, the collision normal is the normal of the triangle. if
+ * no point of the face is behind the triangle, the support point of the
+ * object is tested.
+ */
+class cConvexMeshVisitor
+{
+	iPhysicsObject &physics_object;
+	iPhysicsObject &physics_object_mesh;
+	const cObjectFactoryTriangleMesh &meshFactory;
+	const iObjectFactory &factory;
+
+	// object position in the object space of the mesh
+	Vector center;
+	float radius;
+
+public:
+	// collision points on the object in the object space of the mesh
+	cMeshContactCandidates candidates;
+
+	cConvexMeshVisitor(iPhysicsObject &p_physics_object, iPhysicsObject &p_physics_object_mesh, const Vector &p_center)	:
+		physics_object(p_physics_object),
+		physics_object_mesh(p_physics_object_mesh),
+		meshFactory(*static_cast<cObjectFactoryTriangleMesh *>(&p_physics_object_mesh.object->objectFactory.getClass())),
+		factory(*p_physics_object.object->objectFactory),
+		center(p_center),
+		radius(factory.bounding_sphere_radius)
+	{
+	}
+
+	void operator()(int t)
+	{
+		const Vector &triangleNormal = meshFactory.getTriangleNormal(t);
+		if (triangleNormal.getLength2() == 0)
+			return;
+
+		Vector triangle[3];
+		for (int k = 0; k < 3; k++)
+			triangle[k] = meshFactory.getTriangleVertex(t, k);
+
+		float distance = triangleNormal.dotProd(center - triangle[0]);
+		if (distance < 0 || distance > radius)
+			return;
+
+		/*
+		 * incident face of the object in the object space of the mesh
+		 */
+		Vector direction = -cPhysicsGJK::rotateToWorld(physics_object_mesh, triangleNormal);
+
+		Vector face[OBJECT_FACTORY_MAX_FACE_VERTICES];
+		Vector faceNormal;
+		int faceCount = factory.getSupportFace(cPhysicsGJK::rotateToObject(physics_object, direction), face, faceNormal);
+
+		Vector polygon[2][OBJECT_FACTORY_MAX_FACE_VERTICES+3];
+		int ids[2][OBJECT_FACTORY_MAX_FACE_VERTICES+3];
+		int edges[2][OBJECT_FACTORY_MAX_FACE_VERTICES+3];
+
+		for (int k = 0; k < faceCount; k++) {
+			Vector p = physics_object.object->position + cPhysicsGJK::rotateToWorld(physics_object, face[k]);
+			polygon[0][k] = cPhysicsGJK::rotateToObject(physics_object_mesh, p - physics_object_mesh.object->position);
+			ids[0][k] = k;
+			edges[0][k] = k;
+		}
+
+		/*
+		 * clip the face at the 3 side planes of the triangle
+		 */
+		int src = 0;
+		for (int p = 0; p < 3 && faceCount > 0; p++) {
+			Vector planeNormal = (triangle[(p+1)%3] - triangle[p]) % triangleNormal;
+			float planeOffset = planeNormal.dotProd(triangle[p]);
+
+			int dst = src ^ 1;
+			int n = 0;
+
+			for (int k = 0; k < faceCount; k++) {
+				int j = (k+1) % faceCount;
+				float dk = planeNormal.dotProd(polygon[src][k]) - planeOffset;
+				float dj = planeNormal.dotProd(polygon[src][j]) - planeOffset;
+
+				if (dk <= 0) {
+					polygon[dst][n] = polygon[src][k];
+					ids[dst][n] = ids[src][k];
+					edges[dst][n] = edges[src][k];
+					n++;
+				}
+
+				if ((dk <= 0) != (dj <= 0)) {
+					polygon[dst][n] = polygon[src][k] + (polygon[src][j] - polygon[src][k])*(dk / (dk - dj));
+					ids[dst][n] = OBJECT_FACTORY_MAX_FACE_VERTICES + edges[src][k]*3 + p;
+					edges[dst][n] = (dk <= 0 ? OBJECT_FACTORY_MAX_FACE_VERTICES + p : edges[src][k]);
+					n++;
+				}
 			}
+
+			faceCount = n;
+			src = dst;
+		}
+
+		/*
+		 * keep the points behind the triangle
+		 */
+		int triangleCount = 0;
+		for (int k = 0; k < faceCount; k++) {
+			float separation = triangleNormal.dotProd(polygon[src][k] - triangle[0]);
+			if (separation > 0)
+				continue;
+
+			candidates.add(polygon[src][k], triangleNormal, -separation, t*MESH_TRIANGLE_FEATURE_IDS + ids[src][k]);
+			triangleCount++;
 		}
+
+		if (triangleCount > 0)
+			return;
+
+		/*
+		 * the incident face is not behind the triangle: test the support point
+		 */
+		Vector p = physics_object.object->position + cPhysicsGJK::rotateToWorld(physics_object, factory.getSupportPoint(cPhysicsGJK::rotateToObject(physics_object, direction)));
+		p = cPhysicsGJK::rotateToObject(physics_object_mesh, p - physics_object_mesh.object->position);
+
+		float separation = triangleNormal.dotProd(p - triangle[0]);
+		if (separation > 0)
+			return;
+
+		for (int k = 0; k < 3; k++)
+			if (((triangle[(k+1)%3] - triangle[k]) % triangleNormal).dotProd(p - triangle[k]) > 0)
+				return;
+
+		candidates.add(p, triangleNormal, -separation, t*MESH_TRIANGLE_FEATURE_IDS + MESH_TRIANGLE_FEATURE_IDS-1);
 	}
+};
 
-	c.physics_object1 = &physics_object_box1;
-	c.physics_object2 = &physics_object_box2;
 
-	return true;
-#else
-	return false;
-#endif
+/**
+ * compute the intersection of a convex object (e. g. a box) with the
+ * triangles of a static mesh
+ *
+ * the triangles are searched with the axis aligned box of the object in the
+ * object space of the mesh, which is computed with the support points.
+ *
+ * since every triangle only pushes the object to its front side, there are
+ * no collisions with the inner edges of a flat floor.
+ *
+ * feature ids: triangle index * MESH_TRIANGLE_FEATURE_IDS + point id with the
+ * point ids of convexFaceManifold() for 3 clipping planes
+ */
+int CPhysicsIntersections::convexMesh(iPhysicsObject &physics_object, iPhysicsObject &physics_object_mesh, CPhysicsCollisionData *manifold)
+{
+	const cObjectFactoryTriangleMesh &meshFactory = *static_cast<cObjectFactoryTriangleMesh *>(&physics_object_mesh.object->objectFactory.getClass());
+	const iObjectFactory &factory = *physics_object.object->objectFactory;
+
+	// object position in the object space of the mesh
+	Vector center = cPhysicsGJK::rotateToObject(physics_object_mesh, physics_object.object->position - physics_object_mesh.object->position);
+
+	Vector min, max;
+	for (int a = 0; a < 3; a++) {
+		Vector axis(0, 0, 0);
+		axis[a] = 1;
+
+		// axis of the mesh in the object space of the convex object
+		Vector localAxis = cPhysicsGJK::rotateToObject(physics_object, cPhysicsGJK::rotateToWorld(physics_object_mesh, axis));
+
+		min[a] = center[a] + localAxis.dotProd(factory.getSupportPoint(-localAxis));
+		max[a] = center[a] + localAxis.dotProd(factory.getSupportPoint(localAxis));
+	}
+
+	cConvexMeshVisitor visitor(physics_object, physics_object_mesh, center);
+	meshFactory.visitTriangles(min, max, visitor);
+
+	cMeshContactCandidates &candidates = visitor.candidates;
+
+	if (candidates.count == 0)
+		return 0;
+
+	int deepest = 0;
+	for (int i = 1; i < candidates.count; i++)
+		if (candidates.depths[i] > candidates.depths[deepest])
+			deepest = i;
+
+	int selected[COLLISION_MAX_MANIFOLD_POINTS];
+	int n = reduceManifold(candidates.points, candidates.depths, candidates.count, candidates.normals[deepest], selected);
+
+	for (int i = 0; i < n; i++) {
+		CPhysicsCollisionData &c = manifold[i];
+		int k = selected[i];
+
+		// point projected to the triangle
+		Vector meshPoint = candidates.points[k] + candidates.normals[k]*candidates.depths[k];
+
+		c.physics_object1 = &physics_object;
+		c.physics_object2 = &physics_object_mesh;
+		c.collision_normal = -cPhysicsGJK::rotateToWorld(physics_object_mesh, candidates.normals[k]);
+		c.collision_point1 = physics_object_mesh.object->position + cPhysicsGJK::rotateToWorld(physics_object_mesh, candidates.points[k]);
+		c.collision_point2 = physics_object_mesh.object->position + cPhysicsGJK::rotateToWorld(physics_object_mesh, meshPoint);
+		c.interpenetration_depth = candidates.depths[k];
+		c.feature_id = candidates.featureIds[k];
+	}
+
+	return n;
 }
 
 
+/**
+ * time of impact of a sphere moving along a straight line from its start
+ * position to its current position with a plane or a box.
+ *
+ * the plane is reached when the distance of the sphere center to the plane
+ * is the radius reduced by CCD_RELATIVE_PENETRATION. the box is approached by
+ * conservative advancement: the distance to the box is a lower bound for the
+ * distance which the sphere can move without touching the box.
+ *
+ * objects which are already in contact at the start position are left to
+ * the discrete tests.
+ */
+float CPhysicsIntersections::sphereTimeOfImpact(iPhysicsObject &physics_object_sphere, const Vector &start_position, iPhysicsObject &physics_object2)
+{
+	float sphereRadius = static_cast<cObjectFactorySphere *>(&physics_object_sphere.object->objectFactory.getClass())->radius;
+	float impactDistance = sphereRadius*(1.0f - CCD_RELATIVE_PENETRATION);
+
+	CMatrix4<float> &inverseMatrix = physics_object2.object->inverse_model_matrix;
+	vec4f start = inverseMatrix * start_position;
+	vec4f end = inverseMatrix * physics_object_sphere.object->position;
+
+	Vector localStart(start[0], start[1], start[2]);
+	Vector localMotion = Vector(end[0], end[1], end[2]) - localStart;
+
+	switch (physics_object2.object->objectFactory->type)
+	{
+		case iObjectFactory::TYPE_PLANE: {
+			cObjectFactoryPlane &planeFactory = *static_cast<cObjectFactoryPlane *>(&physics_object2.object->objectFactory.getClass());
+
+			if (localStart[1] < sphereRadius || localStart[1] + localMotion[1] >= impactDistance)
+				return 1.0f;
+
+			float t = (localStart[1] - impactDistance) / -localMotion[1];
+			Vector impact = localStart + localMotion*t;
+
+			if (fabs(impact[0]) > planeFactory.size_x*0.5f || fabs(impact[2]) > planeFactory.size_z*0.5f)
+				return 1.0f;
+
+			return t;
+		}
+
+		case iObjectFactory::TYPE_BOX: {
+			Vector boxHalfSize = static_cast<cObjectFactoryBox *>(&physics_object2.object->objectFactory.getClass())->half_size;
+
+			float motionLength = localMotion.getLength();
+			if (motionLength == 0)
+				return 1.0f;
+
+			float t = 0;
+			for (int i = 0; i < CCD_MAX_ITERATIONS; i++) {
+				Vector p = localStart + localMotion*t;
+
+				// closest point of the box
+				Vector q;
+				for (int a = 0; a < 3; a++)
+					q[a] = CMath<float>::max(-boxHalfSize[a], CMath<float>::min(boxHalfSize[a], p[a]));
+
+				float distance = (p - q).getLength();
+
+				if (i == 0 && distance < sphereRadius)
+					return 1.0f;
+
+				if (distance - impactDistance < sphereRadius*CCD_RELATIVE_PENETRATION*0.5f)
+					return t;
+
+				t += (distance - impactDistance) / motionLength;
+				if (t > 1.0f)
+					return 1.0f;
+			}
+
+			return 1.0f;
+		}
+	}
+
+	return 1.0f;
+}
+
 
 /**
  * compute the collision data for 2 objects if there is an intersection.
  *
  * the collision data is inserted to the collision list.
  */
-bool CPhysicsIntersections::multiplexer(iPhysicsObject &physics_object1, iPhysicsObject &physics_object2, CPhysicsCollisionData &collisionData)
+int CPhysicsIntersections::multiplexer(iPhysicsObject &physics_object1, iPhysicsObject &physics_object2, CPhysicsCollisionData *collisionData, cPhysicsGJK::cContext *gjk_context)
 {
+	/**
+	 * static triangle meshes collide only with spheres and convex objects
+	 * (boxes, hulls). the mesh is always the second object.
+	 */
+	if (	physics_object1.object->objectFactory->type == iObjectFactory::TYPE_MESH ||
+			physics_object2.object->objectFactory->type == iObjectFactory::TYPE_MESH
+	)
+	{
+		bool meshIsFirst = (physics_object1.object->objectFactory->type == iObjectFactory::TYPE_MESH);
+		iPhysicsObject &physics_object = (meshIsFirst ? physics_object2 : physics_object1);
+		iPhysicsObject &physics_object_mesh = (meshIsFirst ? physics_object1 : physics_object2);
+
+		switch (physics_object.object->objectFactory->type)
+		{
+			case iObjectFactory::TYPE_SPHERE:
+				return sphereMesh(physics_object, physics_object_mesh, collisionData);
+				break;
+			case iObjectFactory::TYPE_BOX:
+			case iObjectFactory::TYPE_CONVEX:
+				return convexMesh(physics_object, physics_object_mesh, collisionData);
+				break;
+		}
+
+		// planes and other meshes are static as well
+		return 0;
+	}
+
+	/**
+	 * shapes without specialized tests are only described by their support points
+	 */
+	if (	physics_object1.object->objectFactory->type == iObjectFactory::TYPE_CONVEX ||
+			physics_object2.object->objectFactory->type == iObjectFactory::TYPE_CONVEX
+	)
+		return convexConvex(physics_object1, physics_object2, collisionData, gjk_context);
+
 	/**
 	 * we have to care about the possible combinations (sphere, plane, box, plane, ...)
 	 * to reduce the number of implementations, we "sort" them in a good order (e. g. replace plane-sphere test to a sphere-plane test)
@@ -596,13 +1647,13 @@ bool CPhysicsIntersections::multiplexer(iPhysicsObject &physics_object1, iPhysic
 			switch (physics_object2.object->objectFactory->type)
 			{
 				case iObjectFactory::TYPE_SPHERE:
-					return sphereSphere(physics_object1, physics_object2, collisionData);
+					return (sphereSphere(physics_object1, physics_object2, collisionData[0]) ? 1 : 0);
 					break;
 				case iObjectFactory::TYPE_PLANE:
-					return spherePlane(physics_object1, physics_object2, collisionData);
+					return (spherePlane(physics_object1, physics_object2, collisionData[0]) ? 1 : 0);
 					break;
 				case iObjectFactory::TYPE_BOX:
-					return sphereBox(physics_object1, physics_object2, collisionData);
+					return (sphereBox(physics_object1, physics_object2, collisionData[0]) ? 1 : 0);
 					break;
 			}
 			break;
@@ -611,10 +1662,10 @@ bool CPhysicsIntersections::multiplexer(iPhysicsObject &physics_object1, iPhysic
 			switch (physics_object2.object->objectFactory->type)
 			{
 				case iObjectFactory::TYPE_SPHERE:
-					return spherePlane(physics_object2, physics_object1, collisionData);	// switch o1&o2 !!!
+					return (spherePlane(physics_object2, physics_object1, collisionData[0]) ? 1 : 0);	// switch o1&o2 !!!
 					break;
 				case iObjectFactory::TYPE_PLANE:
-					return planePlane(physics_object1, physics_object2, collisionData);
+					return (planePlane(physics_object1, physics_object2, collisionData[0]) ? 1 : 0);
 					break;
 				case iObjectFactory::TYPE_BOX:
 					return planeBox(physics_object1, physics_object2, collisionData);
@@ -626,7 +1677,7 @@ bool CPhysicsIntersections::multiplexer(iPhysicsObject &physics_object1, iPhysic
 			switch (physics_object2.object->objectFactory->type)
 			{
 				case iObjectFactory::TYPE_SPHERE:
-					return sphereBox(physics_object2, physics_object1, collisionData);	// switch o1&o2 !!!
+					return (sphereBox(physics_object2, physics_object1, collisionData[0]) ? 1 : 0);	// switch o1&o2 !!!
 					break;
 				case iObjectFactory::TYPE_PLANE:
 					return planeBox(physics_object2, physics_object1, collisionData);	// switch o1&o2 !!!
@@ -640,5 +1691,5 @@ bool CPhysicsIntersections::multiplexer(iPhysicsObject &physics_object1, iPhysic
 	default:
 		std::cerr << "ERROR" << std::endl;
 	}
-	return false;
+	return 0;
 }
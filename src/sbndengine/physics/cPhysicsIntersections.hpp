@@ -20,6 +20,8 @@
 #include <list>
 #include "sbndengine/physics/iPhysicsObject.hpp"
 #include "cPhysicsCollisionData.hpp"
+#include "cPhysicsBoxBoxSAT.hpp"
+#include "cPhysicsGJK.hpp"
 
 /*
  * in the case that the normal is computed by the 2 "intersection points"
@@ -41,21 +43,78 @@
  */
 #define MIN_COLLISION_DISTANCE	0.00001
 
+/**
+ * maximum number of collision points computed for one pair of objects
+ * (the contact manifold)
+ */
+#define COLLISION_MAX_MANIFOLD_POINTS	4
+
 
 class CPhysicsIntersections
 {
 public:
-	static bool multiplexer(iPhysicsObject &physics_object1, iPhysicsObject &physics_object2, CPhysicsCollisionData &collisionData);
+	/**
+	 * compute the contact manifold of 2 objects
+	 *
+	 * \param collisionData	array with COLLISION_MAX_MANIFOLD_POINTS elements
+	 * \param gjk_context	simplex cache for pairs tested with GJK (optional)
+	 * \return	number of collision points stored to collisionData.
+	 * 			the deepest point is stored first.
+	 */
+	static int multiplexer(iPhysicsObject &physics_object1, iPhysicsObject &physics_object2, CPhysicsCollisionData *collisionData, cPhysicsGJK::cContext *gjk_context = NULL);
 
 	static bool sphereSphere(iPhysicsObject &o1, iPhysicsObject &o2, CPhysicsCollisionData &physicsCollision);
 	static bool spherePlane(iPhysicsObject &o1, iPhysicsObject &o2, CPhysicsCollisionData &physicsCollision);
 	static bool sphereBox(iPhysicsObject &o1, iPhysicsObject &o2, CPhysicsCollisionData &physicsCollision);
 	static bool planePlane(iPhysicsObject &o1, iPhysicsObject &o2, CPhysicsCollisionData &physicsCollision);
-	static bool planeBox(iPhysicsObject &o1, iPhysicsObject &o2, CPhysicsCollisionData &physicsCollision);
-	static bool boxBox(iPhysicsObject &o1, iPhysicsObject &o2, CPhysicsCollisionData &physicsCollision);
+	static int planeBox(iPhysicsObject &o1, iPhysicsObject &o2, CPhysicsCollisionData *physicsCollision);
+	static int boxBox(iPhysicsObject &o1, iPhysicsObject &o2, CPhysicsCollisionData *physicsCollision);
+
+	/**
+	 * intersection of any convex objects with GJK and EPA
+	 */
+	static int convexConvex(iPhysicsObject &o1, iPhysicsObject &o2, CPhysicsCollisionData *physicsCollision, cPhysicsGJK::cContext *gjk_context = NULL);
+
+	/**
+	 * intersection of a sphere or a convex object (e. g. a box) with a static
+	 * triangle mesh (TYPE_MESH)
+	 */
+	static int sphereMesh(iPhysicsObject &o1, iPhysicsObject &o_mesh, CPhysicsCollisionData *physicsCollision);
+	static int convexMesh(iPhysicsObject &o1, iPhysicsObject &o_mesh, CPhysicsCollisionData *physicsCollision);
+
+	/**
+	 * continuous collision detection: compute the fraction of the movement
+	 * from p_start_position to the current position of the sphere after
+	 * which it hits a plane or a box
+	 *
+	 * \return	time of impact in [0, 1], 1 if there's no impact
+	 */
+	static float sphereTimeOfImpact(iPhysicsObject &o_sphere, const CVector<3,float> &p_start_position, iPhysicsObject &o2);
+
+	/**
+	 * compute the collision points of 2 boxes for which the separating axis
+	 * test was already done (e. g. for several pairs at once)
+	 */
+	static int boxBox(iPhysicsObject &o1, iPhysicsObject &o2, const cPhysicsBoxBoxSAT::cResult &sat, CPhysicsCollisionData *physicsCollision);
+
+	/**
+	 * setup the description of a box object for the separating axis test
+	 */
+	static void getBox(iPhysicsObject &physics_object_box, cPhysicsBoxBoxSAT::cBox &box);
 
 private:
-	static vec2d getProjection(iPhysicsObject const &boxObject, CVector<3,float> const &axis);
+
+	static int boxBoxFaceManifold(
+			iPhysicsObject &o1, iPhysicsObject &o2,
+			const CVector<3,float> *axes, int axis_index, const CVector<3,float> &normal,
+			CPhysicsCollisionData *physicsCollision);
+
+	static int convexFaceManifold(
+			iPhysicsObject &o1, iPhysicsObject &o2,
+			const CVector<3,float> &normal,
+			CPhysicsCollisionData *physicsCollision);
+
+	static int reduceManifold(const CVector<3,float> *points, const float *depths, int count, const CVector<3,float> &normal, int *selected);
 };
 
 #endif
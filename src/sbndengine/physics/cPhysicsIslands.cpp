@@ -0,0 +1,95 @@
+/*
+ * Copyright 2010 Martin Schreiber
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include "cPhysicsIslands.hpp"
+
+
+int cPhysicsIslands::find(int node)
+{
+	while (parent[node] != node)
+	{
+		// path halving
+		parent[node] = parent[parent[node]];
+		node = parent[node];
+	}
+	return node;
+}
+
+
+void cPhysicsIslands::join(iPhysicsObject *physics_object1, iPhysicsObject *physics_object2)
+{
+	// fixed objects and objects which are not simulated
+	if (physics_object1->island < 0 || physics_object2->island < 0)
+		return;
+
+	int root1 = find(physics_object1->island);
+	int root2 = find(physics_object2->island);
+
+	if (root1 == root2)
+		return;
+
+	// the smaller index becomes the root to keep the numbering deterministic
+	if (root1 < root2)
+		parent[root2] = root1;
+	else
+		parent[root1] = root2;
+}
+
+
+int cPhysicsIslands::build(
+		std::list<iRef<iPhysicsObject> > &object_list,
+		std::list<CPhysicsCollisionData> &list_colliding_objects,
+		std::list<iRef<iPhysicsSoftConstraint> > &soft_constraint_list,
+		std::list<iRef<iPhysicsHardConstraint> > &hard_constraint_list
+	)
+{
+	parent.resize(object_list.size());
+
+	int index = 0;
+	for (std::list<iRef<iPhysicsObject> >::iterator i = object_list.begin(); i != object_list.end(); i++, index++)
+	{
+		iPhysicsObject &o = **i;
+		parent[index] = index;
+		o.island = (o.isMovable() ? index : -1);
+	}
+
+	for (std::list<CPhysicsCollisionData>::iterator i = list_colliding_objects.begin(); i != list_colliding_objects.end(); i++)
+		join((*i).physics_object1, (*i).physics_object2);
+
+	iPhysicsObject *o1, *o2;
+
+	for (std::list<iRef<iPhysicsSoftConstraint> >::iterator i = soft_constraint_list.begin(); i != soft_constraint_list.end(); i++)
+	{
+		(*i)->getPhysicsObjects(o1, o2);
+		join(o1, o2);
+	}
+
+	for (std::list<iRef<iPhysicsHardConstraint> >::iterator i = hard_constraint_list.begin(); i != hard_constraint_list.end(); i++)
+	{
+		(*i)->getPhysicsObjects(o1, o2);
+		join(o1, o2);
+	}
+
+	for (std::list<iRef<iPhysicsObject> >::iterator i = object_list.begin(); i != object_list.end(); i++)
+	{
+		iPhysicsObject &o = **i;
+		if (o.island >= 0)
+			o.island = find(o.island);
+	}
+
+	return index;
+}
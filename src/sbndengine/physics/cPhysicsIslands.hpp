@@ -0,0 +1,65 @@
+/*
+ * Copyright 2010 Martin Schreiber
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#ifndef CPHYSICS_ISLANDS_HPP
+#define CPHYSICS_ISLANDS_HPP
+
+#include <list>
+#include <vector>
+#include "sbndengine/physics/iPhysicsObject.hpp"
+#include "sbndengine/physics/iPhysicsSoftConstraint.hpp"
+#include "sbndengine/physics/iPhysicsHardConstraint.hpp"
+#include "cPhysicsCollisionData.hpp"
+
+
+/**
+ * \brief partitioning of the movable objects into simulation islands
+ *
+ * two movable objects are in the same island if they are connected by a
+ * collision or a constraint, directly or via other movable objects.
+ * fixed objects (e. g. the floor) do not connect islands.
+ *
+ * the islands are computed with a union-find over the object indices. after
+ * build(), iPhysicsObject::island stores the island of each movable object
+ * (-1 for fixed objects).
+ */
+class cPhysicsIslands
+{
+	/**
+	 * union-find parent of each object
+	 */
+	std::vector<int> parent;
+
+	int find(int node);
+	void join(iPhysicsObject *physics_object1, iPhysicsObject *physics_object2);
+
+public:
+	/**
+	 * compute the islands for all objects connected by the given collisions
+	 * and constraints
+	 *
+	 * \return	number of objects (islands are numbered below this value)
+	 */
+	int build(
+			std::list<iRef<iPhysicsObject> > &object_list,
+			std::list<CPhysicsCollisionData> &list_colliding_objects,
+			std::list<iRef<iPhysicsSoftConstraint> > &soft_constraint_list,
+			std::list<iRef<iPhysicsHardConstraint> > &hard_constraint_list
+		);
+};
+
+#endif
@@ -0,0 +1,311 @@
+/*
+ * Copyright 2010 Martin Schreiber
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "cPhysicsSimulationThread.hpp"
+#include "cPhysicsEngine_Private.hpp"
+#include "sbndengine/engine/cObjectStore.hpp"
+#include <time.h>
+#include <iostream>
+
+
+/**
+ * flag of the middle buffer index: the buffer was published after the front
+ * buffer was taken over
+ */
+#define FRAME_PUBLISHED		4
+#define FRAME_INDEX_MASK	3
+
+
+/**
+ * atomically exchange the value of p_value
+ */
+static inline int exchange(volatile int *p_value, int p_new_value)
+{
+	int old_value;
+	do
+	{
+		old_value = __sync_fetch_and_add(p_value, 0);
+	} while (__sync_val_compare_and_swap(p_value, old_value, p_new_value) != old_value);
+
+	return old_value;
+}
+
+
+cPhysicsSimulationThread::cPhysicsSimulationThread(cPhysicsEngine_Private &p_engine)	:
+		engine(p_engine),
+		running(false),
+		shutdown(false),
+		back(0),
+		front(1),
+		middle(2)
+{
+	pthread_mutexattr_t attributes;
+	pthread_mutexattr_init(&attributes);
+	pthread_mutexattr_settype(&attributes, PTHREAD_MUTEX_RECURSIVE);
+	pthread_mutex_init(&simulation_mutex, &attributes);
+	pthread_mutexattr_destroy(&attributes);
+
+	pthread_mutex_init(&command_mutex, NULL);
+
+	for (int i = 0; i < 3; i++)
+	{
+		frames[i].timestamp = 0;
+		frames[i].timestep_size = 0;
+		frames[i].object_generation = 0;
+	}
+}
+
+
+cPhysicsSimulationThread::~cPhysicsSimulationThread()
+{
+	stop();
+
+	pthread_mutex_destroy(&command_mutex);
+	pthread_mutex_destroy(&simulation_mutex);
+}
+
+
+double cPhysicsSimulationThread::getTime()
+{
+	timespec t;
+	clock_gettime(CLOCK_MONOTONIC, &t);
+	return (double)t.tv_sec + (double)t.tv_nsec*0.000000001;
+}
+
+
+void *cPhysicsSimulationThread::threadMain(void *p_thread)
+{
+	static_cast<cPhysicsSimulationThread*>(p_thread)->loop();
+	return NULL;
+}
+
+
+void cPhysicsSimulationThread::start()
+{
+	if (running)
+		return;
+
+	lock();
+
+	if (engine.update_time_interval <= 0.0)
+	{
+		std::cerr << "ERROR: the simulation thread needs a fixed update interval" << std::endl;
+		unlock();
+		return;
+	}
+
+	// continue with the clock of the simulation thread
+	engine.elapsed_time = -1;
+
+	// the published frames refer to the objects of the last run
+	engine.object_generation++;
+
+	unlock();
+
+	shutdown = false;
+	if (pthread_create(&thread, NULL, threadMain, this) != 0)
+	{
+		std::cerr << "ERROR: failed to create the simulation thread" << std::endl;
+		return;
+	}
+	running = true;
+}
+
+
+void cPhysicsSimulationThread::stop()
+{
+	if (!running)
+		return;
+
+	lock();
+	shutdown = true;
+	unlock();
+
+	pthread_join(thread, NULL);
+	running = false;
+
+	lock();
+
+	// the impulses are applied directly again
+	executeCommands();
+
+	// continue with the elapsed seconds given to simulationTimestep()
+	engine.elapsed_time = -1;
+
+	unlock();
+}
+
+
+bool cPhysicsSimulationThread::isRunning()
+{
+	return running;
+}
+
+
+void cPhysicsSimulationThread::lock()
+{
+	pthread_mutex_lock(&simulation_mutex);
+}
+
+
+void cPhysicsSimulationThread::unlock()
+{
+	pthread_mutex_unlock(&simulation_mutex);
+}
+
+
+void cPhysicsSimulationThread::loop()
+{
+	while (true)
+	{
+		lock();
+
+		if (shutdown)
+		{
+			unlock();
+			break;
+		}
+
+		executeCommands();
+
+		if (engine.updateSimulation(getTime()) > 0)
+			publish();
+
+		double wait_seconds = engine.timestamp_for_next_update - engine.elapsed_time;
+
+		unlock();
+
+		if (wait_seconds > 0)
+		{
+			timespec t;
+			t.tv_sec = (time_t)wait_seconds;
+			t.tv_nsec = (long)((wait_seconds - (double)t.tv_sec)*1000000000.0);
+			nanosleep(&t, NULL);
+		}
+	}
+}
+
+
+void cPhysicsSimulationThread::queueImpulse(
+		iPhysicsObject &p_physics_object,
+		const CVector<3,float> &p_world_point,
+		const CVector<3,float> &p_world_impulse
+	)
+{
+	cImpulseCommand command;
+	command.physics_object = &p_physics_object;
+	command.world_point = p_world_point;
+	command.world_impulse = p_world_impulse;
+
+	pthread_mutex_lock(&command_mutex);
+	commands.push_back(command);
+	pthread_mutex_unlock(&command_mutex);
+}
+
+
+void cPhysicsSimulationThread::removeCommands(iPhysicsObject *p_physics_object)
+{
+	pthread_mutex_lock(&command_mutex);
+
+	size_t n = 0;
+	for (size_t i = 0; i < commands.size(); i++)
+		if (commands[i].physics_object != p_physics_object)
+			commands[n++] = commands[i];
+	commands.resize(n);
+
+	pthread_mutex_unlock(&command_mutex);
+}
+
+
+void cPhysicsSimulationThread::clearCommands()
+{
+	pthread_mutex_lock(&command_mutex);
+	commands.clear();
+	pthread_mutex_unlock(&command_mutex);
+}
+
+
+void cPhysicsSimulationThread::executeCommands()
+{
+	// the queue is only locked to take over the commands
+	pthread_mutex_lock(&command_mutex);
+	executed_commands.swap(commands);
+	pthread_mutex_unlock(&command_mutex);
+
+	for (std::vector<cImpulseCommand>::iterator i = executed_commands.begin(); i != executed_commands.end(); i++)
+		engine.addImpulseToObjectAtPoint(*i->physics_object, i->world_point, i->world_impulse);
+
+	executed_commands.clear();
+}
+
+
+void cPhysicsSimulationThread::publish()
+{
+	cObjectStore &store = cObjectStore::getInstance();
+	cFrame &frame = frames[back];
+
+	frame.states.resize(engine.store_handles.size());
+
+	for (size_t k = 0; k < engine.store_handles.size(); k++)
+	{
+		int h = engine.store_handles[k];
+		cObjectStore::cChunk &c = store.getChunk(h);
+		int i = cObjectStore::getIndex(h);
+
+		cObjectState &s = frame.states[k];
+		s.object = c.objects[i];
+		s.previous_position = c.previous_position[i];
+		s.previous_rotation = c.previous_rotation[i];
+		s.position = c.position[i];
+		s.rotation = c.rotation[i];
+		s.movable = (c.inv_mass[i] != 0.0f);
+	}
+
+	frame.timestamp = engine.timestamp_for_next_update;
+	frame.timestep_size = engine.update_time_interval;
+	frame.object_generation = engine.object_generation;
+
+	back = exchange(&middle, back | FRAME_PUBLISHED) & FRAME_INDEX_MASK;
+}
+
+
+void cPhysicsSimulationThread::updateRenderModelMatrices()
+{
+	if (__sync_fetch_and_add(&middle, 0) & FRAME_PUBLISHED)
+		front = exchange(&middle, front) & FRAME_INDEX_MASK;
+
+	cFrame &frame = frames[front];
+
+	// objects were added or removed after the frame was published
+	if (frame.object_generation != engine.object_generation)
+		return;
+
+	double alpha = 1.0 - (frame.timestamp - getTime()) / frame.timestep_size;
+	alpha = CMath<double>::max(0.0, CMath<double>::min(1.0, alpha));
+
+	for (std::vector<cObjectState>::iterator s = frame.states.begin(); s != frame.states.end(); s++)
+	{
+		if (!s->movable)
+			continue;
+
+		cPhysicsEngine_Private::interpolateModelMatrix(
+				s->previous_position, s->previous_rotation,
+				s->position, s->rotation,
+				(float)alpha,
+				s->object->render_model_matrix
+			);
+	}
+}
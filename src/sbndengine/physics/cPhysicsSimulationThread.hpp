@@ -0,0 +1,181 @@
+/*
+ * Copyright 2010 Martin Schreiber
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef CPHYSICS_SIMULATION_THREAD_HPP
+#define CPHYSICS_SIMULATION_THREAD_HPP
+
+#include <vector>
+#include <pthread.h>
+#include "sbndengine/engine/iObject.hpp"
+#include "sbndengine/physics/iPhysicsObject.hpp"
+#include "libmath/CVector.hpp"
+#include "libmath/CQuaternion.hpp"
+
+class cPhysicsEngine_Private;
+
+
+/**
+ * \brief thread which runs the timesteps of the physics engine
+ *
+ * the thread does the fixed timesteps as soon as they are due, independent of
+ * the frame rate of the rendering thread. the simulation mutex is held during
+ * the timesteps. other threads have to lock it to modify the engine or the
+ * objects (see iPhysics::lock()).
+ *
+ * after the timesteps the object states are published through a triple
+ * buffer: the simulation thread fills the back buffer and exchanges it with
+ * the middle buffer, the rendering thread exchanges its front buffer with the
+ * middle buffer if a newer one was published. thus neither thread waits for
+ * the other one.
+ *
+ * impulses are queued and applied before the next timestep.
+ */
+class cPhysicsSimulationThread
+{
+public:
+	/**
+	 * state of one object before and after the last timestep
+	 */
+	class cObjectState
+	{
+	public:
+		iObject *object;
+
+		CVector<3,float> previous_position;
+		CQuaternion<float> previous_rotation;
+		CVector<3,float> position;
+		CQuaternion<float> rotation;
+
+		// false for fixed objects
+		bool movable;
+	};
+
+	/**
+	 * object states published after the timesteps
+	 */
+	class cFrame
+	{
+	public:
+		std::vector<cObjectState> states;
+
+		// time of the states after the last timestep
+		double timestamp;
+		double timestep_size;
+
+		// cPhysicsEngine_Private::object_generation of the states
+		unsigned int object_generation;
+	};
+
+	class cImpulseCommand
+	{
+	public:
+		iPhysicsObject *physics_object;
+		CVector<3,float> world_point;
+		CVector<3,float> world_impulse;
+	};
+
+private:
+	cPhysicsEngine_Private &engine;
+
+	pthread_t thread;
+	bool running;
+
+	// set with the simulation mutex locked to stop the thread
+	bool shutdown;
+
+	/**
+	 * held by the simulation thread during the timesteps (recursive)
+	 */
+	pthread_mutex_t simulation_mutex;
+
+	/**
+	 * impulses which were not applied so far
+	 */
+	pthread_mutex_t command_mutex;
+	std::vector<cImpulseCommand> commands;
+	std::vector<cImpulseCommand> executed_commands;
+
+	/**
+	 * triple buffer: the simulation thread writes frames[back], the
+	 * rendering thread reads frames[front]. middle is exchanged atomically
+	 * and contains FRAME_PUBLISHED if it is newer than frames[front].
+	 */
+	cFrame frames[3];
+	int back;
+	int front;
+	volatile int middle;
+
+	static void *threadMain(void *p_thread);
+	void loop();
+
+	/**
+	 * apply the queued impulses
+	 */
+	void executeCommands();
+
+	/**
+	 * store the object states to the back buffer and exchange it with the
+	 * middle buffer
+	 */
+	void publish();
+
+public:
+	cPhysicsSimulationThread(cPhysicsEngine_Private &p_engine);
+	~cPhysicsSimulationThread();
+
+	/**
+	 * seconds of a monotonic clock used by the simulation thread
+	 */
+	static double getTime();
+
+	void start();
+	void stop();
+
+	bool isRunning();
+
+	void lock();
+	void unlock();
+
+	/**
+	 * queue an impulse for the next timestep
+	 */
+	void queueImpulse(
+			iPhysicsObject &p_physics_object,
+			const CVector<3,float> &p_world_point,
+			const CVector<3,float> &p_world_impulse
+		);
+
+	/**
+	 * drop the queued impulses of an object (the simulation mutex has to be
+	 * locked)
+	 */
+	void removeCommands(iPhysicsObject *p_physics_object);
+
+	/**
+	 * drop all queued impulses
+	 */
+	void clearCommands();
+
+	/**
+	 * take over the newest published frame and interpolate the render model
+	 * matrices for the current time
+	 *
+	 * called by the rendering thread.
+	 */
+	void updateRenderModelMatrices();
+};
+
+#endif
@@ -0,0 +1,166 @@
+/*
+ * Copyright 2010 Martin Schreiber
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include "cPhysicsThreadPool.hpp"
+#include <unistd.h>
+#include <iostream>
+
+
+cPhysicsThreadPool::cPhysicsThreadPool()	:
+		job(NULL),
+		job_generation(0),
+		running_workers(0),
+		shutdown(false)
+{
+	pthread_mutex_init(&mutex, NULL);
+	pthread_cond_init(&start_condition, NULL);
+	pthread_cond_init(&finish_condition, NULL);
+}
+
+
+cPhysicsThreadPool::~cPhysicsThreadPool()
+{
+	stopThreads();
+
+	pthread_cond_destroy(&finish_condition);
+	pthread_cond_destroy(&start_condition);
+	pthread_mutex_destroy(&mutex);
+}
+
+
+void *cPhysicsThreadPool::threadMain(void *p_worker)
+{
+	cWorker &worker = *static_cast<cWorker*>(p_worker);
+	worker.pool->workerLoop(worker.thread_id, worker.start_generation);
+	return NULL;
+}
+
+
+void cPhysicsThreadPool::workerLoop(int p_thread_id, unsigned int p_start_generation)
+{
+	unsigned int last_generation = p_start_generation;
+
+	pthread_mutex_lock(&mutex);
+
+	while (true)
+	{
+		while (job_generation == last_generation && !shutdown)
+			pthread_cond_wait(&start_condition, &mutex);
+
+		if (shutdown)
+			break;
+
+		last_generation = job_generation;
+		cJob *current_job = job;
+		int number_of_threads = workers.size() + 1;
+
+		pthread_mutex_unlock(&mutex);
+		current_job->execute(p_thread_id, number_of_threads);
+		pthread_mutex_lock(&mutex);
+
+		running_workers--;
+		if (running_workers == 0)
+			pthread_cond_signal(&finish_condition);
+	}
+
+	pthread_mutex_unlock(&mutex);
+}
+
+
+void cPhysicsThreadPool::stopThreads()
+{
+	if (workers.empty())
+		return;
+
+	pthread_mutex_lock(&mutex);
+	shutdown = true;
+	pthread_cond_broadcast(&start_condition);
+	pthread_mutex_unlock(&mutex);
+
+	for (std::vector<cWorker>::iterator i = workers.begin(); i != workers.end(); i++)
+		pthread_join((*i).thread, NULL);
+
+	workers.clear();
+	shutdown = false;
+}
+
+
+void cPhysicsThreadPool::setNumberOfThreads(int p_number_of_threads)
+{
+	if (p_number_of_threads <= 0)
+		p_number_of_threads = sysconf(_SC_NPROCESSORS_ONLN);
+
+	if (p_number_of_threads < 1)
+		p_number_of_threads = 1;
+
+	if (p_number_of_threads == getNumberOfThreads())
+		return;
+
+	stopThreads();
+
+	/*
+	 * the workers are stored in a vector which must not be reallocated
+	 * after the threads were started
+	 */
+	workers.resize(p_number_of_threads-1);
+
+	for (size_t i = 0; i < workers.size(); i++)
+	{
+		cWorker &w = workers[i];
+		w.pool = this;
+		w.thread_id = i+1;
+		w.start_generation = job_generation;
+
+		if (pthread_create(&w.thread, NULL, &threadMain, &w) != 0)
+		{
+			std::cerr << "failed to create physics worker thread" << std::endl;
+			workers.resize(i);
+			break;
+		}
+	}
+}
+
+
+int cPhysicsThreadPool::getNumberOfThreads()
+{
+	return workers.size() + 1;
+}
+
+
+void cPhysicsThreadPool::run(cJob &p_job)
+{
+	if (workers.empty())
+	{
+		p_job.execute(0, 1);
+		return;
+	}
+
+	pthread_mutex_lock(&mutex);
+	job = &p_job;
+	running_workers = workers.size();
+	job_generation++;
+	pthread_cond_broadcast(&start_condition);
+	pthread_mutex_unlock(&mutex);
+
+	p_job.execute(0, workers.size() + 1);
+
+	pthread_mutex_lock(&mutex);
+	while (running_workers > 0)
+		pthread_cond_wait(&finish_condition, &mutex);
+	job = NULL;
+	pthread_mutex_unlock(&mutex);
+}
@@ -0,0 +1,101 @@
+/*
+ * Copyright 2010 Martin Schreiber
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#ifndef CPHYSICS_THREAD_POOL_HPP
+#define CPHYSICS_THREAD_POOL_HPP
+
+#include <vector>
+#include <pthread.h>
+
+
+/**
+ * \brief pool of worker threads used by the physics engine
+ *
+ * a job is executed by all threads at the same time, the calling thread
+ * being thread 0. run() returns after all threads finished the job.
+ *
+ * the jobs partition their work depending on the thread id only. thus the
+ * same work is done by the same thread for a given number of threads.
+ */
+class cPhysicsThreadPool
+{
+public:
+	class cJob
+	{
+	public:
+		/**
+		 * execute the part of the job assigned to thread p_thread_id
+		 */
+		virtual void execute(int p_thread_id, int p_number_of_threads) = 0;
+
+		virtual ~cJob()	{}
+	};
+
+private:
+	class cWorker
+	{
+	public:
+		cPhysicsThreadPool *pool;
+		int thread_id;
+		pthread_t thread;
+
+		// job generation when the thread was started
+		unsigned int start_generation;
+	};
+
+	std::vector<cWorker> workers;
+
+	pthread_mutex_t mutex;
+	pthread_cond_t start_condition;
+	pthread_cond_t finish_condition;
+
+	// job which is currently executed
+	cJob *job;
+
+	// incremented for each job to wake up the workers
+	unsigned int job_generation;
+
+	// number of workers which did not finish the current job
+	int running_workers;
+
+	bool shutdown;
+
+	static void *threadMain(void *p_worker);
+	void workerLoop(int p_thread_id, unsigned int p_start_generation);
+
+	void stopThreads();
+
+public:
+	cPhysicsThreadPool();
+	~cPhysicsThreadPool();
+
+	/**
+	 * set the number of threads including the calling thread.
+	 *
+	 * a value of 0 uses one thread for each online processor.
+	 */
+	void setNumberOfThreads(int p_number_of_threads);
+
+	int getNumberOfThreads();
+
+	/**
+	 * execute the job with all threads and wait until it is finished
+	 */
+	void run(cJob &p_job);
+};
+
+#endif
@@ -26,8 +26,31 @@
 #include "cPhysicsEngine_Private.hpp"
 
 
+/**
+ * hold the simulation mutex while the engine is modified. the simulation
+ * thread (if it's running) does not execute a timestep in the meantime.
+ */
+class cSimulationLock
+{
+	cPhysicsSimulationThread &simulation_thread;
+
+public:
+	cSimulationLock(cPhysicsSimulationThread &p_simulation_thread)	:
+		simulation_thread(p_simulation_thread)
+	{
+		simulation_thread.lock();
+	}
+
+	~cSimulationLock()
+	{
+		simulation_thread.unlock();
+	}
+};
+
+
 void iPhysics::reset()
 {
+	cSimulationLock simulation_lock(privateClass->simulation_thread);
 	privateClass->reset();
 }
 
@@ -44,70 +67,179 @@ iPhysics::~iPhysics()
 
 void iPhysics::addObject(const iRef<iPhysicsObject> &physicsObject)
 {
-	privateClass->object_list.push_back(physicsObject);
+	cSimulationLock simulation_lock(privateClass->simulation_thread);
+	privateClass->addObject(physicsObject);
+}
+
+void iPhysics::removeObject(const iRef<iPhysicsObject> &physicsObject)
+{
+	cSimulationLock simulation_lock(privateClass->simulation_thread);
+	privateClass->removeObject(physicsObject);
 }
 
 void iPhysics::addSoftConstraint(const iRef<iPhysicsSoftConstraint> &physicsSoftConstraint)
 {
+	cSimulationLock simulation_lock(privateClass->simulation_thread);
 	privateClass->soft_constraint_list.push_back(physicsSoftConstraint);
+
+	iPhysicsObject *o1, *o2;
+	physicsSoftConstraint->getPhysicsObjects(o1, o2);
+	o1->wakeUp();
+	o2->wakeUp();
 }
 
 void iPhysics::removeSoftConstraint(const iRef<iPhysicsSoftConstraint> &physicsSoftConstraint)
 {
+	cSimulationLock simulation_lock(privateClass->simulation_thread);
 	privateClass->soft_constraint_list.remove(physicsSoftConstraint);
 }
 
 
 void iPhysics::addHardConstraint(const iRef<iPhysicsHardConstraint> &physicsHardConstraint)
 {
+	cSimulationLock simulation_lock(privateClass->simulation_thread);
 	privateClass->hard_constraint_list.push_back(physicsHardConstraint);
+
+	iPhysicsObject *o1, *o2;
+	physicsHardConstraint->getPhysicsObjects(o1, o2);
+	o1->wakeUp();
+	o2->wakeUp();
 }
 
 void iPhysics::removeHardConstraint(const iRef<iPhysicsHardConstraint> &physicsHardConstraint)
 {
+	cSimulationLock simulation_lock(privateClass->simulation_thread);
 	privateClass->hard_constraint_list.remove(physicsHardConstraint);
 }
 
 void iPhysics::setGravitation(const CVector<3,float> &p_gravitation_vector)
 {
+	cSimulationLock simulation_lock(privateClass->simulation_thread);
 	privateClass->gravitation_vector = p_gravitation_vector;
+	privateClass->wakeUpAll();
+}
+
+void iPhysics::setMaximumIterations(int p_max_position_iterations, int p_velocity_iterations)
+{
+	cSimulationLock simulation_lock(privateClass->simulation_thread);
+	privateClass->setMaximumIterations(p_max_position_iterations, p_velocity_iterations);
+}
+
+void iPhysics::setSleepingParameters(float p_linear_velocity_threshold, float p_angular_velocity_threshold, float p_time_threshold)
+{
+	cSimulationLock simulation_lock(privateClass->simulation_thread);
+	privateClass->setSleepingParameters(p_linear_velocity_threshold, p_angular_velocity_threshold, p_time_threshold);
+}
+
+void iPhysics::setNumberOfThreads(int p_number_of_threads)
+{
+	cSimulationLock simulation_lock(privateClass->simulation_thread);
+	privateClass->setNumberOfThreads(p_number_of_threads);
 }
 
-void iPhysics::setMaximumIterations(int p_max_global_iterations, int p_max_local_iterations)
+void iPhysics::setBroadphase(int p_broadphase_type)
 {
-	privateClass->setMaximumIterations(p_max_global_iterations, p_max_local_iterations);
+	cSimulationLock simulation_lock(privateClass->simulation_thread);
+	privateClass->setBroadphase(p_broadphase_type);
 }
 
 void iPhysics::simulationTimestep(double p_elapsed_seconds)
 {
+	if (privateClass->simulation_thread.isRunning())
+	{
+		privateClass->simulation_thread.updateRenderModelMatrices();
+		return;
+	}
+
 	if (debug.active)
 		debug.simulationTimestep(p_elapsed_seconds);
 	else
 		privateClass->simulationTimestep(p_elapsed_seconds);
 }
 
+void iPhysics::setMaximumSubsteps(int p_max_substeps)
+{
+	cSimulationLock simulation_lock(privateClass->simulation_thread);
+	privateClass->setMaximumSubsteps(p_max_substeps);
+}
+
+double iPhysics::getInterpolationAlpha()
+{
+	cSimulationLock simulation_lock(privateClass->simulation_thread);
+	return privateClass->interpolation_alpha;
+}
+
+iPhysicsStatistics iPhysics::getStatistics()
+{
+	cSimulationLock simulation_lock(privateClass->simulation_thread);
+	return privateClass->statistics;
+}
+
+void iPhysics::resetStatistics()
+{
+	cSimulationLock simulation_lock(privateClass->simulation_thread);
+	privateClass->statistics.clear();
+}
+
 void iPhysics::addImpulseToObjectAtPoint(
 		iPhysicsObject &physicsObject,					///< the object itself
 		const CVector<3,float> &world_impulse_point,	///< intersection point in world space coordinates
 		const CVector<3,float> &world_impulse			///< directed impulse
 		)
 {
-	privateClass->addImpulseToObjectAtPoint(physicsObject, world_impulse_point, world_impulse);
+	if (privateClass->simulation_thread.isRunning())
+		privateClass->simulation_thread.queueImpulse(physicsObject, world_impulse_point, world_impulse);
+	else
+		privateClass->addImpulseToObjectAtPoint(physicsObject, world_impulse_point, world_impulse);
 }
 
 
 
 void iPhysics::setUpdateInterval(double p_update_time_interval, double p_elapsed_seconds)
 {
+	cSimulationLock simulation_lock(privateClass->simulation_thread);
+
+	// the simulation thread uses its own clock
+	if (privateClass->simulation_thread.isRunning())
+		p_elapsed_seconds = -1;
+
 	privateClass->setUpdateInterval(p_update_time_interval, p_elapsed_seconds);
 }
 
+void iPhysics::startSimulationThread()
+{
+	debug.stop();
+	privateClass->simulation_thread.start();
+}
+
+void iPhysics::stopSimulationThread()
+{
+	privateClass->simulation_thread.stop();
+}
+
+bool iPhysics::isSimulationThreadRunning()
+{
+	return privateClass->simulation_thread.isRunning();
+}
+
+void iPhysics::lock()
+{
+	privateClass->simulation_thread.lock();
+}
+
+void iPhysics::unlock()
+{
+	privateClass->simulation_thread.unlock();
+}
+
 iRef<iPhysicsObject> iPhysics::findPhysicsObjectByIdentifierString(std::string &identifier_string)
 {
+	cSimulationLock simulation_lock(privateClass->simulation_thread);
 	return privateClass->findPhysicsObjectByIdentifierString(identifier_string);
 }
 
 void iPhysics::detectAndResolveInterpenetrations()
 {
+	cSimulationLock simulation_lock(privateClass->simulation_thread);
 	privateClass->detectAndResolveInterpenetrations();
 }
@@ -29,6 +29,9 @@ void iPhysicsDebug::setup(iPhysics *p_physics)
 
 void iPhysicsDebug::start()
 {
+	// the recorded timesteps have to be done by simulationTimestep()
+	physics->stopSimulationThread();
+
 	active = true;
 	paused = true;
 	save_this_state = true;
@@ -65,12 +65,18 @@ bool cPhysicsHardConstraintRope::updateHardConstraintsCollisions(class CPhysicsC
 		return false;
 	}
 
+	/*
+	 * the stretched rope is handled like a collision whose normal aims from
+	 * the 2nd to the 1st object. thus the collision impulse pulls the
+	 * objects together and it is never negative.
+	 */
 	c.physics_object1 = &physics_object1.getClass();
 	c.physics_object2 = &physics_object2.getClass();
-	c.collision_normal = (physics_object2->object->position - physics_object1->object->position).getNormalized();
+	c.collision_normal = (physics_object1->object->position - physics_object2->object->position).getNormalized();
 	c.collision_point1 = c.physics_object1->object->position;
 	c.collision_point2 = c.physics_object2->object->position;
-	c.interpenetration_depth = equilibrium_length - dist;
+	c.interpenetration_depth = dist - equilibrium_length;
+	c.feature_id = COLLISION_FEATURE_HARD_CONSTRAINT;
 
 	return true;
 
@@ -82,3 +88,10 @@ bool cPhysicsHardConstraintRope::updateHardConstraintsCollisions(class CPhysicsC
 cPhysicsHardConstraintRope::~cPhysicsHardConstraintRope()
 {
 }
+
+
+void cPhysicsHardConstraintRope::getPhysicsObjects(iPhysicsObject *&o_physics_object1, iPhysicsObject *&o_physics_object2)
+{
+	o_physics_object1 = &physics_object1.getClass();
+	o_physics_object2 = &physics_object2.getClass();
+}
@@ -71,12 +71,14 @@ bool cPhysicsHardConstraintRopeAngular::updateHardConstraintsCollisions(class CP
 		return false;
 	}
 
+	// the normal aims from the 2nd to the 1st object (see cPhysicsHardConstraintRope)
 	c.physics_object1 = &physics_object1.getClass();
 	c.physics_object2 = &physics_object2.getClass();
-	c.collision_normal = dist.getNormalized();
+	c.collision_normal = -dist.getNormalized();
 	c.collision_point1 = world_point1;
 	c.collision_point2 = world_point2;
-	c.interpenetration_depth = equilibrium_length - dist.getLength();
+	c.interpenetration_depth = dist.getLength() - equilibrium_length;
+	c.feature_id = COLLISION_FEATURE_HARD_CONSTRAINT;
 
 	return true;
 #else
@@ -87,3 +89,10 @@ bool cPhysicsHardConstraintRopeAngular::updateHardConstraintsCollisions(class CP
 cPhysicsHardConstraintRopeAngular::~cPhysicsHardConstraintRopeAngular()
 {
 }
+
+
+void cPhysicsHardConstraintRopeAngular::getPhysicsObjects(iPhysicsObject *&o_physics_object1, iPhysicsObject *&o_physics_object2)
+{
+	o_physics_object1 = &physics_object1.getClass();
+	o_physics_object2 = &physics_object2.getClass();
+}
@@ -15,6 +15,14 @@
  */
 
 #include "sbndengine/physics/iPhysicsObject.hpp"
+#include "sbndengine/engine/cObjectStore.hpp"
+
+
+/**
+ * value of the given array for the object in the object store
+ */
+#define OBJECT_STORE_SLOT(array)	cObjectStore::getInstance().getChunk(p_object->store_handle).array[cObjectStore::getIndex(p_object->store_handle)]
+
 
 iPhysicsObject::iPhysicsObject(
 		const iRef<iObject> &p_object,
@@ -22,7 +30,16 @@ iPhysicsObject::iPhysicsObject(
 		float p_friction_dynamic_coefficient,
 		float p_friction_static_coefficient
 		)	:
-	object(p_object)
+	object(p_object),
+	velocity(OBJECT_STORE_SLOT(velocity)),
+	angular_velocity(OBJECT_STORE_SLOT(angular_velocity)),
+	linear_acceleration_accumulator(OBJECT_STORE_SLOT(linear_acceleration_accumulator)),
+	torque_accumulator(OBJECT_STORE_SLOT(torque_accumulator)),
+	movable(OBJECT_STORE_SLOT(movable)),
+	inv_mass(OBJECT_STORE_SLOT(inv_mass)),
+	rotational_inverse_inertia(OBJECT_STORE_SLOT(rotational_inverse_inertia)),
+	sleeping(OBJECT_STORE_SLOT(sleeping)),
+	continuous_collision_detection(OBJECT_STORE_SLOT(continuous_collision_detection))
 {
 	// setup physics object to be fixed
 	inv_mass = object->objectFactory->getInverseMass();
@@ -44,6 +61,18 @@ iPhysicsObject::iPhysicsObject(
 
 	friction_dynamic_coefficient = p_friction_dynamic_coefficient;
 	friction_static_coefficient = p_friction_static_coefficient;
+
+	sleeping = false;
+	sleeping_allowed = true;
+	continuous_collision_detection = false;
+	sleep_time = 0;
+	island = -1;
+	sleeping_island_id = 0;
+
+	velocity.setZero();
+	angular_velocity.setZero();
+	linear_acceleration_accumulator.setZero();
+	torque_accumulator.setZero();
 }
 
 
@@ -74,6 +103,29 @@ void iPhysicsObject::setMoveability(bool p_movable)
 	movable = p_movable;
 }
 
+void iPhysicsObject::wakeUp()
+{
+	sleeping = false;
+	sleep_time = 0;
+}
+
+bool iPhysicsObject::isSleeping()
+{
+	return sleeping;
+}
+
+void iPhysicsObject::setSleepingAllowed(bool p_sleeping_allowed)
+{
+	sleeping_allowed = p_sleeping_allowed;
+	if (!sleeping_allowed)
+		wakeUp();
+}
+
+void iPhysicsObject::setContinuousCollisionDetection(bool p_flag)
+{
+	continuous_collision_detection = p_flag;
+}
+
 void iPhysicsObject::setCoefficientOfRestitution(float p_restitution_coefficient)
 {
 	restitution_coefficient = p_restitution_coefficient;
@@ -85,23 +137,39 @@ void iPhysicsObject::setZero()
 	angular_velocity.setZero();
 }
 
+void iPhysicsObject::setPosition(const CVector<3,float> &p_position)
+{
+	wakeUp();
+	object->setPosition(p_position);
+}
+
+void iPhysicsObject::translate(const CVector<3,float> &p_translation)
+{
+	wakeUp();
+	object->translate(p_translation);
+}
+
 void iPhysicsObject::setSpeed(const CVector<3,float> &p_velocity)
 {
+	wakeUp();
 	velocity = p_velocity;
 }
 
 void iPhysicsObject::addSpeed(const CVector<3,float> &p_velocity)
 {
+	wakeUp();
 	velocity += p_velocity;
 }
 
 void iPhysicsObject::setAngularSpeed(const CVector<3,float> &p_angular_velocity)
 {
+	wakeUp();
 	angular_velocity = p_angular_velocity;
 }
 
 void iPhysicsObject::addAngularSpeed(const CVector<3,float> &p_angular_velocity)
 {
+	wakeUp();
 	angular_velocity += p_angular_velocity;
 }
 
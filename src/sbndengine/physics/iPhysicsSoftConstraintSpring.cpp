@@ -78,3 +78,10 @@ void cPhysicsSoftConstraintSpring::updateAcceleration(double frame_elapsed_secon
 	physics_object2->linear_acceleration_accumulator += dist.getNormalized() * force * physics_object2->inv_mass;
 #endif
 }
+
+
+void cPhysicsSoftConstraintSpring::getPhysicsObjects(iPhysicsObject *&o_physics_object1, iPhysicsObject *&o_physics_object2)
+{
+	o_physics_object1 = &physics_object1.getClass();
+	o_physics_object2 = &physics_object2.getClass();
+}
@@ -86,3 +86,10 @@ void cPhysicsSoftConstraintSpringAngular::updateAcceleration(double frame_elapse
     physics_object2->torque_accumulator += (lever2 % (dist.getNormalized() * force)) * factor_torque;
 #endif
 }
+
+
+void cPhysicsSoftConstraintSpringAngular::getPhysicsObjects(iPhysicsObject *&o_physics_object1, iPhysicsObject *&o_physics_object2)
+{
+	o_physics_object1 = &physics_object1.getClass();
+	o_physics_object2 = &physics_object2.getClass();
+}
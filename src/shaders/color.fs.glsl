@@ -0,0 +1,41 @@
+/*
+ * Copyright 2010 Martin Schreiber
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// lighting of objects without texture, the material color is the current color (GL_COLOR_MATERIAL)
+
+const int LIGHT_COUNT = 1;
+varying vec3 N;
+varying vec3 V;
+varying vec3 lightvec[LIGHT_COUNT];
+
+void main(void)
+{
+	vec3 Eye    = normalize(-V);
+	vec3 normal = normalize(N);
+
+	vec4 EndColor = vec4(0.0, 0.0, 0.0, 0.0);
+	vec4 EndSpec  = vec4(0.0, 0.0, 0.0, 0.0);
+	for(int i = 0; i < LIGHT_COUNT; i++){
+		vec3 Reflected = normalize(reflect(-lightvec[i], normal));
+		vec4 IAmbient  = gl_LightSource[i].ambient  * gl_Color;
+		vec4 IDiffuse  = gl_LightSource[i].diffuse  * gl_Color * max(dot(normal, lightvec[i]), 0.0);
+		vec4 ISpecular = gl_LightSource[i].specular * gl_FrontMaterial.specular * pow(max(dot(Reflected, Eye), 0.0), gl_FrontMaterial.shininess);
+		EndColor += (IAmbient+IDiffuse);
+		EndSpec  += ISpecular;
+	}
+
+	gl_FragColor = vec4((gl_LightModel.ambient * gl_Color + EndColor + EndSpec).rgb, gl_Color.a);
+}
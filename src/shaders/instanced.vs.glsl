@@ -0,0 +1,43 @@
+/*
+ * Copyright 2010 Martin Schreiber
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// vertex shader for instanced drawing, used with default.fs.glsl, normal.fs.glsl and color.fs.glsl
+
+const int LIGHT_COUNT = 1;          // Number of lights
+varying vec3 N;			    		// Normal vector
+varying vec3 V;			    		// vertex vector
+varying vec3 lightvec[LIGHT_COUNT]; // light vectors
+
+// model matrix of the instance, the modelview matrix is the view matrix
+attribute mat4 instance_model_matrix;
+
+void main(void)
+{
+	vec4 vertex = instance_model_matrix * gl_Vertex;
+
+	// the model matrices contain only rotations and translations
+	mat3 rotation = mat3(instance_model_matrix[0].xyz, instance_model_matrix[1].xyz, instance_model_matrix[2].xyz);
+
+	gl_TexCoord[0]  = gl_MultiTexCoord0;
+	gl_FrontColor   = gl_Color;
+	N               = normalize(gl_NormalMatrix * (rotation * gl_Normal));
+	V               = vec3(gl_ModelViewMatrix * vertex);
+
+	for(int i = 0; i < LIGHT_COUNT; i++)
+		lightvec[i] = normalize(gl_LightSource[i].position.xyz - V);
+
+	gl_Position     = gl_ModelViewProjectionMatrix * vertex;
+}
@@ -0,0 +1,168 @@
+/*
+ * Copyright 2010 Martin Schreiber
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef C_OBJECT_FACTORY_BUFFERS_HPP__
+#define C_OBJECT_FACTORY_BUFFERS_HPP__
+
+#include <vector>
+#include <GL/gl.h>
+#include "GL/glext.h"
+#include "sbndengine/iBase.hpp"
+#include "sbndengine/engine/iObjectFactory.hpp"
+#include "CGlError.hpp"
+
+/**
+ * \brief triangles of an object factory stored on the GPU
+ *
+ * the indexed mesh of the factory (iObjectFactory::getIndexedMesh()) is
+ * uploaded: the vertices, normals and texture coordinates are stored one
+ * after the other in a single buffer object, the indices in an element
+ * buffer. the vertex array object stores the array pointers into these
+ * buffers, thus drawing an object only binds the vertex array object.
+ *
+ * the buffers are attached to the factory (iObjectFactory::graphics_data)
+ * and uploaded again only if the geometry version of the factory changed.
+ */
+class CObjectFactoryBuffers	:
+		public iBase
+{
+public:
+	GLuint vertex_array;
+	GLuint buffer;
+	GLuint index_buffer;
+
+	// parameters for glDrawElements
+	GLsizei index_count;
+	GLenum index_type;
+
+	// iObjectFactory::geometry_version of the uploaded triangles
+	unsigned int geometry_version;
+
+	CObjectFactoryBuffers()
+	{
+		glGenVertexArrays(1, &vertex_array);
+		glGenBuffers(1, &buffer);
+		glGenBuffers(1, &index_buffer);
+		CGlErrorCheck();
+	}
+
+	~CObjectFactoryBuffers()
+	{
+		glDeleteVertexArrays(1, &vertex_array);
+		glDeleteBuffers(1, &buffer);
+		glDeleteBuffers(1, &index_buffer);
+	}
+
+	/**
+	 * upload the indexed mesh and setup the vertex array object
+	 */
+	void upload(iObjectFactory &p_factory)
+	{
+		const cIndexedMesh &mesh = p_factory.getIndexedMesh();
+
+		GLsizeiptr vertices_size = sizeof(float)*mesh.vertices.size();
+		GLsizeiptr normals_size = sizeof(float)*mesh.normals.size();
+		GLsizeiptr texcoords_size = sizeof(float)*mesh.texcoords.size();
+
+		GLintptr normals_offset = vertices_size;
+		GLintptr texcoords_offset = vertices_size + normals_size;
+
+		glBindVertexArray(vertex_array);
+		glBindBuffer(GL_ARRAY_BUFFER, buffer);
+
+		glBufferData(GL_ARRAY_BUFFER, vertices_size + normals_size + texcoords_size, NULL, GL_STATIC_DRAW);
+
+		if (vertices_size > 0)
+			glBufferSubData(GL_ARRAY_BUFFER, 0, vertices_size, &mesh.vertices[0]);
+
+		glVertexPointer(3, GL_FLOAT, 0, (const GLvoid*)0);
+		glEnableClientState(GL_VERTEX_ARRAY);
+
+		if (normals_size > 0)
+		{
+			glBufferSubData(GL_ARRAY_BUFFER, normals_offset, normals_size, &mesh.normals[0]);
+			glNormalPointer(GL_FLOAT, 0, (const GLvoid*)normals_offset);
+			glEnableClientState(GL_NORMAL_ARRAY);
+		}
+		else
+		{
+			glDisableClientState(GL_NORMAL_ARRAY);
+		}
+
+		// the texture coordinates are only used if the material has a texture
+		if (texcoords_size > 0)
+		{
+			glBufferSubData(GL_ARRAY_BUFFER, texcoords_offset, texcoords_size, &mesh.texcoords[0]);
+			glTexCoordPointer(2, GL_FLOAT, 0, (const GLvoid*)texcoords_offset);
+			glEnableClientState(GL_TEXTURE_COORD_ARRAY);
+		}
+		else
+		{
+			glDisableClientState(GL_TEXTURE_COORD_ARRAY);
+		}
+
+		// the element buffer binding is stored in the vertex array object
+		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, index_buffer);
+
+		index_count = mesh.indices.size();
+
+		if (mesh.getVertexCount() <= 0x10000)
+		{
+			// 16 bit indices are sufficient for most factories
+			std::vector<GLushort> short_indices(mesh.indices.begin(), mesh.indices.end());
+
+			index_type = GL_UNSIGNED_SHORT;
+			glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(GLushort)*index_count, (index_count > 0 ? &short_indices[0] : NULL), GL_STATIC_DRAW);
+		}
+		else
+		{
+			index_type = GL_UNSIGNED_INT;
+			glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(GLuint)*index_count, &mesh.indices[0], GL_STATIC_DRAW);
+		}
+
+		glBindVertexArray(0);
+		glBindBuffer(GL_ARRAY_BUFFER, 0);
+		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+
+		geometry_version = p_factory.geometry_version;
+
+		CGlErrorCheck();
+	}
+
+	/**
+	 * return the buffers of the factory. they are created or uploaded again
+	 * if necessary.
+	 */
+	static CObjectFactoryBuffers &get(iObjectFactory &p_factory)
+	{
+		CObjectFactoryBuffers *buffers = static_cast<CObjectFactoryBuffers*>(p_factory.graphics_data);
+
+		if (buffers == NULL)
+		{
+			buffers = new CObjectFactoryBuffers;
+			p_factory.graphics_data = buffers;
+			buffers->upload(p_factory);
+		}
+		else if (buffers->geometry_version != p_factory.geometry_version)
+		{
+			buffers->upload(p_factory);
+		}
+
+		return *buffers;
+	}
+};
+
+#endif	// C_OBJECT_FACTORY_BUFFERS_HPP__
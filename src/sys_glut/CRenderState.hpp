@@ -0,0 +1,183 @@
+/*
+ * Copyright 2010 Martin Schreiber
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef C_RENDER_STATE_HPP__
+#define C_RENDER_STATE_HPP__
+
+#include <GL/gl.h>
+#include "GL/glext.h"
+#include "worksheets_precompiler.hpp"
+
+/**
+ * \brief OpenGL state set for the materials of the objects
+ *
+ * the state of the last drawn object is stored, thus only the changes are
+ * applied to OpenGL. reset() sets the state of the fixed function pipeline
+ * without texture, afterwards the state must not be changed apart from this
+ * class until the next reset().
+ */
+class CRenderState
+{
+	GLuint program;
+	GLuint textures[2];
+	GLenum active_texture_unit;
+	bool texture_2d_enabled;
+	bool lighting_enabled;
+
+	bool color_valid;
+	GLfloat color[4];
+
+	bool shininess_valid;
+	GLfloat shininess;
+
+public:
+	/**
+	 * the OpenGL state is not known before the first reset()
+	 */
+	CRenderState()	:
+		program(0),
+		active_texture_unit(GL_TEXTURE0),
+		texture_2d_enabled(false),
+		lighting_enabled(true),
+		color_valid(false),
+		shininess_valid(false)
+	{
+		textures[0] = 0;
+		textures[1] = 0;
+	}
+
+	/**
+	 * set and store the default state
+	 */
+	void reset()
+	{
+#if SHADERS == 1
+		glUseProgram(0);
+#endif // SHADERS == 1
+		program = 0;
+
+		glActiveTexture(GL_TEXTURE1);
+		glBindTexture(GL_TEXTURE_2D, 0);
+		glActiveTexture(GL_TEXTURE0);
+		glBindTexture(GL_TEXTURE_2D, 0);
+		textures[0] = 0;
+		textures[1] = 0;
+		active_texture_unit = GL_TEXTURE0;
+
+		glDisable(GL_TEXTURE_2D);
+		texture_2d_enabled = false;
+
+		glEnable(GL_LIGHTING);
+		lighting_enabled = true;
+
+		// the color and the shininess are changed by other drawing functions
+		color_valid = false;
+		shininess_valid = false;
+	}
+
+	void useProgram(GLuint p_program)
+	{
+		if (program == p_program)
+			return;
+
+#if SHADERS == 1
+		glUseProgram(p_program);
+#endif // SHADERS == 1
+		program = p_program;
+	}
+
+	/**
+	 * bind the texture of unit p_unit (0 or 1)
+	 */
+	void bindTexture(int p_unit, GLuint p_texture)
+	{
+		if (textures[p_unit] == p_texture)
+			return;
+
+		GLenum unit = GL_TEXTURE0 + p_unit;
+		if (active_texture_unit != unit)
+		{
+			glActiveTexture(unit);
+			active_texture_unit = unit;
+		}
+
+		glBindTexture(GL_TEXTURE_2D, p_texture);
+		textures[p_unit] = p_texture;
+	}
+
+	/**
+	 * enable or disable texturing of the fixed function pipeline (unit 0)
+	 */
+	void setTexture2D(bool p_enabled)
+	{
+		if (texture_2d_enabled == p_enabled)
+			return;
+
+		if (active_texture_unit != GL_TEXTURE0)
+		{
+			glActiveTexture(GL_TEXTURE0);
+			active_texture_unit = GL_TEXTURE0;
+		}
+
+		if (p_enabled)
+			glEnable(GL_TEXTURE_2D);
+		else
+			glDisable(GL_TEXTURE_2D);
+
+		texture_2d_enabled = p_enabled;
+	}
+
+	void setLighting(bool p_enabled)
+	{
+		if (lighting_enabled == p_enabled)
+			return;
+
+		if (p_enabled)
+			glEnable(GL_LIGHTING);
+		else
+			glDisable(GL_LIGHTING);
+
+		lighting_enabled = p_enabled;
+	}
+
+	void setColor(const GLfloat p_color[4])
+	{
+		if (	color_valid &&
+				color[0] == p_color[0] && color[1] == p_color[1] &&
+				color[2] == p_color[2] && color[3] == p_color[3]
+		)
+			return;
+
+		glColor4fv(p_color);
+
+		for (int i = 0; i < 4; i++)
+			color[i] = p_color[i];
+		color_valid = true;
+	}
+
+	void setShininess(GLfloat p_shininess)
+	{
+		if (shininess_valid && shininess == p_shininess)
+			return;
+
+		glMaterialf(GL_FRONT, GL_SHININESS, p_shininess);
+
+		shininess = p_shininess;
+		shininess_valid = true;
+	}
+};
+
+#endif	// C_RENDER_STATE_HPP__
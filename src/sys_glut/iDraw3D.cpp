@@ -28,21 +28,141 @@ extern "C"{
 #include "sbndengine/graphics/iGraphicsMaterial.hpp"
 #include "sbndengine/graphics/iTexture.hpp"
 #include "CTexturePrivateData.hpp"
+#include "CObjectFactoryBuffers.hpp"
+#include "CRenderState.hpp"
 #include "sbndengine/graphics/iDraw3D.hpp"
 #include "sbndengine/graphics/iGraphicsObject.hpp"
 #include <iostream>
+#include <vector>
 #include "CGlError.hpp"
 
 #define SHADER_PATH "src/shaders/"
 
 
+/**
+ * shader program to draw instances, the model matrix of each instance is
+ * read from a vertex attribute
+ */
+class cInstancedShader
+{
+public:
+	GLuint program;
+
+	// first of the 4 attribute locations of the model matrix columns
+	GLint model_matrix_location;
+
+	cInstancedShader()	:
+		program(0),
+		model_matrix_location(-1)
+	{
+	}
+
+	void create(iShaderManager &p_shader_manager, const char *p_fragment_shader_filename)
+	{
+		if (!p_shader_manager.createProgram(SHADER_PATH "instanced.vs.glsl", p_fragment_shader_filename, program))
+		{
+			program = 0;
+			return;
+		}
+
+		model_matrix_location = glGetAttribLocation(program, "instance_model_matrix");
+		if (model_matrix_location < 0)
+			program = 0;
+	}
+};
+
+
 class cPrivateDataDraw3D
 {
 public:
 	CMatrix4<float> projection_matrix;
 	CMatrix4<float> view_matrix;
+
+	// instanced shaders for objects without texture, with texture and with normal map
+	cInstancedShader instancedColorShader;
+	cInstancedShader instancedDefaultShader;
+	cInstancedShader instancedNormalShader;
+
+	// shader, textures and lighting of the last drawn object
+	CRenderState state;
+
+	// streamed model matrices of the instances
+	GLuint instance_buffer;
+	std::vector<GLfloat> instance_matrices;
+
+	cPrivateDataDraw3D()	:
+		instance_buffer(0)
+	{
+	}
+
+	~cPrivateDataDraw3D()
+	{
+		if (instance_buffer != 0)
+			glDeleteBuffers(1, &instance_buffer);
+	}
 };
 
+
+void iDraw3D::setupMaterial(iGraphicsObject &p_graphics_object, bool p_instanced)
+{
+	cPrivateDataDraw3D &p = *privateDataDraw3D;
+
+	GLuint program = 0;
+	GLuint texture = 0;
+	GLuint normal_texture = 0;
+	bool lighting = true;
+
+	if (p_graphics_object.material.isNotNull())
+	{
+		iGraphicsMaterial &material = *p_graphics_object.material;
+
+		if (material.texture.isNotNull())
+		{
+			if (p_graphics_object.object->objectFactory->texcoords_valid)
+			{
+				texture = material.texture->privateData->gl_TextureId;
+
+				p.state.setShininess(material.shininess);
+
+#if SHADERS == 1
+				lighting = false;
+
+				if (material.normalTexture.isNotNull()) {
+					// Set normal texture and use shader, if we have one
+					normal_texture = material.normalTexture->privateData->gl_TextureId;
+					program = (p_instanced ? p.instancedNormalShader.program : normalShader);
+				} else {
+					// No normal map, use default shader
+					program = (p_instanced ? p.instancedDefaultShader.program : defaultShader);
+				}
+#endif // SHADERS == 1
+			}
+		}
+		else
+		{
+			p.state.setColor(material.color.color);
+		}
+	}
+
+	// without texture the instances need a shader to apply their model matrices
+	if (texture == 0 && p_instanced)
+		program = p.instancedColorShader.program;
+
+	p.state.useProgram(program);
+	p.state.setLighting(lighting);
+	p.state.bindTexture(1, normal_texture);
+	p.state.bindTexture(0, texture);
+	p.state.setTexture2D(texture != 0);
+}
+
+
+void iDraw3D::resetRenderState()
+{
+	glBindVertexArray(0);
+	privateDataDraw3D->state.reset();
+}
+
+
 iDraw3D::iDraw3D()
 {
 	privateDataDraw3D = new cPrivateDataDraw3D;
@@ -65,9 +185,23 @@ void iDraw3D::setup()
 
 	glEnable(GL_LIGHTING);
 
+	// the texture environment is the same for all materials
+	glActiveTexture(GL_TEXTURE1);
+	glTexEnvf(GL_TEXTURE_ENV, GL_TEXTURE_ENV_MODE, GL_MODULATE);
+	glActiveTexture(GL_TEXTURE0);
+	glTexEnvf(GL_TEXTURE_ENV, GL_TEXTURE_ENV_MODE, GL_MODULATE);
+
 	// Load shaders
 	shaderManager.createProgram(SHADER_PATH "default.vs.glsl", SHADER_PATH "default.fs.glsl", defaultShader);
 	shaderManager.createProgram(SHADER_PATH "normal.vs.glsl", SHADER_PATH "normal.fs.glsl", normalShader);
+
+#if SHADERS == 1
+	privateDataDraw3D->instancedColorShader.create(shaderManager, SHADER_PATH "color.fs.glsl");
+	privateDataDraw3D->instancedDefaultShader.create(shaderManager, SHADER_PATH "default.fs.glsl");
+	privateDataDraw3D->instancedNormalShader.create(shaderManager, SHADER_PATH "normal.fs.glsl");
+
+	glGenBuffers(1, &privateDataDraw3D->instance_buffer);
+#endif // SHADERS == 1
 }
 
 void iDraw3D::setupCamera(iCamera &p_camera)
@@ -119,106 +253,105 @@ void iDraw3D::drawObject(iObject &object, iGraphicsMaterial &material)
 	drawObject(*(iGraphicsObject*)object.graphics_engine_ptr);
 }
 
-void iDraw3D::drawObject(iGraphicsObject &graphics_object)
+void iDraw3D::drawSingleObject(iGraphicsObject &graphics_object)
 {
-	CGlErrorCheck();
-
 	iObject &object = *graphics_object.object;
 
 	glMatrixMode(GL_MODELVIEW);
 	GLfloat m[16];
-	(privateDataDraw3D->view_matrix*object.model_matrix).storeColMajorMatrix(m);
+	(privateDataDraw3D->view_matrix*object.render_model_matrix).storeColMajorMatrix(m);
 	glLoadMatrixf(m);
 
-	// setup "material"
-	bool texture_activated = false;
-
-	glVertexPointer(3, GL_FLOAT, 0, object.objectFactory->vertices);
-	glEnableClientState(GL_VERTEX_ARRAY);
+	// the triangles are uploaded only once (or after they were changed)
+	CObjectFactoryBuffers &buffers = CObjectFactoryBuffers::get(*object.objectFactory);
+	glBindVertexArray(buffers.vertex_array);
 
-	if (object.objectFactory->normals_valid)
-	{
-		glNormalPointer(GL_FLOAT, 0, object.objectFactory->normals);
-		glEnableClientState(GL_NORMAL_ARRAY);
-	}
-
-	if (graphics_object.material.isNotNull())
-	{
-		if (graphics_object.material->texture.isNotNull())
-		{
-			if (object.objectFactory->texcoords_valid)
-			{
-				glTexCoordPointer(2, GL_FLOAT, 0, object.objectFactory->texCoords);
-				glEnableClientState(GL_TEXTURE_COORD_ARRAY);
+	// setup "material"
+	setupMaterial(graphics_object, false);
 
-				glEnable(GL_TEXTURE_2D);
-				glActiveTexture(GL_TEXTURE0);
-				glBindTexture(GL_TEXTURE_2D, graphics_object.material->texture->privateData->gl_TextureId);
-				glTexEnvf(GL_TEXTURE_ENV, GL_TEXTURE_ENV_MODE, GL_MODULATE);
+	glDrawElements(GL_TRIANGLES, buffers.index_count, buffers.index_type, (const GLvoid*)0);
+}
 
-				glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
-				glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_NEAREST);
-				glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
 
-				glMaterialf(GL_FRONT, GL_SHININESS, graphics_object.material->shininess);
+void iDraw3D::drawObject(iGraphicsObject &graphics_object)
+{
+	CGlErrorCheck();
 
-#if SHADERS == 1
-				glDisable(GL_LIGHTING);
+	resetRenderState();
+	drawSingleObject(graphics_object);
+	resetRenderState();
 
-				if (graphics_object.material->normalTexture.isNotNull()) {
-					// Set normal texture and use shader, if we have one
-					glUseProgram(normalShader);
+	CGlErrorCheck();
+}
 
-					glActiveTexture(GL_TEXTURE1);
-					glBindTexture(GL_TEXTURE_2D, graphics_object.material->normalTexture->privateData->gl_TextureId);
 
-					glTexEnvf(GL_TEXTURE_ENV, GL_TEXTURE_ENV_MODE, GL_MODULATE);
+void iDraw3D::drawObjectInstances(iGraphicsObject *const *p_objects, size_t p_count)
+{
+	if (p_count == 0)
+		return;
 
-					glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
-					glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_NEAREST);
-					glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-				} else {
-					// No normal map, use default shader
-					glUseProgram(defaultShader);
-				}
-#endif // SHADERS == 1
+	iGraphicsObject &first_object = *p_objects[0];
+	cPrivateDataDraw3D &p = *privateDataDraw3D;
 
-				texture_activated = true;
-			}
-		}
+	// select the instanced shader which replaces the shader of drawObject()
+	cInstancedShader *shader = &p.instancedColorShader;
+	if (	first_object.material.isNotNull() &&
+			first_object.material->texture.isNotNull() &&
+			first_object.object->objectFactory->texcoords_valid
+	)
+	{
+		if (first_object.material->normalTexture.isNotNull())
+			shader = &p.instancedNormalShader;
 		else
-		{
-			glColor4fv(graphics_object.material->color.color);
-		}
+			shader = &p.instancedDefaultShader;
 	}
-	glDrawArrays(GL_TRIANGLES, 0, object.objectFactory->triangles_count*3);
-
-	glDisableClientState(GL_VERTEX_ARRAY);
 
-	if (object.objectFactory->normals_valid)
+	// a single object or no support for shaders
+	if (p_count == 1 || shader->program == 0)
 	{
-		glDisableClientState(GL_NORMAL_ARRAY);
+		for (size_t i = 0; i < p_count; i++)
+			drawSingleObject(*p_objects[i]);
+		return;
 	}
 
-	if (texture_activated)
-	{
-		glActiveTexture(GL_TEXTURE0);
-		glBindTexture(GL_TEXTURE_2D, 0);
+	CGlErrorCheck();
 
-		glActiveTexture(GL_TEXTURE1);
-		glBindTexture(GL_TEXTURE_2D, 0);
+	// the model matrices are applied by the shader
+	glMatrixMode(GL_MODELVIEW);
+	GLfloat m[16];
+	p.view_matrix.storeColMajorMatrix(m);
+	glLoadMatrixf(m);
 
-#if SHADERS == 1
-		// Set normal texture and use shader, if we have one
-		glEnable(GL_LIGHTING);
-		glUseProgram(0);
-#endif // SHADERS == 1
+	p.instance_matrices.resize(p_count*16);
+	for (size_t i = 0; i < p_count; i++)
+		p_objects[i]->object->render_model_matrix.storeColMajorMatrix(&p.instance_matrices[i*16]);
 
-		glDisable(GL_TEXTURE_2D);
+	CObjectFactoryBuffers &buffers = CObjectFactoryBuffers::get(*first_object.object->objectFactory);
+	glBindVertexArray(buffers.vertex_array);
 
-		glDisableClientState(GL_TEXTURE_COORD_ARRAY);
+	// the buffer is orphaned to avoid waiting for the draw calls of the last frame
+	glBindBuffer(GL_ARRAY_BUFFER, p.instance_buffer);
+	glBufferData(GL_ARRAY_BUFFER, sizeof(GLfloat)*p.instance_matrices.size(), &p.instance_matrices[0], GL_STREAM_DRAW);
+
+	// one attribute for each column of the model matrix, advanced once per instance
+	for (int c = 0; c < 4; c++)
+	{
+		GLuint location = shader->model_matrix_location + c;
+		glVertexAttribPointer(location, 4, GL_FLOAT, GL_FALSE, sizeof(GLfloat)*16, (const GLvoid*)(sizeof(GLfloat)*4*c));
+		glVertexAttribDivisor(location, 1);
+		glEnableVertexAttribArray(location);
 	}
 
+	setupMaterial(first_object, true);
+
+	glDrawElementsInstanced(GL_TRIANGLES, buffers.index_count, buffers.index_type, (const GLvoid*)0, p_count);
+
+	// the vertex array object may be used without instances again
+	for (int c = 0; c < 4; c++)
+		glDisableVertexAttribArray(shader->model_matrix_location + c);
+
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+
 	CGlErrorCheck();
 }
 
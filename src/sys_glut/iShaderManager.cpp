@@ -17,6 +17,7 @@
 
 #define GL_GLEXT_PROTOTYPES
 
+#include <GL/gl.h>
 #include "sbndengine/iShaderManager.hpp"
 
 #include "worksheets_precompiler.hpp"
@@ -29,6 +29,10 @@ void iTexture::textureFromRGBArray(int size_x, int size_y, unsigned char *textur
 	if (privateData->glGenerateMipmap)
 		privateData->glGenerateMipmap(GL_TEXTURE_2D);
 
+	// the filters are stored in the texture object, thus they are not set for each draw call
+	glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_NEAREST);
+	glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+
 	glBindTexture(GL_TEXTURE_2D, 0);
 	CGlErrorCheck();
 }
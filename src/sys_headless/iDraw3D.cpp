@@ -0,0 +1,74 @@
+/*
+ * Copyright 2010 Martin Schreiber
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "sbndengine/graphics/iDraw3D.hpp"
+
+
+iDraw3D::iDraw3D()	:
+		privateDataDraw3D(NULL),
+		defaultShader(0),
+		normalShader(0)
+{
+}
+
+
+iDraw3D::~iDraw3D()
+{
+}
+
+void iDraw3D::setup()
+{
+}
+
+void iDraw3D::setupCamera(iCamera &/*camera*/)
+{
+}
+
+void iDraw3D::setupLight()
+{
+}
+
+void iDraw3D::drawObject(iObject &/*object*/, iGraphicsMaterial &/*material*/)
+{
+}
+
+void iDraw3D::drawObject(iGraphicsObject &/*object*/)
+{
+}
+
+void iDraw3D::drawObjectInstances(iGraphicsObject *const * /*p_objects*/, size_t /*p_count*/)
+{
+}
+
+void iDraw3D::resetRenderState()
+{
+}
+
+void iDraw3D::drawLine(
+		const CVector<3,float> &/*p1*/,
+		const CVector<3,float> &/*p2*/,
+		const iRef<iGraphicsMaterial> &/*material*/
+	)
+{
+}
+
+void iDraw3D::clearBuffers()
+{
+}
+
+void iDraw3D::windowResized(int /*width*/, int /*height*/)
+{
+}
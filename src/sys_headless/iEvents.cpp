@@ -0,0 +1,61 @@
+/*
+ * Copyright 2010 Martin Schreiber
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "sbndengine/iEvents.hpp"
+#include "sbndengine/iEventHandlers.hpp"
+#include <stddef.h>
+
+
+static iEventHandlers *global_event_handler_class = NULL;
+
+// set by leaveEventLoop()
+static bool global_leave_event_loop = false;
+
+
+iEvents::iEvents()
+{
+}
+
+void iEvents::setup(iEventHandlers &p_event_handler_class)
+{
+	global_event_handler_class = &p_event_handler_class;
+}
+
+/**
+ * there are no input events: draw one frame after the other until the event
+ * loop is left
+ */
+void iEvents::startEventLoop()
+{
+	global_leave_event_loop = false;
+
+	while (!global_leave_event_loop)
+		global_event_handler_class->drawFrame();
+}
+
+void iEvents::leaveEventLoop()
+{
+	global_leave_event_loop = true;
+}
+
+void iEvents::shutdown()
+{
+	global_event_handler_class = NULL;
+}
+
+iEvents::~iEvents()
+{
+}
@@ -0,0 +1,59 @@
+/*
+ * Copyright 2010 Martin Schreiber
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "sbndengine/graphics/iTexture.hpp"
+
+/**
+ * the textures are only created to be used by the materials, their content is
+ * never needed
+ */
+iTexture::iTexture()
+{
+	privateData = NULL;
+}
+
+
+void iTexture::textureFromRGBArray(int /*size_x*/, int /*size_y*/, unsigned char * /*texture_array*/)
+{
+}
+
+
+void iTexture::createRandomizedTexture(
+		float /*r*/, float /*r_max_variance*/,
+		float /*g*/, float /*g_max_variance*/,
+		float /*b*/, float /*b_max_variance*/,
+		int /*size_x*/, int /*size_y*/
+	)
+{
+}
+
+
+void iTexture::createRandomizedTexture(
+		float /*r*/, float /*g*/, float /*b*/,
+		float /*variance*/,
+		int /*size_x*/, int /*size_y*/
+	)
+{
+}
+
+
+void iTexture::createTextureFromFile(const char * /*filename*/)
+{
+}
+
+iTexture::~iTexture()
+{
+}
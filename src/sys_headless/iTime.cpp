@@ -0,0 +1,93 @@
+/*
+ * Copyright 2010 Martin Schreiber
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "sbndengine/iTime.hpp"
+#include <time.h>
+
+/**
+ * the elapsed seconds are simulated: nanoSleep() advances the clock instead of
+ * sleeping. the fps are measured with the monotonic clock of the system.
+ */
+class cPrivateTime
+{
+public:
+	// simulated seconds
+	double seconds;
+
+	// timestamp for last fps value update
+	double next_fps_time_update;
+	double last_fps_time_update;
+	double fps_frames;
+
+	static double getSystemSeconds()
+	{
+		timespec t;
+		clock_gettime(CLOCK_MONOTONIC, &t);
+		return (double)t.tv_sec + (double)t.tv_nsec*0.000000001;
+	}
+};
+
+iTime::iTime()
+{
+	privateTime = new cPrivateTime;
+	setup();
+}
+
+iTime::~iTime()
+{
+	delete privateTime;
+}
+
+void iTime::setup()
+{
+	privateTime->seconds = 0;
+
+	elapsed_seconds = 0;
+	frame_elapsed_seconds = 0;
+	fps = 0;
+	privateTime->fps_frames = 0;
+	privateTime->last_fps_time_update = cPrivateTime::getSystemSeconds();
+	privateTime->next_fps_time_update = privateTime->last_fps_time_update + 1.0;
+}
+
+void iTime::update()
+{
+	frame_elapsed_seconds = privateTime->seconds - elapsed_seconds;
+
+	elapsed_seconds = privateTime->seconds;
+
+	privateTime->fps_frames++;
+
+	double system_seconds = cPrivateTime::getSystemSeconds();
+
+	if (privateTime->next_fps_time_update < system_seconds)
+	{
+		fps = privateTime->fps_frames/(system_seconds-privateTime->last_fps_time_update);
+
+		privateTime->next_fps_time_update = system_seconds+1.0;
+		privateTime->last_fps_time_update = system_seconds;
+
+		privateTime->fps_frames = 0;
+	}
+}
+
+
+
+void iTime::nanoSleep(double i_seconds)
+{
+	// don't wait, only let the simulated time pass
+	privateTime->seconds += i_seconds;
+}
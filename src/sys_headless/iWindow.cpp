@@ -0,0 +1,82 @@
+/*
+ * Copyright 2010 Martin Schreiber
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "sbndengine/iWindow.hpp"
+#include <stddef.h>
+
+/**
+ * there's no window: only the size is stored for the camera setup
+ */
+iWindow::iWindow()
+{
+	windowPrivate = NULL;
+}
+
+void iWindow::init()
+{
+}
+
+void iWindow::create(int p_width, int p_height, const char * /*title*/)
+{
+	windowResized(p_width, p_height);
+}
+
+
+void iWindow::swapBuffers()
+{
+}
+
+void iWindow::destroy()
+{
+}
+
+void iWindow::shutdown()
+{
+}
+
+
+iWindow::~iWindow()
+{
+}
+
+
+void iWindow::windowResized(int p_width, int p_height)
+{
+	width = p_width;
+	center_x = width/2;
+	height = p_height;
+	center_y = height/2;
+
+	aspect_ratio = (float)height/(float)width;
+}
+
+
+void iWindow::setTitle(const char * /*title*/)
+{
+}
+
+
+void iWindow::setMousePosition(int /*x*/, int /*y*/)
+{
+}
+
+void iWindow::showMouse()
+{
+}
+
+void iWindow::hideMouse()
+{
+}